@@ -0,0 +1,303 @@
+// contention_bench: how Log() scales as producer threads are added.
+//
+//   contention_bench [--threads 1,2,4|max] [--mode memory|compacting|append|sharded]
+//                    [--duration-ms MS] [--sizes 64,256,1024] [--messengers K]
+//                    [--max-lines N] [--dir DIR] [--format csv|json] [--label TEXT]
+//                    [--no-header]
+//
+// For each thread count, a fresh Logger (console off, file DIR/contention.log) is
+// hammered for --duration-ms by that many threads. Messages cycle through --sizes
+// bytes and K messengers (0: none); each carries a counter so compaction finds no
+// duplicates. Modes: memory (no file, only the lock and formatting), compacting
+// (FileMode::Compacting, --max-lines), append (FileMode::AtomicAppend), sharded
+// (AtomicAppend with one shard per core).
+//
+// Reported per thread count: throughput; fairness as Jain's index over the calls
+// each thread completed (1 = equal share) and the min/max per-thread calls; call
+// latency percentiles; and, from the logger's lock profiling, lock wait, lock hold
+// and compaction times. Lock percentiles are upper bounds of power-of-two buckets.
+// One CSV row or JSON object per thread count goes to stdout; --label tags the rows
+// (e.g. with a release) so runs can be concatenated and plotted together.
+
+#include "../include/Logger.h"
+#include "../include/LogClock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Latency histogram: 16 linear steps per power of two, so percentiles are within ~6%
+struct LatencyHistogram {
+    static constexpr std::size_t SUB = 16;
+    std::vector<std::uint64_t> counts = std::vector<std::uint64_t>(64 * SUB, 0);
+    std::uint64_t maxNs = 0;
+
+    static std::size_t Index(std::uint64_t ns) {
+        if (ns < SUB) return static_cast<std::size_t>(ns);
+        int msb = 63 - __builtin_clzll(ns);
+        std::size_t sub = static_cast<std::size_t>((ns >> (msb - 4)) & (SUB - 1));
+        return static_cast<std::size_t>(msb - 3) * SUB + sub;
+    }
+
+    static std::uint64_t UpperBound(std::size_t index) {
+        if (index < SUB) return index;
+        int msb = static_cast<int>(index / SUB) + 3;
+        std::uint64_t step = std::uint64_t(1) << (msb - 4);
+        return (std::uint64_t(1) << msb) + (index % SUB + 1) * step - 1;
+    }
+
+    void Add(std::uint64_t ns) {
+        ++counts[Index(ns)];
+        maxNs = std::max(maxNs, ns);
+    }
+
+    void Merge(const LatencyHistogram& other) {
+        for (std::size_t i = 0; i < counts.size(); ++i) counts[i] += other.counts[i];
+        maxNs = std::max(maxNs, other.maxNs);
+    }
+
+    std::uint64_t Percentile(double p) const {
+        std::uint64_t total = 0;
+        for (std::uint64_t c : counts) total += c;
+        if (total == 0) return 0;
+        std::uint64_t rank = static_cast<std::uint64_t>(p * static_cast<double>(total - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(UpperBound(i), maxNs);
+        }
+        return maxNs;
+    }
+};
+
+static std::uint64_t LockPercentile(const C6Logger::LockTimes& times, double p) {
+    if (times.count == 0) return 0;
+    std::uint64_t rank = static_cast<std::uint64_t>(p * static_cast<double>(times.count - 1)) + 1;
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < C6Logger::LOCK_TIME_BUCKETS; ++i) {
+        seen += times.buckets[i];
+        if (seen >= rank) return std::min((std::uint64_t(2) << i) - 1, times.maxNs);
+    }
+    return times.maxNs;
+}
+
+static double Mean(const C6Logger::LockTimes& times) {
+    return times.count ? static_cast<double>(times.totalNs) / static_cast<double>(times.count) : 0.0;
+}
+
+struct Result {
+    unsigned threads = 0;
+    double seconds = 0.0;
+    std::uint64_t calls = 0;
+    double fairness = 0.0;
+    std::uint64_t minThreadCalls = 0;
+    std::uint64_t maxThreadCalls = 0;
+    LatencyHistogram latency;
+    C6Logger::LoggerStats stats;
+};
+
+struct Settings {
+    std::string mode = "memory";
+    int durationMs = 2000;
+    std::vector<std::size_t> sizes{ 64, 256, 1024 };
+    std::size_t messengers = 4;
+    std::size_t maxLines = 1000;
+    std::string dir = ".";
+};
+
+static Result Run(const Settings& settings, unsigned threads) {
+    C6Logger::LoggerConfig config;
+    config.console = false;
+    config.path = (std::filesystem::absolute(settings.dir) / "contention.log").string();
+    config.maxLines = settings.maxLines;
+    if (settings.mode == "memory") config.fileOutput = false;
+    if (settings.mode == "append" || settings.mode == "sharded") config.fileMode = C6Logger::FileMode::AtomicAppend;
+    if (settings.mode == "sharded") config.shards = std::max(1u, std::thread::hardware_concurrency());
+    std::error_code ec;
+    std::filesystem::remove(config.path, ec);
+
+    Result result;
+    result.threads = threads;
+    std::vector<std::uint64_t> calls(threads, 0);
+    std::vector<LatencyHistogram> latencies(threads);
+    {
+        C6Logger::Logger logger(config);
+        std::atomic<unsigned> ready{ 0 };
+        std::atomic<bool> go{ false };
+        std::atomic<bool> stop{ false };
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::vector<std::string> messages;
+                for (std::size_t size : settings.sizes) messages.emplace_back(std::max<std::size_t>(size, 24), 'x');
+                std::vector<std::string> names;
+                for (std::size_t m = 0; m < settings.messengers; ++m) names.push_back("Messenger" + std::to_string(m));
+                ready.fetch_add(1);
+                while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+                std::uint64_t n = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    std::string& message = messages[n % messages.size()];
+                    int length = std::snprintf(&message[0], 24, "t%u #%llu ", t, static_cast<unsigned long long>(n));
+                    message[static_cast<std::size_t>(length)] = 'x'; // keep the padding after the counter
+                    std::string_view messenger = names.empty() ? std::string_view() : std::string_view(names[n % names.size()]);
+                    std::int64_t begin = C6Logger::MonotonicNs();
+                    logger.Log(C6Logger::LogLevel::info, message, messenger);
+                    latencies[t].Add(static_cast<std::uint64_t>(C6Logger::MonotonicNs() - begin));
+                    ++n;
+                }
+                calls[t] = n;
+            });
+        }
+        while (ready.load() < threads) std::this_thread::yield();
+        std::int64_t start = C6Logger::MonotonicNs();
+        go.store(true, std::memory_order_release);
+        std::this_thread::sleep_for(std::chrono::milliseconds(settings.durationMs));
+        stop.store(true);
+        for (auto& worker : workers) worker.join();
+        result.seconds = static_cast<double>(C6Logger::MonotonicNs() - start) / 1e9;
+        logger.Flush();
+        result.stats = logger.GetStats();
+    }
+    std::filesystem::remove(config.path, ec);
+
+    double sum = 0.0, squares = 0.0;
+    result.minThreadCalls = calls.empty() ? 0 : calls[0];
+    for (unsigned t = 0; t < threads; ++t) {
+        result.calls += calls[t];
+        sum += static_cast<double>(calls[t]);
+        squares += static_cast<double>(calls[t]) * static_cast<double>(calls[t]);
+        result.minThreadCalls = std::min(result.minThreadCalls, calls[t]);
+        result.maxThreadCalls = std::max(result.maxThreadCalls, calls[t]);
+        result.latency.Merge(latencies[t]);
+    }
+    result.fairness = squares > 0.0 ? sum * sum / (static_cast<double>(threads) * squares) : 0.0;
+    return result;
+}
+
+static const char* const COLUMNS[] = {
+    "label", "mode", "threads", "seconds", "calls", "calls_per_s", "fairness", "min_thread_calls", "max_thread_calls",
+    "latency_p50_ns", "latency_p99_ns", "latency_p999_ns", "latency_max_ns",
+    "lock_acquisitions", "lock_wait_mean_ns", "lock_wait_p99_ns", "lock_wait_max_ns", "lock_wait_share",
+    "lock_hold_mean_ns", "lock_hold_p99_ns", "lock_hold_max_ns",
+    "compactions", "compaction_mean_ns", "compaction_p99_ns", "compaction_max_ns"
+};
+
+static std::vector<std::string> Values(const std::string& label, const Settings& settings, const Result& r) {
+    auto num = [](double v) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.6g", v);
+        return std::string(text);
+    };
+    auto count = [](std::uint64_t v) { return std::to_string(v); };
+    const C6Logger::LoggerStats& s = r.stats;
+    // Share of the producers' time spent waiting for the lock
+    double waitShare = r.seconds > 0.0 ? static_cast<double>(s.lockWait.totalNs) / (r.seconds * 1e9 * r.threads) : 0.0;
+    return {
+        label, settings.mode, count(r.threads), num(r.seconds), count(r.calls),
+        num(r.seconds > 0.0 ? static_cast<double>(r.calls) / r.seconds : 0.0), num(r.fairness),
+        count(r.minThreadCalls), count(r.maxThreadCalls),
+        count(r.latency.Percentile(0.50)), count(r.latency.Percentile(0.99)), count(r.latency.Percentile(0.999)), count(r.latency.maxNs),
+        count(s.lockWait.count), num(Mean(s.lockWait)), count(LockPercentile(s.lockWait, 0.99)), count(s.lockWait.maxNs), num(waitShare),
+        num(Mean(s.lockHold)), count(LockPercentile(s.lockHold, 0.99)), count(s.lockHold.maxNs),
+        count(s.compaction.count), num(Mean(s.compaction)), count(LockPercentile(s.compaction, 0.99)), count(s.compaction.maxNs)
+    };
+}
+
+static std::vector<std::string> SplitList(const std::string& text) {
+    std::vector<std::string> parts;
+    std::size_t start = 0;
+    while (start <= text.size()) {
+        std::size_t comma = text.find(',', start);
+        if (comma == std::string::npos) comma = text.size();
+        if (comma > start) parts.push_back(text.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return parts;
+}
+
+int main(int argc, char** argv) {
+    Settings settings;
+    std::string threadList;
+    std::string format = "csv";
+    std::string label = "dev";
+    bool header = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--threads" && hasValue) threadList = argv[++i];
+        else if (arg == "--mode" && hasValue) settings.mode = argv[++i];
+        else if (arg == "--duration-ms" && hasValue) settings.durationMs = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--sizes" && hasValue) {
+            settings.sizes.clear();
+            for (const auto& size : SplitList(argv[++i])) settings.sizes.push_back(std::strtoull(size.c_str(), nullptr, 10));
+        }
+        else if (arg == "--messengers" && hasValue) settings.messengers = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--max-lines" && hasValue) settings.maxLines = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--dir" && hasValue) settings.dir = argv[++i];
+        else if (arg == "--format" && hasValue) format = argv[++i];
+        else if (arg == "--label" && hasValue) label = argv[++i];
+        else if (arg == "--no-header") header = false;
+        else {
+            std::fprintf(stderr, "usage: %s [--threads 1,2,4|max] [--mode memory|compacting|append|sharded] [--duration-ms MS]\n"
+                "          [--sizes 64,256,1024] [--messengers K] [--max-lines N] [--dir DIR] [--format csv|json]\n"
+                "          [--label TEXT] [--no-header]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (settings.mode != "memory" && settings.mode != "compacting" && settings.mode != "append" && settings.mode != "sharded") {
+        std::fprintf(stderr, "unknown mode '%s'\n", settings.mode.c_str());
+        return 2;
+    }
+    if (format != "csv" && format != "json") {
+        std::fprintf(stderr, "unknown format '%s'\n", format.c_str());
+        return 2;
+    }
+    if (settings.sizes.empty()) settings.sizes.push_back(64);
+
+    // Default: 1, 2, 4, ... up to the core count, which is always included
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> threadCounts;
+    if (threadList.empty()) {
+        for (unsigned n = 1; n < cores; n *= 2) threadCounts.push_back(n);
+        threadCounts.push_back(cores);
+    }
+    else {
+        for (const auto& item : SplitList(threadList)) {
+            threadCounts.push_back(item == "max" ? cores : static_cast<unsigned>(std::max(1, std::atoi(item.c_str()))));
+        }
+    }
+
+    C6Logger::SetLockProfiling(true);
+    std::size_t columns = sizeof(COLUMNS) / sizeof(COLUMNS[0]);
+    if (format == "csv" && header) {
+        for (std::size_t c = 0; c < columns; ++c) std::printf("%s%s", c ? "," : "", COLUMNS[c]);
+        std::printf("\n");
+    }
+    if (format == "json") std::printf("[\n");
+    for (std::size_t n = 0; n < threadCounts.size(); ++n) {
+        Result result = Run(settings, threadCounts[n]);
+        std::vector<std::string> values = Values(label, settings, result);
+        if (format == "csv") {
+            for (std::size_t c = 0; c < columns; ++c) std::printf("%s%s", c ? "," : "", values[c].c_str());
+            std::printf("\n");
+        }
+        else {
+            std::printf("  {");
+            for (std::size_t c = 0; c < columns; ++c) {
+                bool text = c < 2; // label and mode
+                std::printf("%s\"%s\": %s%s%s", c ? ", " : "", COLUMNS[c], text ? "\"" : "", values[c].c_str(), text ? "\"" : "");
+            }
+            std::printf("}%s\n", n + 1 < threadCounts.size() ? "," : "");
+        }
+        std::fflush(stdout);
+    }
+    if (format == "json") std::printf("]\n");
+    return 0;
+}
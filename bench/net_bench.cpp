@@ -0,0 +1,89 @@
+// net_bench: NetworkSink throughput from one sender thread over loopback TCP.
+//
+//   net_bench [--records R] [--size BYTES] [--batch-kb KB]
+//
+// A receiver thread accepts one connection on 127.0.0.1 and discards what it
+// reads. R records of the given size go straight to NetworkSink::Write(); the time
+// runs until Flush() returns and the receiver has seen every byte. The spool is
+// disabled, so records the queue cannot take are counted as dropped. The target
+// is 1 GbE (125 MB/s) from the single sender thread.
+
+#include "../include/LogNetworkSink.h"
+#include "../include/LogClock.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+int main(int argc, char** argv) {
+    std::size_t records = 2000000;
+    std::size_t size = 120;
+    std::size_t batchKb = 256;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--records" && i + 1 < argc) records = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--size" && i + 1 < argc) size = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--batch-kb" && i + 1 < argc) batchKb = std::strtoull(argv[++i], nullptr, 10);
+        else {
+            std::fprintf(stderr, "usage: %s [--records R] [--size BYTES] [--batch-kb KB]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, 1) != 0 || getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        std::perror("listen");
+        return 1;
+    }
+    std::atomic<std::uint64_t> received{ 0 };
+    std::thread receiver([&] {
+        int connection = accept(listener, nullptr, nullptr);
+        static char buffer[1 << 20];
+        for (;;) {
+            ssize_t n = recv(connection, buffer, sizeof(buffer), 0);
+            if (n <= 0) break;
+            received.fetch_add(static_cast<std::uint64_t>(n), std::memory_order_relaxed);
+        }
+        close(connection);
+    });
+
+    C6Logger::NetworkSinkConfig config;
+    config.port = ntohs(address.sin_port);
+    config.spoolPath = "-";
+    config.batchBytes = batchKb << 10;
+    config.maxQueueBytes = std::size_t(256) << 20;
+    std::string line(size, 'x');
+    C6Logger::NetworkSinkStats stats;
+    std::int64_t elapsed = 0;
+    {
+        C6Logger::NetworkSink sink(config);
+        std::int64_t start = C6Logger::MonotonicNs();
+        for (std::size_t i = 0; i < records; ++i) sink.Write(C6Logger::LogLevel::info, line, 0);
+        sink.Flush();
+        stats = sink.Stats();
+        while (received.load(std::memory_order_relaxed) < stats.sentBytes) std::this_thread::yield();
+        elapsed = C6Logger::MonotonicNs() - start;
+    }
+    receiver.join();
+    close(listener);
+
+    double seconds = static_cast<double>(elapsed) / 1e9;
+    double megabytes = static_cast<double>(stats.sentBytes) / 1e6;
+    std::printf("records sent %llu, dropped %llu, %.1f MB in %.3f s\n",
+        static_cast<unsigned long long>(stats.sentRecords), static_cast<unsigned long long>(stats.dropped), megabytes, seconds);
+    std::printf("%.1f MB/s = %.2f Gbit/s, %.0f records/s\n", megabytes / seconds, megabytes * 8 / 1000 / seconds,
+        static_cast<double>(stats.sentRecords) / seconds);
+    return 0;
+}
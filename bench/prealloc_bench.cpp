@@ -0,0 +1,131 @@
+// prealloc_bench: append latency and file fragmentation with and without preallocation.
+//
+//   prealloc_bench [--mode none|keep|explicit] [--records N] [--threads T]
+//                  [--extent-mb M] [--dir DIR]
+//
+// Writes N records through Log() in FileMode::AtomicAppend into DIR/C6GE/log.txt
+// (DIR defaults to the current directory; point it at the filesystem under test).
+// Console output goes to /dev/null; results are printed to stderr. Run once per
+// mode and compare the latency percentiles and the extent count.
+
+#include "../include/Logger.h"
+#include "../include/LogClock.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+// Number of extents backing the file, or -1 if FIEMAP is unavailable
+static long CountExtents(const std::string& path) {
+#if defined(__linux__)
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    struct fiemap query;
+    std::memset(&query, 0, sizeof(query));
+    query.fm_length = FIEMAP_MAX_OFFSET;
+    query.fm_flags = FIEMAP_FLAG_SYNC;
+    query.fm_extent_count = 0; // only count
+    long extents = ioctl(fd, FS_IOC_FIEMAP, &query) == 0 ? static_cast<long>(query.fm_mapped_extents) : -1;
+    close(fd);
+    return extents;
+#else
+    (void)path;
+    return -1;
+#endif
+}
+
+static double Percentile(std::vector<std::int64_t>& samples, double p) {
+    if (samples.empty()) return 0.0;
+    std::size_t index = static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(index), samples.end());
+    return static_cast<double>(samples[index]);
+}
+
+int main(int argc, char** argv) {
+    std::string mode = "none";
+    std::string dir = ".";
+    std::size_t records = 200000;
+    int threads = 1;
+    std::size_t extentMb = 8;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--mode" && i + 1 < argc) mode = argv[++i];
+        else if (arg == "--records" && i + 1 < argc) records = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--threads" && i + 1 < argc) threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--extent-mb" && i + 1 < argc) extentMb = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--dir" && i + 1 < argc) dir = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: %s [--mode none|keep|explicit] [--records N] [--threads T] [--extent-mb M] [--dir DIR]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    C6Logger::PreallocationPolicy policy;
+    if (mode == "keep") policy.mode = C6Logger::Preallocation::KeepSize;
+    else if (mode == "explicit") policy.mode = C6Logger::Preallocation::ExplicitSize;
+    else if (mode != "none") {
+        std::fprintf(stderr, "unknown mode '%s'\n", mode.c_str());
+        return 2;
+    }
+    policy.extentBytes = extentMb << 20;
+
+#if defined(__linux__)
+    setenv("XDG_STATE_HOME", std::filesystem::absolute(dir).string().c_str(), 1);
+#endif
+    std::string logPath = C6Logger::GetLogPath();
+    std::error_code ec;
+    std::filesystem::remove(logPath, ec);
+    std::filesystem::remove(logPath + ".lock", ec);
+    if (!std::freopen("/dev/null", "w", stdout)) return 1;
+
+    C6Logger::SetFileMode(C6Logger::FileMode::AtomicAppend);
+    C6Logger::SetPreallocation(policy);
+
+    // Distinct lines of realistic length
+    std::vector<std::vector<std::int64_t>> latencies(static_cast<std::size_t>(threads));
+    std::size_t perThread = records / static_cast<std::size_t>(threads);
+    std::int64_t start = C6Logger::MonotonicNs();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            auto& samples = latencies[static_cast<std::size_t>(t)];
+            samples.reserve(perThread);
+            char message[160];
+            for (std::size_t i = 0; i < perThread; ++i) {
+                std::snprintf(message, sizeof(message), "thread %d frame %zu: uploaded 4096 vertices to buffer 17 in 0.42 ms", t, i);
+                std::int64_t begin = C6Logger::MonotonicNs();
+                C6Logger::Log(C6Logger::LogLevel::info, message, "Bench");
+                samples.push_back(C6Logger::MonotonicNs() - begin);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    std::int64_t elapsed = C6Logger::MonotonicNs() - start;
+
+    C6Logger::LoggerStats stats = C6Logger::GetStats();
+
+    std::vector<std::int64_t> all;
+    for (auto& samples : latencies) all.insert(all.end(), samples.begin(), samples.end());
+    std::uint64_t size = std::filesystem::file_size(logPath, ec);
+    std::fprintf(stderr, "mode=%s threads=%d records=%zu extent=%zuMiB\n", mode.c_str(), threads, all.size(), extentMb);
+    std::fprintf(stderr, "  throughput  %.0f records/s\n", static_cast<double>(all.size()) * 1e9 / static_cast<double>(elapsed));
+    std::fprintf(stderr, "  latency ns  p50 %.0f  p99 %.0f  p99.9 %.0f  max %.0f\n",
+        Percentile(all, 0.50), Percentile(all, 0.99), Percentile(all, 0.999), Percentile(all, 1.0));
+    // Still preallocated: the tail is trimmed when the process exits
+    std::fprintf(stderr, "  file        %llu bytes, %ld extents, %llu fallocate calls\n",
+        static_cast<unsigned long long>(size), CountExtents(logPath), static_cast<unsigned long long>(stats.preallocations));
+    return 0;
+}
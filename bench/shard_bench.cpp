@@ -0,0 +1,80 @@
+// shard_bench: Log() throughput from 1 to N threads, single lock versus sharded.
+//
+//   shard_bench [--max-threads N] [--records R] [--dir DIR]
+//
+// Each run uses a fresh Logger in FileMode::AtomicAppend with console output off,
+// once unsharded and once with one shard per hardware thread. R records are split
+// across the threads; the time includes the final Flush(), so merged output has
+// reached the file. Results are printed as a table of records per second.
+
+#include "../include/Logger.h"
+#include "../include/LogClock.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+static double RunOnce(const std::string& path, int threads, std::size_t records, std::size_t shards) {
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    double perSecond = 0.0;
+    {
+        C6Logger::LoggerConfig config;
+        config.path = path;
+        config.console = false;
+        config.fileMode = C6Logger::FileMode::AtomicAppend;
+        config.shards = shards;
+        C6Logger::Logger logger(config);
+
+        std::size_t perThread = records / static_cast<std::size_t>(threads);
+        std::int64_t start = C6Logger::MonotonicNs();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&logger, perThread, t] {
+                char message[128];
+                for (std::size_t i = 0; i < perThread; ++i) {
+                    int n = std::snprintf(message, sizeof(message), "worker %d processed request %zu in 137 us", t, i);
+                    logger.Log(C6Logger::LogLevel::info, std::string_view(message, static_cast<std::size_t>(n)), "Bench");
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        logger.Flush();
+        std::int64_t elapsed = C6Logger::MonotonicNs() - start;
+        perSecond = static_cast<double>(perThread * static_cast<std::size_t>(threads)) * 1e9 / static_cast<double>(elapsed);
+    }
+    std::filesystem::remove(path, ec);
+    std::filesystem::remove(path + ".lock", ec);
+    return perSecond;
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = 64;
+    std::size_t records = 1000000;
+    std::string dir = std::filesystem::temp_directory_path().string();
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--max-threads" && i + 1 < argc) maxThreads = std::atoi(argv[++i]);
+        else if (arg == "--records" && i + 1 < argc) records = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--dir" && i + 1 < argc) dir = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: %s [--max-threads N] [--records R] [--dir DIR]\n", argv[0]);
+            return 2;
+        }
+    }
+    std::size_t shards = std::thread::hardware_concurrency();
+    if (shards == 0) shards = 1;
+    std::string path = (std::filesystem::path(dir) / "shard_bench.txt").string();
+
+    std::printf("%8s %16s %16s   (records/s, %zu shards, %zu records)\n", "threads", "single-lock", "sharded", shards, records);
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        double single = RunOnce(path, threads, records, 0);
+        double sharded = RunOnce(path, threads, records, shards);
+        std::printf("%8d %16.0f %16.0f\n", threads, single, sharded);
+        std::fflush(stdout);
+    }
+    return 0;
+}
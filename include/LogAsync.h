@@ -0,0 +1,112 @@
+#pragma once
+
+// C++20 coroutine front end for a sharded Logger. Requires -std=c++20 and the
+// C6LOGGER_COROUTINES CMake option (target C6LoggerAsync); the library itself stays C++17.
+
+#if !defined(__cpp_impl_coroutine) || !defined(__cpp_concepts)
+#error "LogAsync.h requires C++20 coroutines and concepts"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <thread>
+#include <utility>
+
+#include "Logger.h"
+
+namespace C6Logger {
+	// An executor that can resume a coroutine. Schedule() is called from a logger
+	// thread (the merger or the sync thread) and should hand the handle to the
+	// executor's own queue rather than resume it in place.
+	template<class S>
+	concept LogScheduler = requires(S& scheduler, std::coroutine_handle<> handle) {
+		scheduler.Schedule(handle);
+	};
+
+	// Resumes the coroutine on the logger thread that completed the operation. Fine
+	// for short continuations; a coroutine resumed this way must not block on, or
+	// destroy, the logger that resumed it.
+	struct InlineScheduler {
+		void Schedule(std::coroutine_handle<> handle) { handle.resume(); }
+	};
+
+	namespace detail {
+		// Suspends until Logger::FlushAsync/SyncAsync calls back. If the callback runs
+		// before await_suspend finishes (an unsharded logger, or a very fast merger),
+		// the coroutine is not suspended at all and the scheduler is not involved.
+		template<LogScheduler S>
+		class LogCompletion {
+		public:
+			LogCompletion(Logger& owner, S& executor, bool syncToDisk)
+				: logger(owner), scheduler(executor), sync(syncToDisk) {}
+
+			bool await_ready() const noexcept { return false; }
+
+			bool await_suspend(std::coroutine_handle<> awaiting) {
+				handle = awaiting;
+				auto done = [this] {
+					if (state.exchange(COMPLETED, std::memory_order_acq_rel) == SUSPENDED) scheduler.Schedule(handle);
+				};
+				if (sync) logger.SyncAsync(done);
+				else logger.FlushAsync(done);
+				return state.exchange(SUSPENDED, std::memory_order_acq_rel) == PENDING;
+			}
+
+			void await_resume() const noexcept {}
+
+		private:
+			static constexpr int PENDING = 0;
+			static constexpr int SUSPENDED = 1;
+			static constexpr int COMPLETED = 2;
+
+			Logger& logger;
+			S& scheduler;
+			bool sync;
+			std::coroutine_handle<> handle;
+			std::atomic<int> state{ PENDING };
+		};
+	}
+
+	// A sharded logger for coroutine code. Log() only appends to the calling CPU's
+	// shard; the merger thread does the console, sink and file work. Flush() and
+	// Sync() are awaitables that complete once everything logged before them has been
+	// delivered (Flush) and also fdatasync'ed (Sync), without blocking the awaiting thread:
+	//
+	//     co_await logger.Flush();
+	//     co_await logger.Sync();
+	template<LogScheduler S = InlineScheduler>
+	class AsyncLogger {
+	public:
+		// config.shards == 0 picks one shard per hardware thread
+		explicit AsyncLogger(LoggerConfig config = LoggerConfig(), S executor = S())
+			: scheduler(std::move(executor)), logger(Sharded(std::move(config))) {}
+
+		// Waits for the merger only if the caller's shard holds 4 MiB not yet merged
+		void Log(LogLevel level, std::string_view message, std::string_view messenger = std::string_view()) {
+			logger.Log(level, message, messenger);
+		}
+
+		// Never waits: a line that finds its shard full is dropped and false returned
+		bool TryLog(LogLevel level, std::string_view message, std::string_view messenger = std::string_view()) {
+			return logger.TryLog(level, message, messenger);
+		}
+
+		[[nodiscard]] detail::LogCompletion<S> Flush() { return detail::LogCompletion<S>(logger, scheduler, false); }
+		[[nodiscard]] detail::LogCompletion<S> Sync() { return detail::LogCompletion<S>(logger, scheduler, true); }
+
+		// The underlying logger, for sinks, durability policy and stats
+		Logger& Base() { return logger; }
+
+	private:
+		static LoggerConfig Sharded(LoggerConfig config) {
+			if (config.shards == 0) {
+				unsigned cores = std::thread::hardware_concurrency();
+				config.shards = cores ? cores : 1;
+			}
+			return config;
+		}
+
+		S scheduler;
+		Logger logger;   // destroyed first: pending completions still reach the scheduler
+	};
+}
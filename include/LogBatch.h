@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Logger.h"
+#include "LogMessenger.h"
+
+namespace C6Logger {
+	// Lines collected locally and logged as one unit: one lock acquisition (or shard
+	// reservation), one timestamp shared by every line, one file write, and no lines
+	// from other threads in between. In FileMode::AtomicAppend the unit holds across
+	// processes as long as the batch fits ATOMIC_RECORD_LIMIT; larger batches are
+	// contiguous among this process's threads only. A shared-ring producer publishes
+	// the batch as one ring record, which the collector writes as a unit; a batch too
+	// large for one record (about 230 KiB) goes line by line, and lines from other
+	// processes can then land in between.
+	//
+	//   C6Logger::LogBatch report;
+	//   report.Add(LogLevel::info, "frame 812", "Renderer")
+	//         .Add(LogLevel::info, "  draw calls: 1430", "Renderer");
+	//   report.Commit();   // or let the destructor commit
+	class LogBatch {
+	public:
+		explicit LogBatch(Logger& logger = Logger::Default());
+		~LogBatch();   // commits what is left
+
+		LogBatch(const LogBatch&) = delete;
+		LogBatch& operator=(const LogBatch&) = delete;
+
+		// Lines below the logger's level, or the messenger's, are dropped here
+		LogBatch& Add(LogLevel level, std::string_view message, std::string_view messenger = std::string_view());
+		LogBatch& Add(LogLevel level, std::string_view message, const Messenger& messenger);
+
+		// Logs the lines and empties the batch, which keeps its buffers for reuse
+		void Commit();
+		void Discard();
+
+		std::size_t Size() const { return records.size(); }
+		bool Empty() const { return records.empty(); }
+
+		struct Entry {
+			LogLevel level;
+			std::string_view message;
+			std::string_view messenger;
+			std::string_view messengerPrefix;   // set for interned messengers
+		};
+		Entry At(std::size_t index) const;
+
+	private:
+		struct Record {
+			LogLevel level;
+			std::size_t messageOffset;
+			std::size_t messageLength;
+			std::size_t messengerOffset;
+			std::size_t messengerLength;
+			Messenger interned;
+		};
+
+		Logger& logger;
+		std::string text;
+		std::vector<Record> records;
+	};
+}
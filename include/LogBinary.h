@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Logger.h"
+
+namespace C6Logger {
+	// Framed binary log format (".c6b"), an unambiguous alternative to the text log.
+	//
+	// Layout (little endian):
+	//   header  "C6BL" u8 version u8 reserved[3]
+	//   records u32 payloadLength, u32 crc32c, u8 type, u8 level, u16 flags,
+	//           u32 messengerId, i64 wallNs, payload
+	//
+	// The CRC-32C covers the record from 'type' to the end of the payload. Record
+	// types are log lines (payload = message), messenger definitions (payload =
+	// name, giving messengerId its meaning for the rest of the file) and sync
+	// markers (payload = a fixed 16-byte pattern), written at the start of every
+	// session and at least every BINARY_SYNC_INTERVAL bytes. A reader can start at
+	// any offset, find the next sync marker and continue from there; it skips
+	// records it does not need by their length, and a torn or corrupt tail fails
+	// its checksum instead of producing a garbled line.
+
+	static constexpr std::uint32_t BINARY_SYNC_INTERVAL = 64 * 1024;
+	static constexpr std::uint32_t BINARY_MAX_PAYLOAD = 16u << 20;
+
+	// CRC-32C (Castagnoli). Uses the SSE4.2 crc32 instruction when the CPU has it.
+	// Chains: Crc32c(b, nb, Crc32c(a, na)) equals the CRC of a followed by b.
+	std::uint32_t Crc32c(const void* data, std::size_t size, std::uint32_t crc = 0);
+
+	// Appends records to a binary log. One writer per file; reopening an existing
+	// file restores its messenger table and cuts off a torn last record. While it is
+	// open, CompactBinaryLog() on the same file refuses to run (POSIX; elsewhere the
+	// caller must not compact a file that has an open writer or BinaryLogSink).
+	class BinaryLogWriter {
+	public:
+		explicit BinaryLogWriter(const std::string& path);
+		~BinaryLogWriter();
+
+		BinaryLogWriter(const BinaryLogWriter&) = delete;
+		BinaryLogWriter& operator=(const BinaryLogWriter&) = delete;
+
+		bool IsOpen() const { return out.is_open(); }
+		bool Append(std::int64_t wallNs, LogLevel level, std::string_view messenger, std::string_view message);
+		bool Flush();
+
+		std::uint64_t Size() const { return size; }
+
+	private:
+		bool Recover();
+		bool LockAgainstCompaction();
+		bool Emit(std::uint8_t type, LogLevel level, std::uint32_t messengerId, std::int64_t wallNs, std::string_view payload);
+
+		std::string path;
+		std::ofstream out;
+		std::unordered_map<std::string, std::uint32_t> messengerIds;
+		std::uint32_t nextMessengerId = 1;   // above every id defined in the file
+		int lockFd = -1;                     // shared flock held against compaction
+		std::string record;
+		std::uint64_t size = 0;
+		std::uint64_t lastSync = 0;
+	};
+
+	// Writes every line of a logger to a binary log, with its exact timestamp
+	class BinaryLogSink : public LogSink {
+	public:
+		explicit BinaryLogSink(const std::string& path) : writer(path) {}
+
+		bool IsOpen() const { return writer.IsOpen(); }
+
+		void Write(LogLevel level, std::string_view line, std::size_t headerLength) override;
+		void WriteRecord(const LogRecordView& record) override;
+		void Flush() override { writer.Flush(); }
+
+	private:
+		BinaryLogWriter writer;
+	};
+
+	struct BinaryRecord {
+		std::uint64_t offset = 0;        // file offset of the record
+		std::int64_t wallNs = 0;
+		LogLevel level = LogLevel::info;
+		std::uint32_t messengerId = 0;   // 0 = none
+		std::string_view messenger;      // valid until the next call on the reader
+		std::string_view message;        // valid until the next call on the reader
+	};
+
+	class BinaryLogReader {
+	public:
+		explicit BinaryLogReader(const std::string& path);
+
+		bool IsOpen() const { return valid; }
+
+		// Next log record. Corrupt regions are skipped by resynchronizing at the next
+		// sync marker; returns false at the end of the file or at a torn tail.
+		bool Next(BinaryRecord& record);
+
+		// Continues from the first sync marker at or after 'offset'
+		bool Seek(std::uint64_t offset);
+
+		std::uint64_t Offset() const { return position; }
+		std::uint64_t FileSize() const { return fileSize; }
+		std::uint64_t CorruptRecords() const { return corrupt; }
+		bool TornTail() const { return tornTail; }
+
+	private:
+		enum class ReadResult { Record, End, Corrupt };
+		ReadResult ReadRecord(std::uint64_t at, bool wantPayload);
+		bool Resync(std::uint64_t from);
+		std::string_view MessengerName(std::uint32_t id);
+
+		std::ifstream in;
+		bool valid = false;
+		bool tornTail = false;
+		std::uint64_t fileSize = 0;
+		std::uint64_t position = 0;
+		std::uint64_t corrupt = 0;
+		std::unordered_map<std::uint32_t, std::string> messengers;
+		std::uint64_t messengersScannedTo = 0;   // definitions before this offset are known
+
+		// Last record read
+		std::uint32_t payloadLength = 0;
+		std::uint8_t type = 0;
+		std::uint8_t levelByte = 0;
+		std::uint32_t messengerId = 0;
+		std::int64_t wallNs = 0;
+		std::string payload;
+	};
+
+	// Rewrites a binary log keeping its last maxRecords log records, and only the
+	// messenger definitions they use. Records are skipped by length, not parsed.
+	// Fails if a BinaryLogWriter has the file open: it would keep appending to the
+	// replaced file.
+	bool CompactBinaryLog(const std::string& path, std::size_t maxRecords);
+
+	bool IsBinaryLog(const std::string& path);
+}
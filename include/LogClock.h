@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+namespace C6Logger {
+	// Where log timestamps come from.
+	enum class ClockSource {
+		System,          // std::chrono::system_clock (default)
+		RealtimeCoarse,  // CLOCK_REALTIME_COARSE: cheapest wall time, tick-granular
+		Tsc,             // calibrated invariant TSC: raw cycles on the hot path, converted later
+		Monotonic        // CLOCK_MONOTONIC anchored to wall time when selected
+	};
+
+	// Selects the timestamp source. Sources the platform lacks (no invariant TSC,
+	// no coarse clock) fall back to System; GetClockSource() reports the effective one.
+	void SetClockSource(ClockSource source);
+	ClockSource GetClockSource();
+	const char* ClockSourceName(ClockSource source);
+
+	// Captures a raw timestamp from the active source. The top two bits tag the
+	// source so a stamp converts correctly even if the source changes afterwards.
+	std::uint64_t ClockNow();
+
+	// Converts a raw stamp to wall-clock nanoseconds since the Unix epoch. For TSC
+	// stamps this applies the current calibration, refreshing it about once a second.
+	std::int64_t ClockToWallNs(std::uint64_t stamp);
+
+	// Monotonic nanoseconds, for measuring intervals
+	std::int64_t MonotonicNs();
+
+	// Digits of sub-second precision printed in log timestamps (0-9, default 0)
+	void SetTimestampPrecision(int digits);
+	int GetTimestampPrecision();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace C6Logger {
+	// Framed block compression for sealed log segments (".c6z").
+	//
+	// Layout (little endian):
+	//   header  "C6LZ" u8 version u8 flags u8 blockSizeLog2 u8 reserved
+	//   blocks  u32 rawSize, u32 storedSize (bit 31 = stored uncompressed), u32 checksum, payload
+	//   end     u32 0, u32 0
+	//   index   per block { u64 rawOffset, u64 fileOffset }
+	//   footer  u64 indexOffset, u32 blockCount, "C6IX"
+	//
+	// Every block is compressed on its own, so a reader can start at any block
+	// through the index without touching the ones before it.
+
+	static constexpr std::size_t COMPRESS_BLOCK_SIZE = 256 * 1024;
+
+	// Worst case output size of CompressBlock for an input of size n
+	std::size_t CompressBound(std::size_t n);
+
+	// LZ77 block codec. CompressBlock returns the compressed size, or 0 if the block
+	// did not shrink (callers then store it raw). DecompressBlock returns false on corrupt input.
+	std::size_t CompressBlock(const char* src, std::size_t srcSize, char* dst, std::size_t dstCapacity);
+	bool DecompressBlock(const char* src, std::size_t srcSize, char* dst, std::size_t rawSize);
+
+	class CompressedLogWriter {
+	public:
+		explicit CompressedLogWriter(const std::string& path);
+		~CompressedLogWriter();
+
+		bool IsOpen() const { return out.is_open(); }
+		bool Write(std::string_view data);
+		// Flushes the last partial block and writes the end marker, index and footer
+		bool Finish();
+
+		std::uint64_t RawBytes() const { return rawBytes; }
+		std::uint64_t StoredBytes() const { return storedBytes; }
+
+	private:
+		bool EmitBlock();
+
+		std::ofstream out;
+		std::vector<char> pending;
+		std::vector<char> scratch;
+		std::vector<std::uint64_t> index; // rawOffset, fileOffset pairs
+		std::uint64_t rawBytes = 0;
+		std::uint64_t storedBytes = 0;
+		bool finished = false;
+	};
+
+	class CompressedLogReader {
+	public:
+		explicit CompressedLogReader(const std::string& path);
+
+		bool IsOpen() const { return valid; }
+
+		// Streaming: decompresses the next block, the view stays valid until the next call
+		bool NextBlock(std::string_view& data);
+
+		// Random access through the trailing index (absent if the writer never finished)
+		bool HasIndex() const { return !blockRawOffsets.empty(); }
+		std::size_t BlockCount() const { return blockRawOffsets.size(); }
+		std::uint64_t BlockRawOffset(std::size_t block) const { return blockRawOffsets[block]; }
+		// Positions the stream at the block containing rawOffset; NextBlock continues from there
+		bool SeekToRawOffset(std::uint64_t rawOffset, std::size_t& skipInBlock);
+
+	private:
+		bool LoadIndex();
+
+		std::ifstream in;
+		bool valid = false;
+		std::vector<std::uint64_t> blockRawOffsets;
+		std::vector<std::uint64_t> blockFileOffsets;
+		std::vector<char> payload;
+		std::vector<char> block;
+	};
+
+	// One-shot helpers
+	bool CompressFile(const std::string& inPath, const std::string& outPath);
+	bool IsCompressedLog(const std::string& path);
+
+	// Background compression of sealed segments. The plain file is replaced by
+	// "<stem>.c6z" once its compressed copy has been written completely.
+	void CompressSegmentAsync(const std::string& plainPath);
+	// Blocks until every queued segment has been processed
+	void WaitForSegmentCompression();
+}
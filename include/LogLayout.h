@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "Logger.h"
+
+namespace C6Logger {
+	// Line layouts. A pattern is compiled once into a flat list of steps, which
+	// Log() runs straight into its line buffer; nothing is parsed per line.
+	//
+	//   %t  timestamp (SetTimestampPrecision applies)   %l  level name
+	//   %n  messenger                                   %T  thread id
+	//   %v  message (required, once)                    %%  a literal '%'
+	//   %s  source location "file.cpp:42" of C6_LOG calls (LogSite.h), else empty
+	//   %{ ... %}  left out when the line has no messenger (not nested)
+	//
+	// Compaction deduplicates lines of the default layout only; with another
+	// layout it just trims. c6log-grep understands the default layout.
+	static constexpr const char* DEFAULT_LOG_LAYOUT = "[%t] %{[%n] %}[%l] %v";
+
+	enum class LayoutOp : std::uint8_t {
+		Literal,     // pattern[offset, offset + length)
+		Timestamp,
+		Level,
+		Messenger,
+		ThreadId,
+		Location,
+		Message,
+		Group        // skips the next 'length' steps when the messenger is empty;
+		             // offset 1 marks "%{[%n] %}", written from a Messenger's prefix
+	};
+
+	struct LayoutStep {
+		LayoutOp op = LayoutOp::Literal;
+		std::uint32_t offset = 0;
+		std::uint32_t length = 0;
+	};
+
+	static constexpr std::size_t MAX_LAYOUT_STEPS = 32;
+
+	struct CompiledLayout {
+		std::array<LayoutStep, MAX_LAYOUT_STEPS> steps{};
+		std::size_t count = 0;
+		bool valid = false;
+	};
+
+	namespace detail {
+		constexpr bool PushLayoutStep(CompiledLayout& layout, LayoutOp op, std::size_t offset, std::size_t length) {
+			if (layout.count == MAX_LAYOUT_STEPS) return false;
+			layout.steps[layout.count].op = op;
+			layout.steps[layout.count].offset = static_cast<std::uint32_t>(offset);
+			layout.steps[layout.count].length = static_cast<std::uint32_t>(length);
+			++layout.count;
+			return true;
+		}
+	}
+
+	// Usable in constant expressions, so a fixed pattern can be checked when the
+	// program is built: static_assert(C6Logger::CompileLayout("%t %l %v").valid);
+	constexpr CompiledLayout CompileLayout(std::string_view pattern) {
+		CompiledLayout layout;
+		bool message = false;
+		std::size_t group = MAX_LAYOUT_STEPS; // open group step, if any
+		std::size_t literal = 0;              // start of the pending literal
+		for (std::size_t i = 0; i < pattern.size(); ++i) {
+			if (pattern[i] != '%') continue;
+			if (i + 1 == pattern.size()) return layout;
+			char field = pattern[i + 1];
+			std::size_t literalEnd = field == '%' ? i + 1 : i; // "%%" keeps one '%'
+			if (literalEnd > literal && !detail::PushLayoutStep(layout, LayoutOp::Literal, literal, literalEnd - literal)) return layout;
+			literal = i + 2;
+			++i;
+			bool pushed = true;
+			switch (field) {
+			case '%': break;
+			case 't': pushed = detail::PushLayoutStep(layout, LayoutOp::Timestamp, 0, 0); break;
+			case 'l': pushed = detail::PushLayoutStep(layout, LayoutOp::Level, 0, 0); break;
+			case 'n': pushed = detail::PushLayoutStep(layout, LayoutOp::Messenger, 0, 0); break;
+			case 'T': pushed = detail::PushLayoutStep(layout, LayoutOp::ThreadId, 0, 0); break;
+			case 's': pushed = detail::PushLayoutStep(layout, LayoutOp::Location, 0, 0); break;
+			case 'v':
+				if (message) return layout;
+				message = true;
+				pushed = detail::PushLayoutStep(layout, LayoutOp::Message, 0, 0);
+				break;
+			case '{':
+				if (group != MAX_LAYOUT_STEPS) return layout;
+				group = layout.count;
+				pushed = detail::PushLayoutStep(layout, LayoutOp::Group, 0, 0);
+				break;
+			case '}':
+				if (group == MAX_LAYOUT_STEPS) return layout;
+				layout.steps[group].length = static_cast<std::uint32_t>(layout.count - group - 1);
+				group = MAX_LAYOUT_STEPS;
+				break;
+			default: return layout;
+			}
+			if (!pushed) return layout;
+		}
+		if (pattern.size() > literal && !detail::PushLayoutStep(layout, LayoutOp::Literal, literal, pattern.size() - literal)) return layout;
+		layout.valid = message && group == MAX_LAYOUT_STEPS;
+		return layout;
+	}
+
+	// Where the parts of a formatted line ended up, relative to its start
+	struct LayoutSpans {
+		std::size_t headerLength = 0;       // bytes before the message
+		std::size_t messengerOffset = 0;
+		bool messengerRendered = false;     // false if the layout has no %n or left it out
+	};
+
+	class LogLayout {
+	public:
+		// An invalid pattern is reported and replaced by DEFAULT_LOG_LAYOUT;
+		// Logger::SetLayout() keeps the current layout instead
+		explicit LogLayout(std::string_view pattern = DEFAULT_LOG_LAYOUT);
+
+		bool IsValid() const { return valid; }
+		const std::string& Pattern() const { return pattern; }
+
+		// Appends one line (no newline) to 'out'; 'location' fills %s. A non-empty
+		// 'messengerPrefix' must be "[" + messenger + "] " (Messenger::Prefix()).
+		LayoutSpans Format(std::string& out, std::uint64_t stamp, LogLevel level, std::string_view message, std::string_view messenger,
+			std::string_view location = std::string_view(), std::string_view messengerPrefix = std::string_view()) const;
+
+	private:
+		std::string pattern;
+		std::string literals;             // literal steps point in here
+		CompiledLayout compiled;
+		std::size_t fixedBytes = 0;       // literals plus the longest timestamp, level and thread id
+		std::size_t messengerCount = 0;
+		std::size_t locationCount = 0;
+		bool valid = true;
+	};
+}
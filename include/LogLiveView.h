@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Logger.h"
+
+namespace C6Logger {
+	// A live view of a process's most recent lines in /dev/shm, for external tools.
+	//
+	// LiveViewSink overwrites a ring of fixed-size slots, each guarded by a sequence
+	// word (a seqlock): odd while the slot is being written, even once the record is
+	// complete. Readers map the object read-only and copy a slot between two reads of
+	// its sequence word, discarding copies the writer overtook, so any number of
+	// readers can snapshot the view without a lock and without writing to memory the
+	// writer touches. Unlike tailing the log file, this is unaffected by compaction
+	// rewriting it. Linux only; elsewhere the sink and readers report !IsOpen().
+
+	struct LiveViewConfig {
+		std::string name = "c6logger";   // shared-memory object "/c6live-<name>"
+		std::uint32_t slotCount = 4096;  // records kept
+		std::uint32_t slotSize = 512;    // bytes per slot; longer lines are truncated
+	};
+
+	namespace detail { struct LiveViewMapping; }
+
+	class LiveViewSink : public LogSink {
+	public:
+		explicit LiveViewSink(LiveViewConfig config = LiveViewConfig());
+		~LiveViewSink() override;   // leaves the view in place for post-mortem reads
+
+		LiveViewSink(const LiveViewSink&) = delete;
+		LiveViewSink& operator=(const LiveViewSink&) = delete;
+
+		bool IsOpen() const { return view != nullptr; }
+
+		void Write(LogLevel level, std::string_view line, std::size_t headerLength) override;
+
+	private:
+		detail::LiveViewMapping* view = nullptr;
+	};
+
+	// Deletes the shared-memory object; mapped readers keep their copy
+	bool RemoveLiveView(const std::string& name = "c6logger");
+
+	struct LiveRecord {
+		std::uint64_t sequence = 0;   // position in the writer's output, from 0
+		LogLevel level = LogLevel::info;
+		bool truncated = false;
+		std::string line;             // the formatted line without a trailing newline
+	};
+
+	class LiveViewReader {
+	public:
+		explicit LiveViewReader(const std::string& name = "c6logger");
+		~LiveViewReader();
+
+		LiveViewReader(const LiveViewReader&) = delete;
+		LiveViewReader& operator=(const LiveViewReader&) = delete;
+
+		bool IsOpen() const { return view != nullptr; }
+
+		// Sequence number the next record will get
+		std::uint64_t Head() const;
+
+		// Up to 'count' of the most recent records, oldest first
+		std::vector<LiveRecord> Snapshot(std::size_t count) const;
+
+		// Appends records from 'cursor' on to 'out' and advances the cursor past them.
+		// Records the writer overwrote before they could be copied are skipped and
+		// counted in 'missed'. Returns the number appended.
+		std::size_t ReadSince(std::uint64_t& cursor, std::vector<LiveRecord>& out, std::uint64_t* missed = nullptr) const;
+
+	private:
+		detail::LiveViewMapping* view = nullptr;
+	};
+}
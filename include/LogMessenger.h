@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Logger.h"
+
+namespace C6Logger {
+	// Interned messengers. A name is looked up once in a process-wide, lock-free
+	// table; the handle then carries the id and the pre-rendered "[name] " prefix,
+	// which the default layout copies in one piece. Handles are cheap to copy and
+	// stay valid for the life of the process.
+	//
+	//   static const C6Logger::Messenger renderer("Renderer");
+	//   C6Logger::Log(C6Logger::LogLevel::info, "frame done", renderer);
+	//   renderer.SetLevel(C6Logger::LogLevel::warning);   // drops its info lines
+
+	static constexpr std::size_t MAX_MESSENGERS = 4096;
+
+	struct MessengerStats {
+		std::uint64_t lines = 0;        // logged through the handle
+		std::uint64_t suppressed = 0;   // below the messenger's level
+	};
+
+	namespace detail {
+		struct MessengerEntry {
+			std::uint32_t id = 0;
+			std::uint64_t hash = 0;
+			std::string name;
+			std::string prefix;   // "[name] "
+			std::atomic<int> level{ 0 };
+			std::atomic<std::uint64_t> lines{ 0 };
+			std::atomic<std::uint64_t> suppressed{ 0 };
+		};
+	}
+
+	class Messenger {
+	public:
+		Messenger() = default;   // no messenger (id 0)
+		// Interns 'name'; an empty name, or a full table, gives the empty handle
+		explicit Messenger(std::string_view name);
+
+		// Handle for an id from Id(); the empty handle if there is none
+		static Messenger FromId(std::uint32_t id);
+
+		std::uint32_t Id() const { return entry ? entry->id : 0; }
+		bool Empty() const { return entry == nullptr; }
+		std::string_view Name() const { return entry ? std::string_view(entry->name) : std::string_view(); }
+		std::string_view Prefix() const { return entry ? std::string_view(entry->prefix) : std::string_view(); }
+
+		// Lines below 'level' are dropped before they are formatted (default: trace)
+		void SetLevel(LogLevel level) const;
+		LogLevel GetLevel() const;
+
+		// True if a line at 'level' passes, without counting it
+		bool Passes(LogLevel level) const {
+			return !entry || static_cast<int>(level) >= entry->level.load(std::memory_order_relaxed);
+		}
+
+		// True if a line at 'level' passes; counts the line as logged or suppressed
+		bool Admit(LogLevel level) const {
+			if (!entry) return true;
+			if (static_cast<int>(level) < entry->level.load(std::memory_order_relaxed)) {
+				entry->suppressed.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			entry->lines.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+
+		MessengerStats Stats() const;
+
+		bool operator==(const Messenger& other) const { return entry == other.entry; }
+		bool operator!=(const Messenger& other) const { return entry != other.entry; }
+
+	private:
+		explicit Messenger(detail::MessengerEntry* interned) : entry(interned) {}
+
+		detail::MessengerEntry* entry = nullptr;
+	};
+
+	// Every messenger interned so far, in id order
+	std::vector<Messenger> GetMessengers();
+
+	template<class Produce>
+	void Logger::LogLazy(LogLevel level, Produce&& produce, const Messenger& messenger) {
+		if (!ShouldLog(level)) return;
+		if (!messenger.Passes(level)) {
+			messenger.Admit(level);   // counts it as suppressed
+			return;
+		}
+		detail::LazyMessage message;
+		produce(message.Text());
+		Log(level, message.Text(), messenger);
+	}
+
+	template<class Produce>
+	void LogLazy(LogLevel level, Produce&& produce, const Messenger& messenger) {
+		Logger::Default().LogLazy(level, std::forward<Produce>(produce), messenger);
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Logger.h"
+
+namespace C6Logger {
+	// Ships lines to a remote collector over TCP or UDP.
+	//
+	// Write() frames the line into an in-memory queue and returns; it never waits for
+	// the network, and drops (and counts) lines once maxQueueBytes are queued. One
+	// sender thread batches the queue into large send() calls. While the collector is
+	// unreachable the sender appends batches to a bounded spool file, reconnects with
+	// exponential backoff, and on success replays the spool in order before sending
+	// anything new. A spool left by a previous run is replayed as well. Delivery is
+	// in order; what the kernel had already accepted on a connection that then
+	// broke is lost, and at most one replayed batch is resent after a crash. The
+	// collector should discard a partial frame at the end of a connection. Unix only.
+
+	enum class NetworkProtocol {
+		Tcp,
+		Udp    // whole records are packed into datagrams of up to datagramBytes
+	};
+
+	enum class NetworkFraming {
+		LengthPrefixed,   // 4-byte big-endian length, then the line
+		Newline           // the line, then '\n'
+	};
+
+	struct NetworkSinkConfig {
+		std::string host = "127.0.0.1";
+		std::uint16_t port = 5170;
+		NetworkProtocol protocol = NetworkProtocol::Tcp;
+		NetworkFraming framing = NetworkFraming::LengthPrefixed;
+		std::size_t batchBytes = 256 << 10;       // sender wakes once this much is queued
+		int flushIntervalMs = 20;                  // longest a line waits for a full batch
+		std::size_t maxQueueBytes = 16 << 20;     // in memory; Write() drops beyond this
+		std::size_t datagramBytes = 1472;          // UDP payload per datagram
+		// Empty: "net-<host>-<port>.spool" next to the default log. "-" disables the
+		// spool, so lines produced while disconnected are dropped.
+		std::string spoolPath;
+		std::size_t maxSpoolBytes = 64 << 20;     // newest batches are dropped beyond this
+		int reconnectMinMs = 100;
+		int reconnectMaxMs = 10000;
+		int connectTimeoutMs = 2000;
+		int sendTimeoutMs = 5000;                  // a send stalled this long counts as a disconnect
+	};
+
+	struct NetworkSinkStats {
+		std::uint64_t sentRecords = 0;
+		std::uint64_t sentBytes = 0;      // payload bytes including framing
+		std::uint64_t spooled = 0;        // records written to the spool
+		std::uint64_t replayed = 0;       // records sent from the spool
+		std::uint64_t dropped = 0;        // queue or spool full, or no spool configured
+		std::uint64_t connects = 0;
+		std::uint64_t connectFailures = 0;
+		bool connected = false;
+	};
+
+	class NetworkSink : public LogSink {
+	public:
+		explicit NetworkSink(NetworkSinkConfig config = NetworkSinkConfig());
+		~NetworkSink() override;   // sends what it can; the rest stays in the spool
+
+		NetworkSink(const NetworkSink&) = delete;
+		NetworkSink& operator=(const NetworkSink&) = delete;
+
+		void Write(LogLevel level, std::string_view line, std::size_t headerLength) override;
+		// Returns once everything written so far was sent or spooled
+		void Flush() override;
+
+		NetworkSinkStats Stats() const;
+
+	private:
+		class State;
+		std::unique_ptr<State> state;
+	};
+}
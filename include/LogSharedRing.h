@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace C6Logger {
+	// Multi-process logging through a shared-memory ring in /dev/shm.
+	//
+	// Producer processes call EnableSharedRingProducer() once; from then on Log()
+	// still prints to the console but publishes the file line into the ring instead
+	// of opening the log file. A single collector (SharedRingCollector, or the
+	// c6log-collectord daemon) drains the ring into the log file, so only one
+	// process ever appends to or compacts it.
+	//
+	// Slots are claimed with a ticket counter and published with a per-slot state
+	// word. If a producer dies between claiming and publishing, the collector
+	// reclaims its slots once the owning pid is gone (or after a timeout) instead
+	// of stalling the ring. Linux only; elsewhere the calls report failure.
+
+	static constexpr std::uint32_t SHARED_RING_SLOT_COUNT = 8192;
+	static constexpr std::uint32_t SHARED_RING_SLOT_SIZE = 256;
+
+	struct SharedRingStats {
+		std::uint64_t published = 0; // records made visible by producers
+		std::uint64_t collected = 0; // records written by the collector
+		std::uint64_t dropped = 0;   // records producers gave up on because the ring stayed full
+		std::uint64_t reclaimed = 0; // slots recovered from crashed or stalled producers
+		std::uint64_t corrupt = 0;   // records discarded on checksum mismatch
+	};
+
+	// Routes this process's Log() output into the named ring. Returns false if the
+	// ring cannot be created or mapped.
+	bool EnableSharedRingProducer(const std::string& name = "c6logger");
+	void DisableSharedRingProducer();
+
+	class SharedRingCollector {
+	public:
+		explicit SharedRingCollector(const std::string& name = "c6logger");
+		~SharedRingCollector();
+
+		SharedRingCollector(const SharedRingCollector&) = delete;
+		SharedRingCollector& operator=(const SharedRingCollector&) = delete;
+
+		bool IsOpen() const { return ring != nullptr; }
+
+		// Writes the records published so far to the log file, at most one lap of the
+		// ring per call, so a ring that producers keep refilling still reaches the file.
+		// Returns the number written; call again while it is non-zero to catch up.
+		std::size_t Drain();
+
+		// Drains until stop becomes true, sleeping on a futex while the ring is empty
+		void Run(const std::atomic<bool>& stop);
+
+		SharedRingStats Stats() const;
+
+		// How long unpublished slots may block the ring when their owner cannot be
+		// identified as dead. A slot a live producer is still writing gets the whole
+		// timeout; a run of taken but unclaimed tickets (left by a producer that gave
+		// up on a full ring) shares one, which restarts only when a record is delivered.
+		void SetStallTimeoutMs(int ms) { stallTimeoutMs = ms; }
+
+	private:
+		bool TryReclaim(std::uint64_t ticket, bool ownerKnownDead, bool claimed);
+
+		struct RingMapping* ring = nullptr;
+		std::vector<char> record;
+		std::string pendingText;
+		std::vector<std::size_t> pendingHeaders;   // header length of each pending line
+		std::uint64_t collected = 0;
+		std::uint64_t stallTicket = ~0ull;
+		std::int64_t stallSinceNs = 0;
+		std::int64_t stallRunSinceNs = 0;   // 0: no run of unpublished tickets
+		int stallTimeoutMs = 1000;
+	};
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "Logger.h"
+#include "LogMessenger.h"
+
+namespace C6Logger {
+	// Call sites. Every C6_LOG macro invocation owns a static constexpr LogSite with
+	// its file, line, function, level, message text and messenger, plus a LogSiteHandle
+	// that registers it on first use. Later calls pass only the handle: the interned
+	// messenger (LogMessenger.h, whose level also applies) and the pre-rendered
+	// "file.cpp:42" (the %s layout field) come from it, and a site switched off at
+	// runtime costs one relaxed load. The message argument is only evaluated when the
+	// site is enabled and its level passes the logger's (Logger::SetLevel).
+	//
+	//   C6_INFO("Renderer", "swapchain recreated");
+	//   C6_LOG_TO(rendererLog, C6Logger::LogLevel::warning, "Renderer", "frame dropped");
+	//
+	// The messenger must be a string literal (or another constant); "" means none.
+
+	struct LogSite {
+		const char* file;
+		int line;
+		const char* function;
+		LogLevel level;
+		const char* text;        // the message argument as written in the source
+		const char* messenger;
+	};
+
+	class LogSiteHandle {
+	public:
+		explicit LogSiteHandle(const LogSite& site);   // registers the site
+		~LogSiteHandle();
+
+		LogSiteHandle(const LogSiteHandle&) = delete;
+		LogSiteHandle& operator=(const LogSiteHandle&) = delete;
+
+		bool Enabled() const { return enabled.load(std::memory_order_relaxed); }
+		void CountHit() { hits.fetch_add(1, std::memory_order_relaxed); }
+
+		const LogSite& Site() const { return site; }
+		std::uint32_t Id() const { return id; }
+		const Messenger& GetMessenger() const { return messenger; }
+		std::string_view Location() const { return std::string_view(location, locationLength); }
+
+		static constexpr std::size_t MAX_LOCATION = 64;
+
+	private:
+		friend class LogSiteRegistry;
+
+		const LogSite& site;
+		std::uint32_t id = 0;
+		std::atomic<bool> enabled{ true };
+		std::atomic<std::uint64_t> hits{ 0 };
+		Messenger messenger;
+		char location[MAX_LOCATION];   // file name without directories, ':', line
+		std::size_t locationLength = 0;
+	};
+
+	struct LogSiteInfo {
+		std::uint32_t id = 0;
+		LogSite site{};
+		bool enabled = true;
+		std::uint64_t hits = 0;   // lines logged from the site
+	};
+
+	// Every site registered so far, in registration order
+	std::vector<LogSiteInfo> GetLogSites();
+
+	// Returns false if no site has this id
+	bool SetLogSiteEnabled(std::uint32_t id, bool enabled);
+
+	// 'location' is "file" or "file:line", matched against the end of the site's path
+	// ("render.cpp" matches "src/gfx/render.cpp"). The rule is kept and also applies to
+	// sites registered later; returns how many registered sites it matched.
+	std::size_t SetLogSitesEnabled(std::string_view location, bool enabled);
+
+	void ResetLogSiteHits();
+}
+
+// Logs through 'logger' (a C6Logger::Logger) from a registered call site
+#define C6_LOG_TO(logger, level, messenger, message) \
+	do { \
+		static constexpr ::C6Logger::LogSite c6LogSite{ __FILE__, __LINE__, __func__, (level), #message, (messenger) }; \
+		static ::C6Logger::LogSiteHandle c6LogSiteHandle(c6LogSite); \
+		::C6Logger::Logger& c6Logger = (logger); \
+		if (c6LogSiteHandle.Enabled() && c6Logger.ShouldLog(level)) c6Logger.Log(c6LogSiteHandle, (message)); \
+	} while (0)
+
+#define C6_LOG(level, messenger, message) C6_LOG_TO(::C6Logger::Logger::Default(), level, messenger, message)
+
+#define C6_TRACE(messenger, message) C6_LOG(::C6Logger::LogLevel::trace, messenger, message)
+#define C6_DEBUG(messenger, message) C6_LOG(::C6Logger::LogLevel::debug, messenger, message)
+#define C6_INFO(messenger, message) C6_LOG(::C6Logger::LogLevel::info, messenger, message)
+#define C6_WARNING(messenger, message) C6_LOG(::C6Logger::LogLevel::warning, messenger, message)
+#define C6_ERROR(messenger, message) C6_LOG(::C6Logger::LogLevel::error, messenger, message)
+#define C6_CRITICAL(messenger, message) C6_LOG(::C6Logger::LogLevel::critical, messenger, message)
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Logger.h"
+
+namespace C6Logger {
+	// Forwards lines to the host's log daemon over its local Unix datagram socket,
+	// either in the journald native protocol or as RFC 5424 syslog messages.
+	//
+	// Write() only formats the datagram into a pending buffer; a sender thread hands
+	// batches of up to batchRecords datagrams to the kernel with one sendmmsg() call.
+	// The level becomes the syslog priority and the messenger the identifier, so
+	// "journalctl -t Renderer -p warning" filters without parsing message text.
+	// Unix only (sendmmsg on Linux, one sendmsg per datagram elsewhere).
+
+	enum class SystemLogFormat {
+		Journald,   // native protocol: MESSAGE=, PRIORITY=, SYSLOG_IDENTIFIER=, ...
+		Syslog      // "<PRI>1 TIMESTAMP HOSTNAME APP-NAME PROCID MSGID - MSG"
+	};
+
+	// What happens when the daemon falls behind and the socket buffer is full
+	enum class SinkOverflow {
+		// The sender waits for the socket; once maxPendingBytes are queued, Write()
+		// (and so Log()) waits for the sender
+		Block,
+		// Datagrams the socket refuses, and writes that find the queue full, are
+		// dropped and counted
+		Drop
+	};
+
+	struct SystemSinkConfig {
+		SystemLogFormat format = SystemLogFormat::Journald;
+		// Empty: /run/systemd/journal/socket (Journald) or /dev/log (Syslog)
+		std::string socketPath;
+		// Identifier for lines without a messenger (APP-NAME for syslog). Empty: the
+		// program name. With messengerAsIdentifier == false it is used for every line
+		// and the messenger goes to C6_MESSENGER= (journald) or MSGID (syslog).
+		std::string identifier;
+		bool messengerAsIdentifier = true;
+		int facility = 1;                        // LOG_USER
+		SinkOverflow overflow = SinkOverflow::Block;
+		std::size_t batchRecords = 64;           // datagrams per sendmmsg(), at most 1024
+		int flushIntervalMs = 10;                // longest a record waits for a full batch
+		std::size_t maxPendingBytes = 4 << 20;
+		std::size_t maxMessageBytes = 48 << 10;  // longer messages are truncated
+	};
+
+	struct SystemSinkStats {
+		std::uint64_t sent = 0;       // datagrams accepted by the socket
+		std::uint64_t dropped = 0;    // Drop policy, or the daemon was unreachable
+		std::uint64_t sendCalls = 0;  // sendmmsg/sendmsg system calls
+	};
+
+	class SystemLogSink : public LogSink {
+	public:
+		explicit SystemLogSink(SystemSinkConfig config = SystemSinkConfig());
+		~SystemLogSink() override;   // sends everything still queued
+
+		SystemLogSink(const SystemLogSink&) = delete;
+		SystemLogSink& operator=(const SystemLogSink&) = delete;
+
+		bool IsOpen() const;
+
+		void Write(LogLevel level, std::string_view line, std::size_t headerLength) override;
+		void WriteRecord(const LogRecordView& record) override;
+		void Flush() override;   // returns once everything written so far was handed to the socket
+
+		SystemSinkStats Stats() const;
+
+	private:
+		class State;
+		std::unique_ptr<State> state;
+	};
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Logger.h"
+
+namespace C6Logger {
+	// Resume position inside a followed log. Treat as opaque: persist it with
+	// Serialize() and hand it back to LogTail to continue without rescanning.
+	class TailCursor {
+	public:
+		std::string Serialize() const;
+		static bool Deserialize(const std::string& text, TailCursor& out);
+
+	private:
+		friend class LogTail;
+		std::uint64_t device = 0;
+		std::uint64_t inode = 0;
+		std::uint64_t offset = 0;       // first byte not yet delivered
+		std::uint64_t lastLineHash = 0; // hash of the last delivered line (repeat suffix stripped)
+		std::uint32_t lastLineLength = 0;
+		std::uint64_t lastStamp = 0;    // YYYYMMDDhhmmss of the last delivered line, 0 if unknown
+	};
+
+	// A group of complete lines. The views point into the tail's read buffer and
+	// stay valid until the next call into the LogTail that produced them.
+	struct TailBatch {
+		const std::string_view* lines = nullptr;
+		std::size_t count = 0;
+		// Set when the file was truncated or rewritten by compaction and delivery had
+		// to resynchronize. Lines from the same second as the cursor may repeat.
+		bool resynced = false;
+
+		const std::string_view* begin() const { return lines; }
+		const std::string_view* end() const { return lines + count; }
+	};
+
+	// Follows a log file written by Log() (or any line-oriented file). Handles
+	// truncation, rotation (rename + recreate) and in-place compaction rewrites.
+	// Uses inotify where available and falls back to polling the file's size and
+	// modification time elsewhere. Without POSIX file identities (Windows) a
+	// rotated file is recognized by the cursor no longer matching its contents.
+	class LogTail {
+	public:
+		explicit LogTail(std::string path = GetLogPath());
+		LogTail(std::string path, const TailCursor& resumeFrom);
+		~LogTail();
+
+		LogTail(const LogTail&) = delete;
+		LogTail& operator=(const LogTail&) = delete;
+
+		// Iterator style: fills the next batch of new lines, returns false when caught up.
+		bool Next(TailBatch& batch);
+
+		// Delivers everything currently available, returns the number of lines delivered.
+		std::size_t Poll(const std::function<void(const TailBatch&)>& onBatch);
+
+		// Blocks until the file may have changed or the timeout expires.
+		bool Wait(int timeoutMs);
+
+		// Poll + Wait loop until stop becomes true.
+		void Follow(const std::function<void(const TailBatch&)>& onBatch, const std::atomic<bool>& stop, int pollIntervalMs = 250);
+
+		TailCursor Cursor() const { return cursor; }
+		const std::string& Path() const { return path; }
+		bool UsingInotify() const { return inotifyFd >= 0; }
+
+		// Read granularity; also the upper bound for lines delivered in one batch.
+		static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+
+	private:
+		bool OpenFile();
+		void CloseFile();
+		bool IsOpen() const;
+		std::int64_t ReadAt(std::uint64_t offset, char* data, std::size_t size);   // bytes read, -1 on error
+		bool OpenSize(std::uint64_t& size);
+		bool CheckRotation();
+		bool VerifyCursor();
+		void Resync();
+		bool FillBatch(TailBatch& batch);
+
+		std::string path;
+		std::string fileName;
+		TailCursor cursor;
+		int fd = -1;
+		std::unique_ptr<std::ifstream> stream;   // instead of fd where there is no POSIX I/O
+		int inotifyFd = -1;
+		int watchFd = -1;
+		bool pendingResync = false;
+		std::vector<char> buffer;
+		std::vector<std::string_view> views;
+		// Polling fallback: last observed state of the path
+		std::uint64_t seenInode = 0;
+		std::uint64_t seenSize = 0;
+		std::int64_t seenMtimeNs = 0;
+		// Zero-filled gap at the cursor and when it was first seen
+		std::uint64_t holeOffset = ~std::uint64_t(0);
+		std::int64_t holeSinceNs = 0;
+	};
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Logger.h"
+
+namespace C6Logger {
+	// Scoped tracing spans exported as Chrome/Perfetto trace-event JSON.
+	//
+	// A span records its begin/end stamps from the active clock source (see
+	// LogClock.h) into a buffer owned by the calling thread, so recording takes no
+	// lock. Names, messengers and argument keys are stored as pointers and must
+	// outlive the capture; string literals are the intended use. The buffer of an
+	// exited thread is kept for export until the next StartTracing() frees it, or a
+	// new thread reuses it once its spans belong to no capture.
+
+	void StartTracing();   // discards previously recorded spans and starts recording
+	void StopTracing();
+	bool IsTracing();
+
+	// When enabled, every finished span is also written through Log() at the given
+	// level as "span <name> took <us> us", so it reaches the normal sinks.
+	void SetTraceLogging(bool enabled, LogLevel level = LogLevel::trace);
+
+	// Names the calling thread in exported traces
+	void SetTraceThreadName(const char* name);
+
+	// Writes every span recorded since StartTracing() as trace-event JSON.
+	// The default path is "trace.json" next to the log file.
+	bool WriteChromeTrace(const std::string& path = std::string());
+
+	// Spans dropped because a thread's buffer was full
+	std::uint64_t DroppedTraceSpans();
+
+	class TraceSpan {
+	public:
+		explicit TraceSpan(const char* name, const char* messenger = nullptr);
+		~TraceSpan();
+
+		TraceSpan(const TraceSpan&) = delete;
+		TraceSpan& operator=(const TraceSpan&) = delete;
+
+		// Up to two numeric arguments, shown under "args" in the trace viewer
+		TraceSpan& Arg(const char* key, std::int64_t value);
+
+		static constexpr int MAX_ARGS = 2;
+
+	private:
+		std::uint64_t begin;
+		const char* name;
+		const char* messenger;
+		const char* argKeys[MAX_ARGS];
+		std::int64_t argValues[MAX_ARGS];
+		int argCount = 0;
+	};
+}
+
+#define C6_TRACE_CONCAT_INNER(a, b) a##b
+#define C6_TRACE_CONCAT(a, b) C6_TRACE_CONCAT_INNER(a, b)
+// Traces the enclosing scope: C6_TRACE_SCOPE("UpdatePhysics") or C6_TRACE_SCOPE("Upload", "Renderer")
+#define C6_TRACE_SCOPE(...) ::C6Logger::TraceSpan C6_TRACE_CONCAT(c6TraceSpan_, __LINE__)(__VA_ARGS__)
@@ -7,6 +7,15 @@
 #include <chrono>
 #include <iomanip>
 #include <sstream>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace C6Logger {
 	enum class LogLevel {
@@ -19,4 +28,325 @@ namespace C6Logger {
 	};
 
 	void Log(LogLevel level, const std::string& message, const std::string& messenger);
+	void Log(LogLevel level, const std::string& message);
+
+	// Overloads for literals and views: no std::string temporaries, and the line is
+	// built in a reused per-thread buffer. With FileMode::AtomicAppend or a shared
+	// ring the steady-state call performs no heap allocation (compacting mode still
+	// allocates while it rewrites the file).
+	void Log(LogLevel level, std::string_view message, std::string_view messenger);
+	void Log(LogLevel level, std::string_view message);
+	void Log(LogLevel level, const char* message, const char* messenger);
+	void Log(LogLevel level, const char* message);
+
+	class Messenger;
+	// Interned messenger (LogMessenger.h): no string handling per call, and lines
+	// below the messenger's level are dropped before formatting
+	void Log(LogLevel level, std::string_view message, const Messenger& messenger);
+
+	// How Log() writes the log file
+	enum class FileMode {
+		// Append, then deduplicate and trim the whole file on every call (default)
+		Compacting,
+		// Each record goes out with exactly one write() on an O_APPEND descriptor, so
+		// threads and processes never interleave lines and the log lock is not held
+		// for file I/O. Records longer than ATOMIC_RECORD_LIMIT are split into
+		// fragment lines "<header>[part k/n <id>] <chunk>". Compaction only runs
+		// through CompactLogFile().
+		AtomicAppend
+	};
+
+	static constexpr std::size_t ATOMIC_RECORD_LIMIT = 4096; // PIPE_BUF on Linux
+
+	void SetFileMode(FileMode mode);
+	FileMode GetFileMode();
+
+	// Line layout of the default logger, e.g. "%t %l [%n] %v" (see LogLayout.h).
+	// Returns false and leaves the layout unchanged if the pattern is invalid.
+	bool SetLogLayout(std::string_view pattern);
+	std::string GetLogLayout();
+
+	// Preallocation of the log file in FileMode::AtomicAppend (Linux only; other
+	// platforms report None). Space is reserved with fallocate() one extent ahead of
+	// the writes, so appends stop allocating blocks one at a time.
+	enum class Preallocation {
+		None,
+		// Reserve blocks past EOF (FALLOC_FL_KEEP_SIZE); the file size still grows with
+		// each write, so readers see nothing unusual
+		KeepSize,
+		// Grow the file by whole extents as well. The logical end is tracked in
+		// "<log>.lock" and writers pwrite() at reserved offsets; the file ends in zero
+		// bytes until the last process writing it exits normally and trims it.
+		ExplicitSize
+	};
+
+	struct PreallocationPolicy {
+		Preallocation mode = Preallocation::None;
+		std::size_t extentBytes = std::size_t(8) << 20; // at least 64 KiB
+	};
+
+	// Takes effect when the log file is next opened; call it before logging starts.
+	// All processes sharing a log must use the same mode.
+	void SetPreallocation(const PreallocationPolicy& policy);
+	PreallocationPolicy GetPreallocation();
+
+	// Deduplicates and trims the log file once. Compactors in different processes
+	// are serialized through "<log>.lock", and AtomicAppend writers switch to the
+	// rewritten file without losing records.
+	bool CompactLogFile();
+
+	// When the log file is flushed to stable storage with fdatasync
+	enum class DurabilityMode {
+		None,         // leave it to the OS (default)
+		Periodic,     // a background thread syncs every intervalMs if anything was written
+		EveryNBytes,  // a background sync starts once byteThreshold bytes are pending
+		SyncOnError   // error/critical calls return only after their line is synced
+	};
+
+	// SyncOnError waiters are group-committed: one fdatasync covers every caller that
+	// was waiting when it started. On a sharded logger an error/critical call waits for
+	// the merger to write and sync its line, along with everything merged before it. Records a shared ring (LogSharedRing.h) carries are
+	// synced by the collector's own policy; producers never wait for a sync.
+	struct DurabilityPolicy {
+		DurabilityMode mode = DurabilityMode::None;
+		int intervalMs = 1000;                  // Periodic
+		std::size_t byteThreshold = 1 << 20;    // EveryNBytes
+	};
+
+	void SetDurabilityPolicy(const DurabilityPolicy& policy);
+	DurabilityPolicy GetDurabilityPolicy();
+
+	static constexpr std::size_t LOCK_TIME_BUCKETS = 40;
+
+	// Durations recorded while lock profiling is on
+	struct LockTimes {
+		std::uint64_t count = 0;
+		std::uint64_t totalNs = 0;
+		std::uint64_t maxNs = 0;
+		std::uint64_t buckets[LOCK_TIME_BUCKETS] = {};   // bucket i: [2^i, 2^(i+1)) ns; 0 ns counts in bucket 0
+	};
+
+	// Runtime counters and measurements
+	struct LoggerStats {
+		// Timestamp source in effect (see LogClock.h) and the measured cost of one capture
+		const char* clockSource = "";
+		double clockCallNs = 0.0;
+		double tscGhz = 0.0;                 // TSC source only
+		std::uint64_t tscRecalibrations = 0; // TSC source only
+
+		// Durability: fdatasync calls, their latency, and SyncOnError group commit
+		std::uint64_t syncCount = 0;
+		std::uint64_t syncTotalNs = 0;
+		std::uint64_t syncMaxNs = 0;
+		std::uint64_t syncWaiters = 0;       // calls that waited for a sync
+		std::uint64_t syncMaxGroup = 0;      // most waiters covered by one sync
+
+		// Extents reserved with fallocate() (see Preallocation)
+		std::uint64_t preallocations = 0;
+
+		// Sharded loggers: calls that found their shard full and waited (Log) or dropped the line (TryLog)
+		std::uint64_t shardStalls = 0;
+
+		// The logger's lock on the logging paths (SetLockProfiling): time spent waiting
+		// for it, time it was held, and the part of that spent compacting the file
+		LockTimes lockWait;
+		LockTimes lockHold;
+		LockTimes compaction;
+	};
+
+	LoggerStats GetStats();
+
+	// Process-wide, off by default. While on, every logger times acquisitions of its
+	// lock on the logging paths, at the cost of about three clock reads per call.
+	void SetLockProfiling(bool enabled);
+
+	// Path of the log file written by Log()
+	std::string GetLogPath();
+
+	// Renames the active log to a timestamped segment and compresses it to ".c6z"
+	// on a background thread. Returns the sealed path, or an empty string if the log was empty.
+	std::string SealLogSegment();
+
+	// One line with its fields, as handed to LogSink::WriteRecord()
+	struct LogRecordView {
+		std::int64_t wallNs = 0;          // timestamp, ns since the Unix epoch
+		LogLevel level = LogLevel::info;
+		std::string_view messenger;       // empty if none
+		std::string_view message;
+		std::string_view line;            // formatted, without a trailing newline
+		std::size_t headerLength = 0;     // the message starts here in 'line'
+	};
+
+	// Additional destination for formatted lines, attached with Logger::AddSink().
+	// Write() is called under the owning logger's lock, in call order, so a sink needs
+	// no locking of its own; it must not log through the same logger.
+	class LogSink {
+	public:
+		virtual ~LogSink() = default;
+		// 'line' has no trailing newline; the message starts after its first
+		// headerLength bytes, "[timestamp] [messenger] [LEVEL] " in the default layout
+		virtual void Write(LogLevel level, std::string_view line, std::size_t headerLength) = 0;
+		// What loggers call. Sinks that store fields rather than text (an exact
+		// timestamp, the messenger) override this; the default forwards to Write().
+		virtual void WriteRecord(const LogRecordView& record) {
+			Write(record.level, record.line, record.headerLength);
+		}
+		virtual void Flush() {}
+	};
+
+	struct LoggerConfig {
+		// Log file. Empty means the default log path (GetLogPath()); a relative path is
+		// placed in the default log's directory, so "renderer.txt" sits next to log.txt.
+		std::string path;
+		std::size_t maxLines = 1000;   // line limit kept by compaction
+		FileMode fileMode = FileMode::Compacting;
+		std::string layout;            // line layout (LogLayout.h); empty = DEFAULT_LOG_LAYOUT
+		bool console = true;           // echo lines to stdout/stderr
+		bool fileOutput = true;        // false: console and sinks only
+		// Sharded mode (> 0): Log() appends to one of 'shards' per-CPU buffers and
+		// returns; a merger thread emits the lines in timestamp order to the console,
+		// sinks and file every mergeIntervalMs. One shard per core removes the logger
+		// lock from the calling threads.
+		std::size_t shards = 0;
+		int mergeIntervalMs = 5;
+	};
+
+	namespace detail {
+		struct LoggerState;
+
+		// Per-thread buffer for a lazily built message. It keeps its capacity between
+		// calls, and a message built while another is being built gets its own.
+		class LazyMessage {
+		public:
+			LazyMessage();
+			~LazyMessage();
+			LazyMessage(const LazyMessage&) = delete;
+			LazyMessage& operator=(const LazyMessage&) = delete;
+			std::string& Text() { return *text; }
+		private:
+			std::string* text;
+		};
+
+		// Move-only holder for the callable of Logger::LogDeferred()
+		class MessageProducer {
+		public:
+			template<class Produce>
+			explicit MessageProducer(Produce&& produce)
+				: impl(std::make_unique<Model<std::decay_t<Produce>>>(std::forward<Produce>(produce))) {}
+			void operator()(std::string& out) { impl->Run(out); }
+
+		private:
+			struct Concept {
+				virtual ~Concept() = default;
+				virtual void Run(std::string& out) = 0;
+			};
+			template<class Produce>
+			struct Model : Concept {
+				template<class P> explicit Model(P&& p) : produce(std::forward<P>(p)) {}
+				void Run(std::string& out) override { produce(out); }
+				Produce produce;
+			};
+			std::unique_ptr<Concept> impl;
+		};
+	}
+	class LogSiteHandle;
+	class LogBatch;
+
+	// A logger with its own file, configuration, sinks and lock. Loggers writing
+	// different files never contend with each other; the free functions above act on
+	// Logger::Default(). Console output is serialized process-wide.
+	class Logger {
+	public:
+		explicit Logger(LoggerConfig config = LoggerConfig());
+		~Logger();
+
+		Logger(const Logger&) = delete;
+		Logger& operator=(const Logger&) = delete;
+
+		// The instance behind the free functions. It is never destroyed, so logging
+		// from static destructors stays safe. Only this instance feeds a shared ring.
+		static Logger& Default();
+
+		void Log(LogLevel level, std::string_view message, std::string_view messenger = std::string_view());
+		void Log(LogLevel level, std::string_view message, const Messenger& messenger);
+		// Sharded loggers: drops the line and returns false instead of waiting when the
+		// caller's shard is full (4 MiB not yet merged). Unsharded loggers just Log().
+		bool TryLog(LogLevel level, std::string_view message, std::string_view messenger = std::string_view());
+		// Every line of 'batch' as one unit (LogBatch.h); LogBatch::Commit() calls this
+		void Log(const LogBatch& batch);
+		// Used by the C6_LOG macros (LogSite.h): level and messenger come from the site,
+		// which also counts the call
+		void Log(LogSiteHandle& site, std::string_view message);
+
+		// Lazy messages: 'produce' is called as produce(std::string& out) to append the
+		// message, and only once the line passes the level checks; a filtered call
+		// costs what ShouldLog() does. The Messenger overload is in LogMessenger.h.
+		template<class Produce>
+		void LogLazy(LogLevel level, Produce&& produce, std::string_view messenger = std::string_view()) {
+			if (!ShouldLog(level)) return;
+			detail::LazyMessage message;
+			produce(message.Text());
+			Log(level, message.Text(), messenger);
+		}
+		template<class Produce>
+		void LogLazy(LogLevel level, Produce&& produce, const Messenger& messenger);
+
+		// As LogLazy, but a sharded logger keeps the callable and runs it on the merger
+		// thread, so the caller only pays for the shard append. It is moved there: its
+		// captures must own what they refer to, and it must not throw. The line keeps
+		// the timestamp of this call. Unsharded loggers run it right away.
+		template<class Produce>
+		void LogDeferred(LogLevel level, Produce&& produce, std::string_view messenger = std::string_view()) {
+			if (!ShouldLog(level)) return;
+			LogDeferredProducer(level, detail::MessageProducer(std::forward<Produce>(produce)), messenger);
+		}
+
+		// Lines below 'level' are dropped by every Log variant before they are formatted
+		void SetLevel(LogLevel level) { minLevel.store(static_cast<int>(level), std::memory_order_relaxed); }
+		LogLevel GetLevel() const { return static_cast<LogLevel>(minLevel.load(std::memory_order_relaxed)); }
+		bool ShouldLog(LogLevel level) const { return static_cast<int>(level) >= minLevel.load(std::memory_order_relaxed); }
+
+		void SetFileMode(FileMode mode);
+		FileMode GetFileMode() const;
+		// Safe while other threads log; lines already formatted keep their layout
+		bool SetLayout(std::string_view pattern);
+		std::string GetLayout() const;
+
+		void SetDurabilityPolicy(const DurabilityPolicy& policy);
+		DurabilityPolicy GetDurabilityPolicy() const;
+
+		void AddSink(std::shared_ptr<LogSink> sink);
+		void RemoveSink(const std::shared_ptr<LogSink>& sink);
+		void Flush();   // merges pending shards, then flushes the console and every sink
+
+		// Non-blocking variants for event loops and coroutines (see LogAsync.h). 'done'
+		// runs once everything logged before the call was delivered (FlushAsync) and
+		// also fdatasync'ed (SyncAsync): on the merger or sync thread, or before
+		// FlushAsync returns when the logger is not sharded. Pending callbacks still
+		// run when the logger is destroyed.
+		void FlushAsync(std::function<void()> done);
+		void SyncAsync(std::function<void()> done);
+
+		bool CompactLogFile();
+		std::string SealLogSegment();
+
+		const std::string& GetLogPath() const;
+		LoggerStats GetStats() const;
+
+	private:
+		void LogDeferredProducer(LogLevel level, detail::MessageProducer produce, std::string_view messenger);
+
+		std::unique_ptr<detail::LoggerState> state;
+		std::atomic<int> minLevel{ 0 };
+	};
+
+	// Minimum level of the default logger (Logger::SetLevel)
+	void SetLogLevel(LogLevel level);
+	LogLevel GetLogLevel();
+
+	// Logger::LogLazy on the default logger
+	template<class Produce>
+	void LogLazy(LogLevel level, Produce&& produce, std::string_view messenger = std::string_view()) {
+		Logger::Default().LogLazy(level, std::forward<Produce>(produce), messenger);
+	}
 }
\ No newline at end of file
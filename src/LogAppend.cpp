@@ -0,0 +1,840 @@
+#include "../include/Logger.h"
+#include "LogInternal.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define C6_APPEND_POSIX 1
+#endif
+#if defined(__linux__)
+#include <linux/falloc.h>
+#define C6_HAVE_FALLOCATE 1
+#endif
+#if defined(C6_APPEND_POSIX)
+#include <pthread.h>
+#include <signal.h>
+#if defined(F_OFD_SETLK)
+#define C6_HAVE_OFD_LOCKS 1
+#endif
+#endif
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace C6Logger {
+
+    static std::atomic<Preallocation> preallocMode{ Preallocation::None };
+    static std::atomic<std::size_t> preallocExtent{ std::size_t(8) << 20 };
+    static std::atomic<std::uint64_t> preallocCount{ 0 };
+    // Set once the exit hook trimmed every appender; lines logged later are not preallocated
+    static std::atomic<bool> preallocClosed{ false };
+
+#if defined(C6_APPEND_POSIX)
+
+    // "<log>.lock" coordinates compaction with appenders. Its first 8 bytes are a
+    // generation counter, bumped whenever CompactLogFile() swaps in a rewritten file;
+    // appenders compare it before each write and reopen the path when it moved.
+    // The next 8 bytes hold the logical end for Preallocation::ExplicitSize, tagged
+    // with the generation it belongs to (0 = unknown, rescan the file).
+    //
+    // From byte 64 on come the in-flight slots, one per appending process. A writer
+    // counts itself in its slot under the parity of the generation it checked, from
+    // before that check until its write() returned. Whoever bumps the generation then
+    // waits for the old parity's counts to drain (WaitForInFlight), so once it returns
+    // no record is still headed for the file it swapped out.
+    struct AppendSlot {
+        std::atomic<std::uint64_t> owner;        // claiming pid, where OFD locks are unavailable
+        std::atomic<std::uint64_t> inFlight[2];
+        char padding[40];
+    };
+
+    struct LockFile {
+        int fd = -1;
+        std::atomic<std::uint64_t>* generation = nullptr;
+        std::atomic<std::uint64_t>* logicalEnd = nullptr;
+        AppendSlot* slots = nullptr;
+    };
+
+    static constexpr std::size_t SLOT_BASE = 64;
+    static constexpr std::size_t SLOT_COUNT = (4096 - 2 * SLOT_BASE) / sizeof(AppendSlot);
+    // Without OFD locks the last slot is shared by every process that found no free one
+    static constexpr std::uint64_t SHARED_SLOT_OWNER = ~std::uint64_t(0);
+    // Processes without a slot hold a shared OFD lock on this byte across each write
+    static constexpr off_t OVERFLOW_BYTE = 4094;
+    static_assert(sizeof(AppendSlot) == 64, "one slot per cache line");
+
+    static constexpr std::uint64_t END_MASK = (std::uint64_t(1) << 48) - 1;
+
+    static std::uint64_t EndTag(std::uint64_t generation) {
+        return ((generation & 0x7FFF) | 0x8000) << 48;
+    }
+
+    static bool OpenLockFile(const std::string& logPath, LockFile& lockFile) {
+        std::string path = logPath + ".lock";
+        int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (st.st_size < 4096 && ftruncate(fd, 4096) != 0)) {
+            close(fd);
+            return false;
+        }
+        void* base = mmap(nullptr, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        lockFile.fd = fd;
+        lockFile.generation = static_cast<std::atomic<std::uint64_t>*>(base);
+        lockFile.logicalEnd = lockFile.generation + 1;
+        lockFile.slots = reinterpret_cast<AppendSlot*>(static_cast<char*>(base) + SLOT_BASE);
+        return true;
+    }
+
+    static void CloseLockFile(LockFile& lockFile) {
+        if (lockFile.generation) munmap(lockFile.generation, 4096);
+        if (lockFile.fd >= 0) close(lockFile.fd);
+        lockFile = LockFile();
+    }
+
+    // Process-wide appender for one log path, shared by all threads and by every Logger
+    // writing that path. The descriptor number stays stable: reopening dup2()s the new
+    // file over it, so concurrent writers never see a closed fd.
+    struct detail::Appender {
+        std::mutex reopenMutex;
+        std::string path;
+        LockFile lockFile;
+        std::atomic<int> fd{ -1 };
+        std::atomic<std::uint64_t> openedGeneration{ 0 };
+        // Preallocation the descriptor was opened for; ExplicitSize needs it without O_APPEND
+        std::atomic<Preallocation> openedMode{ Preallocation::None };
+        bool sharedLocked = false;
+
+        std::mutex preallocMutex;
+        std::uint64_t allocatedEnd = 0;   // end of the last reserved extent in the open file
+        std::atomic<std::uint64_t> bytesSinceCheck{ 0 };
+        bool preallocFailed = false;
+        // ExplicitSize writers between reserving a range in the open file and writing it
+        std::atomic<int> rangeWriters{ 0 };
+
+        // This process's in-flight slot, claimed on the first write after each fork.
+        // Null when every slot was taken: writes then go through overflowMutex.
+        AppendSlot* slot = nullptr;
+        std::atomic<std::uint64_t> slotEpoch{ 0 };
+        std::mutex overflowMutex;
+
+        detail::PathFile pathFile;
+    };
+
+
+#if defined(C6_HAVE_OFD_LOCKS)
+
+    static bool LockByte(int lockFd, short type, off_t offset, bool wait) {
+        struct flock fl = {};
+        fl.l_type = type;
+        fl.l_whence = SEEK_SET;
+        fl.l_start = offset;
+        fl.l_len = 1;
+        while (fcntl(lockFd, wait ? F_OFD_SETLKW : F_OFD_SETLK, &fl) != 0) {
+            if (errno != EINTR) return false;
+        }
+        return true;
+    }
+
+#endif
+
+#if defined(C6_HAVE_FALLOCATE)
+
+    // Every appender holds a shared OFD lock on a byte of the lock file for as long as its
+    // descriptor is open. Trimming preallocated space needs the exclusive lock, so it only
+    // happens when no appender in any process could be writing behind the trimmed end.
+    static bool LockAppenderByte(int lockFd, short type, bool wait) {
+        return LockByte(lockFd, type, 4095, wait);
+    }
+
+    // Logical end of a file whose tail may be zero-filled preallocation: the byte after
+    // the last non-NUL one.
+    static std::uint64_t ScanLogicalEnd(int fd) {
+        struct stat st;
+        if (fstat(fd, &st) != 0) return 0;
+        std::uint64_t end = static_cast<std::uint64_t>(st.st_size);
+        char buf[64 * 1024];
+        while (end > 0) {
+            std::uint64_t chunk = end < sizeof(buf) ? end : sizeof(buf);
+            ssize_t n = pread(fd, buf, static_cast<std::size_t>(chunk), static_cast<off_t>(end - chunk));
+            if (n != static_cast<ssize_t>(chunk)) return end;
+            for (std::size_t i = static_cast<std::size_t>(chunk); i > 0; --i) {
+                if (buf[i - 1] != '\0') return end - chunk + i;
+            }
+            end -= chunk;
+        }
+        return 0;
+    }
+
+    // Releases preallocated space past the logical end when this is the last appender.
+    // 'generation' is the one the descriptor was opened for.
+    static void TrimPreallocation(detail::Appender& a, std::uint64_t generation) {
+        int fd = a.fd.load(std::memory_order_relaxed);
+        if (fd < 0 || !a.lockFile.generation || !a.sharedLocked) return;
+        LockAppenderByte(a.lockFile.fd, F_UNLCK, false);
+        a.sharedLocked = false;
+        if (!LockAppenderByte(a.lockFile.fd, F_WRLCK, false)) return;
+        struct stat st;
+        if (a.openedMode.load(std::memory_order_relaxed) == Preallocation::ExplicitSize) {
+            std::uint64_t word = a.lockFile.logicalEnd->exchange(0, std::memory_order_acq_rel);
+            std::uint64_t end = (word >> 48) == (EndTag(generation) >> 48)
+                ? (word & END_MASK) : ScanLogicalEnd(fd);
+            if (ftruncate(fd, static_cast<off_t>(end)) != 0) {
+                std::cerr << RED << "[ERROR] Failed to trim preallocated log file '" << a.path << "'." << RESET << std::endl;
+            }
+        }
+        else if (fstat(fd, &st) == 0 && static_cast<std::uint64_t>(st.st_blocks) * 512 > static_cast<std::uint64_t>(st.st_size)) {
+            // Truncating to the current size drops blocks reserved with FALLOC_FL_KEEP_SIZE
+            if (ftruncate(fd, st.st_size) != 0) {
+                std::cerr << RED << "[ERROR] Failed to trim preallocated log file '" << a.path << "'." << RESET << std::endl;
+            }
+        }
+        LockAppenderByte(a.lockFile.fd, F_UNLCK, false);
+        std::lock_guard<std::mutex> lock(a.preallocMutex);
+        a.allocatedEnd = 0;
+    }
+
+    // Reserves the next extent once writes come within half an extent of the reserved end.
+    // KeepSize leaves st_size alone so O_APPEND keeps working; ExplicitSize grows the file
+    // and relies on the logical end in the lock file.
+    static void EnsurePreallocated(detail::Appender& a, int fd, Preallocation mode, std::uint64_t writeEnd) {
+        std::uint64_t extent = preallocExtent.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(a.preallocMutex);
+        if (a.preallocFailed || writeEnd + extent / 2 <= a.allocatedEnd) return;
+        if (preallocClosed.load(std::memory_order_relaxed)) return;
+        std::uint64_t start = writeEnd > a.allocatedEnd ? writeEnd : a.allocatedEnd;
+        int flags = mode == Preallocation::KeepSize ? FALLOC_FL_KEEP_SIZE : 0;
+        if (fallocate(fd, flags, static_cast<off_t>(start), static_cast<off_t>(extent)) != 0) {
+            // Unsupported filesystem or out of space: plain appends still work
+            a.preallocFailed = true;
+            std::cerr << RED << "[ERROR] fallocate failed on log file '" << a.path << "': " << std::strerror(errno)
+                << "; continuing without preallocation." << RESET << std::endl;
+            return;
+        }
+        a.allocatedEnd = start + extent;
+        preallocCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+#endif // C6_HAVE_FALLOCATE
+
+    // Bumped in the child after fork(): a slot claimed by the parent is not the child's
+    static std::atomic<std::uint64_t> forkEpoch{ 1 };
+
+    static void RegisterForkHandler() {
+        static bool registered = [] {
+            return pthread_atfork(nullptr, nullptr, [] { forkEpoch.fetch_add(1, std::memory_order_relaxed); }) == 0;
+        }();
+        (void)registered;
+    }
+
+    static off_t SlotByte(std::size_t index) {
+        return static_cast<off_t>(SLOT_BASE + index * sizeof(AppendSlot));
+    }
+
+    // Finds a slot nobody owns and takes it. With OFD locks a slot is owned through an
+    // exclusive lock on its first byte, released by the kernel when the owner dies;
+    // otherwise through its pid, checked with kill(pid, 0).
+    static AppendSlot* ClaimSlot(LockFile& lockFile) {
+        for (std::size_t i = 0; i < SLOT_COUNT; ++i) {
+            AppendSlot& slot = lockFile.slots[i];
+#if defined(C6_HAVE_OFD_LOCKS)
+            if (!LockByte(lockFile.fd, F_WRLCK, SlotByte(i), false)) continue;
+#else
+            std::uint64_t owner = slot.owner.load(std::memory_order_acquire);
+            bool free = owner == 0 || (owner != SHARED_SLOT_OWNER && kill(static_cast<pid_t>(owner), 0) != 0 && errno == ESRCH);
+            if (i + 1 == SLOT_COUNT) {
+                // Every other slot is taken: share this one, whose owner is then never presumed
+                // dead. Counts of live users stay; they belong to the same waiters.
+                if (!free || !slot.owner.compare_exchange_strong(owner, SHARED_SLOT_OWNER)) {
+                    slot.owner.store(SHARED_SLOT_OWNER, std::memory_order_release);
+                    return &slot;
+                }
+            }
+            else if (!free || !slot.owner.compare_exchange_strong(owner, static_cast<std::uint64_t>(getpid()))) {
+                continue;
+            }
+#endif
+            // Counts a dead owner left behind
+            slot.inFlight[0].store(0, std::memory_order_relaxed);
+            slot.inFlight[1].store(0, std::memory_order_release);
+            return &slot;
+        }
+        return nullptr;
+    }
+
+    static bool SlotOwnerAlive(LockFile& lockFile, std::size_t index) {
+#if defined(C6_HAVE_OFD_LOCKS)
+        struct flock fl = {};
+        fl.l_type = F_WRLCK;
+        fl.l_whence = SEEK_SET;
+        fl.l_start = SlotByte(index);
+        fl.l_len = 1;
+        return fcntl(lockFile.fd, F_OFD_GETLK, &fl) != 0 || fl.l_type != F_UNLCK;
+#else
+        std::uint64_t owner = lockFile.slots[index].owner.load(std::memory_order_acquire);
+        return owner == SHARED_SLOT_OWNER || (owner != 0 && (kill(static_cast<pid_t>(owner), 0) == 0 || errno != ESRCH));
+#endif
+    }
+
+    // Opens the lock file and claims this process's slot, once per fork epoch
+    static bool AttachSlot(detail::Appender& a, std::uint64_t epoch) {
+        std::lock_guard<std::mutex> lock(a.reopenMutex);
+        if (a.slotEpoch.load(std::memory_order_relaxed) == epoch) return true;
+        if (!a.lockFile.generation && !OpenLockFile(a.path, a.lockFile)) return false;
+#if defined(C6_HAVE_OFD_LOCKS)
+        if (a.slotEpoch.load(std::memory_order_relaxed) != 0) {
+            // Forked: the inherited descriptor shares its locks with the parent, so take a
+            // descriptor of our own. dup2() keeps the number other threads may be using.
+            int fresh = open((a.path + ".lock").c_str(), O_RDWR | O_CLOEXEC);
+            if (fresh < 0) return false;
+            dup2(fresh, a.lockFile.fd);
+            close(fresh);
+#if defined(C6_HAVE_FALLOCATE)
+            a.sharedLocked = false;
+            a.openedGeneration.store(~std::uint64_t(0), std::memory_order_relaxed); // retakes it on reopen
+#endif
+        }
+#endif
+        a.slot = ClaimSlot(a.lockFile);
+        a.slotEpoch.store(epoch, std::memory_order_release);
+        return true;
+    }
+
+    // Counts the calling thread as writing to the file of the generation it is about to
+    // check, until destroyed
+    class InFlightWrite {
+    public:
+        explicit InFlightWrite(detail::Appender& a) : a(a) {
+            std::uint64_t epoch = forkEpoch.load(std::memory_order_relaxed);
+            if (a.slotEpoch.load(std::memory_order_acquire) != epoch && !AttachSlot(a, epoch)) return;
+            if (!a.slot) {
+#if defined(C6_HAVE_OFD_LOCKS)
+                // One shared lock per process: threads would release each other's
+                overflowLock = std::unique_lock<std::mutex>(a.overflowMutex);
+                if (!LockByte(a.lockFile.fd, F_RDLCK, OVERFLOW_BYTE, true)) {
+                    overflowLock.unlock();
+                    return;
+                }
+                entered = true;
+#endif
+                return;
+            }
+            // Pairs with the bump-then-load in WaitForInFlight: either this thread sees
+            // the new generation and retries, or the waiter sees the count
+            std::atomic<std::uint64_t>& generation = *a.lockFile.generation;
+            for (;;) {
+                std::uint64_t seen = generation.load(std::memory_order_seq_cst);
+                count = &a.slot->inFlight[seen & 1];
+                count->fetch_add(1, std::memory_order_seq_cst);
+                if (generation.load(std::memory_order_seq_cst) == seen) break;
+                count->fetch_sub(1, std::memory_order_release);
+            }
+            entered = true;
+        }
+
+        ~InFlightWrite() {
+            if (count) count->fetch_sub(1, std::memory_order_release);
+#if defined(C6_HAVE_OFD_LOCKS)
+            else if (entered) LockByte(a.lockFile.fd, F_UNLCK, OVERFLOW_BYTE, false);
+#endif
+        }
+
+        InFlightWrite(const InFlightWrite&) = delete;
+        InFlightWrite& operator=(const InFlightWrite&) = delete;
+
+        explicit operator bool() const { return entered; }
+
+    private:
+        detail::Appender& a;
+        std::atomic<std::uint64_t>* count = nullptr;
+        std::unique_lock<std::mutex> overflowLock;
+        bool entered = false;
+    };
+
+    // Called after bumping the generation from 'generation' (the caller holds the
+    // compaction flock): returns once no appender in any process is still writing
+    // under it. Slots whose owner died are skipped.
+    static void WaitForInFlight(LockFile& lockFile, std::uint64_t generation) {
+        for (std::size_t i = 0; i < SLOT_COUNT; ++i) {
+            std::atomic<std::uint64_t>& count = lockFile.slots[i].inFlight[generation & 1];
+            for (int spins = 0; count.load(std::memory_order_seq_cst) != 0; ++spins) {
+                if (spins < 64) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (!SlotOwnerAlive(lockFile, i)) break;
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+#if defined(C6_HAVE_OFD_LOCKS)
+        if (LockByte(lockFile.fd, F_WRLCK, OVERFLOW_BYTE, true)) LockByte(lockFile.fd, F_UNLCK, OVERFLOW_BYTE, false);
+#endif
+    }
+
+    static int AppenderFd(detail::Appender& a) {
+        int fd = a.fd.load(std::memory_order_acquire);
+        if (fd >= 0 && a.lockFile.generation &&
+            a.lockFile.generation->load(std::memory_order_acquire) == a.openedGeneration.load(std::memory_order_relaxed)) {
+            return fd;
+        }
+        std::lock_guard<std::mutex> lock(a.reopenMutex);
+        if (!a.lockFile.generation && !OpenLockFile(a.path, a.lockFile)) return -1;
+#if defined(C6_HAVE_FALLOCATE)
+        if (!a.sharedLocked) a.sharedLocked = LockAppenderByte(a.lockFile.fd, F_RDLCK, true);
+#endif
+        std::uint64_t generation = a.lockFile.generation->load(std::memory_order_acquire);
+        fd = a.fd.load(std::memory_order_relaxed);
+        if (fd >= 0 && generation == a.openedGeneration.load(std::memory_order_relaxed)) return fd;
+#if defined(C6_HAVE_FALLOCATE)
+        Preallocation mode = preallocMode.load(std::memory_order_relaxed);
+#else
+        Preallocation mode = Preallocation::None;
+#endif
+        int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (mode == Preallocation::ExplicitSize ? 0 : O_APPEND);
+        int fresh = open(a.path.c_str(), flags, 0644);
+        if (fresh < 0) return -1;
+        if (fd >= 0) {
+            // A range reserved in the file behind fd must be written there: turn new
+            // ExplicitSize writers away and let the ones holding a range finish first
+            a.openedGeneration.store(~std::uint64_t(0), std::memory_order_seq_cst);
+            while (a.rangeWriters.load(std::memory_order_seq_cst) != 0) std::this_thread::yield();
+            dup2(fresh, fd);
+            close(fresh);
+        }
+        else {
+            fd = fresh;
+        }
+        {
+            std::lock_guard<std::mutex> preallocLock(a.preallocMutex);
+            struct stat st;
+            a.allocatedEnd = fstat(fd, &st) == 0 ? static_cast<std::uint64_t>(st.st_size) : 0;
+            a.bytesSinceCheck.store(0, std::memory_order_relaxed);
+            a.preallocFailed = false;
+        }
+        a.openedMode.store(mode, std::memory_order_relaxed);
+        a.openedGeneration.store(generation, std::memory_order_relaxed);
+        a.fd.store(fd, std::memory_order_release);
+        return fd;
+    }
+
+    static bool WriteOnce(int fd, const char* data, std::size_t size) {
+        // A regular-file write normally completes in one call; only disk-full or a
+        // signal can shorten it, in which case the rest goes out as best effort.
+        while (size > 0) {
+            ssize_t n = write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            size -= static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+#if defined(C6_HAVE_FALLOCATE)
+
+    static bool WriteAt(int fd, const char* data, std::size_t size, std::uint64_t offset) {
+        while (size > 0) {
+            ssize_t n = pwrite(fd, data, size, static_cast<off_t>(offset));
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            size -= static_cast<std::size_t>(n);
+            offset += static_cast<std::uint64_t>(n);
+        }
+        return true;
+    }
+
+    // ExplicitSize: reserves [offset, offset + size) in the logical file with one CAS on
+    // the lock-file word, then writes there. Disjoint ranges keep records whole without
+    // O_APPEND. Returns the descriptor matching the reservation, or -1. 'reserved' says
+    // whether a range was taken; the caller then holds a rangeWriters count on the
+    // descriptor and drops it once the range is written.
+    static int ReserveRange(detail::Appender& a, std::size_t size, std::uint64_t& offset, bool& reserved) {
+        reserved = false;
+        for (;;) {
+            int fd = AppenderFd(a);
+            if (fd < 0) return -1;
+            if (a.openedMode.load(std::memory_order_relaxed) != Preallocation::ExplicitSize) return fd;
+            std::uint64_t generation = a.openedGeneration.load(std::memory_order_relaxed);
+            std::uint64_t word = a.lockFile.logicalEnd->load(std::memory_order_acquire);
+            if (word == 0) {
+                // Nobody tracks this file yet: take the end from its contents
+                a.lockFile.logicalEnd->compare_exchange_strong(word, EndTag(generation) | ScanLogicalEnd(fd));
+                continue;
+            }
+            if ((word & ~END_MASK) != EndTag(generation)) {
+                if ((word & ~END_MASK) == EndTag(generation + 1)) {
+                    std::this_thread::yield(); // compaction is swapping files; reopen shortly
+                }
+                else {
+                    a.lockFile.logicalEnd->compare_exchange_strong(word, 0); // left over from an older file
+                }
+                continue;
+            }
+            // Pairs with AppenderFd: either it sees this count before replacing the file
+            // behind fd, or this thread sees the generation it cleared and retries
+            a.rangeWriters.fetch_add(1, std::memory_order_seq_cst);
+            if (a.openedGeneration.load(std::memory_order_seq_cst) == generation &&
+                a.lockFile.logicalEnd->compare_exchange_weak(word, word + size, std::memory_order_acq_rel)) {
+                offset = word & END_MASK;
+                reserved = true;
+                return fd;
+            }
+            a.rangeWriters.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+#endif
+
+    static bool WriteRecord(detail::Appender& a, int fd, const std::string& record) {
+#if defined(C6_HAVE_FALLOCATE)
+        Preallocation mode = a.openedMode.load(std::memory_order_relaxed);
+        if (mode == Preallocation::ExplicitSize) {
+            std::uint64_t offset = 0;
+            bool reserved = false;
+            fd = ReserveRange(a, record.size(), offset, reserved);
+            if (fd < 0) return false;
+            if (reserved) {
+                EnsurePreallocated(a, fd, mode, offset + record.size());
+                bool ok = WriteAt(fd, record.data(), record.size(), offset);
+                a.rangeWriters.fetch_sub(1, std::memory_order_release);
+                return ok;
+            }
+        }
+        else if (mode == Preallocation::KeepSize) {
+            // The O_APPEND offset is unknown here; check the file size every half extent
+            std::uint64_t half = preallocExtent.load(std::memory_order_relaxed) / 2;
+            if (a.bytesSinceCheck.fetch_add(record.size(), std::memory_order_relaxed) + record.size() >= half) {
+                a.bytesSinceCheck.store(0, std::memory_order_relaxed);
+                struct stat st;
+                if (fstat(fd, &st) == 0) EnsurePreallocated(a, fd, mode, static_cast<std::uint64_t>(st.st_size));
+            }
+        }
+#else
+        (void)a;
+#endif
+        return WriteOnce(fd, record.data(), record.size());
+    }
+
+    bool detail::AppendRecordAtomic(Appender* appender, std::string_view line, std::size_t headerLength) {
+        InFlightWrite inFlight(*appender);
+        if (!inFlight) return false;
+        int fd = AppenderFd(*appender);
+        if (fd < 0) return false;
+
+        struct AtomicRecord;
+        std::string& record = ThreadScratch<std::string, AtomicRecord>();
+        if (line.size() + 1 <= ATOMIC_RECORD_LIMIT) {
+            record.assign(line.data(), line.size());
+            record.push_back('\n');
+            return WriteRecord(*appender, fd, record);
+        }
+
+        // Too long for one atomic write: emit self-contained fragment lines sharing an id
+        return detail::SplitIntoFragments(line, headerLength, ATOMIC_RECORD_LIMIT - 1, [&](std::string& fragment) {
+            fragment.push_back('\n');
+            return WriteRecord(*appender, fd, fragment);
+        });
+    }
+
+    bool detail::SplitIntoFragments(std::string_view line, std::size_t headerLength, std::size_t recordLimit,
+        const std::function<bool(std::string& fragment)>& emit) {
+        static std::atomic<std::uint64_t> fragmentSeq{ 0 };
+        struct Fragment;
+        std::string& fragment = ThreadScratch<std::string, Fragment>();
+        if (headerLength > line.size() || headerLength > recordLimit / 2) headerLength = 0;
+        std::string_view header = line.substr(0, headerLength);
+        std::string_view body = line.substr(headerLength);
+        char tag[64];
+        std::uint64_t id = fragmentSeq.fetch_add(1, std::memory_order_relaxed);
+        const std::size_t tagReserve = 48; // "[part kkkk/nnnn pppppppp-ssssssss] "
+        std::size_t chunk = recordLimit - header.size() - tagReserve;
+        std::size_t parts = (body.size() + chunk - 1) / chunk;
+        for (std::size_t k = 0; k < parts; ++k) {
+            std::string_view piece = body.substr(k * chunk, chunk);
+            std::snprintf(tag, sizeof(tag), "[part %zu/%zu %x-%llx] ", k + 1, parts,
+                static_cast<unsigned>(getpid()), static_cast<unsigned long long>(id));
+            fragment.assign(header.data(), header.size());
+            fragment.append(tag);
+            fragment.append(piece.data(), piece.size());
+            if (!emit(fragment)) return false;
+        }
+        return true;
+    }
+
+    bool detail::CompactLogFileAt(const std::string& logPath, std::size_t maxLines) {
+        LockFile lockFile;
+        if (!OpenLockFile(logPath, lockFile)) return false;
+        // Serializes compactors across processes; appenders never take this lock
+        if (flock(lockFile.fd, LOCK_EX) != 0) {
+            CloseLockFile(lockFile);
+            return false;
+        }
+        bool ok = false;
+        int oldFd = open(logPath.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        if (oldFd >= 0 && fstat(oldFd, &st) == 0) {
+            // Compact a snapshot of what is there now
+            std::string snapshot(static_cast<std::size_t>(st.st_size), '\0');
+            std::size_t got = 0;
+            while (got < snapshot.size()) {
+                ssize_t n = pread(oldFd, &snapshot[got], snapshot.size() - got, static_cast<off_t>(got));
+                if (n <= 0) break;
+                got += static_cast<std::size_t>(n);
+            }
+            snapshot.resize(got);
+            // Zero bytes are preallocated space or records still being written
+            std::size_t firstZero = snapshot.find('\0');
+            if (firstZero != std::string::npos) snapshot.resize(firstZero);
+            std::size_t lastNewline = snapshot.rfind('\n');
+            std::size_t consumed = lastNewline == std::string::npos ? 0 : lastNewline + 1;
+            snapshot.resize(consumed);
+
+            std::istringstream in(snapshot);
+            std::string compacted;
+            if (!detail::CompactLogText(in, maxLines, compacted)) compacted.clear();
+
+            std::string tmpPath = logPath + ".compact.tmp";
+            int tmpFd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 07777);
+            if (tmpFd >= 0) {
+                // The rewritten log keeps the old one's mode (open() applied the umask) and,
+                // where we may change it, its owner
+                if ((fchown(tmpFd, st.st_uid, st.st_gid) != 0 && errno != EPERM) || fchmod(tmpFd, st.st_mode & 07777) != 0) {
+                    std::cerr << RED << "[ERROR] Failed to carry the permissions of log file '" << logPath << "' over to its compacted copy." << RESET << std::endl;
+                }
+            }
+            if (tmpFd >= 0 && WriteOnce(tmpFd, compacted.data(), compacted.size()) && fsync(tmpFd) == 0) {
+                close(tmpFd);
+                tmpFd = -1;
+                if (rename(tmpPath.c_str(), logPath.c_str()) == 0) {
+                    // ExplicitSize writers track the logical end; hand them the new file's
+                    std::uint64_t generation = lockFile.generation->load(std::memory_order_acquire);
+                    std::uint64_t word = lockFile.logicalEnd->load(std::memory_order_acquire);
+                    while (word != 0 && !lockFile.logicalEnd->compare_exchange_weak(word, EndTag(generation + 1) | compacted.size())) {}
+                    bool explicitEnd = word != 0;
+                    lockFile.generation->fetch_add(1, std::memory_order_seq_cst);
+                    // Appenders that checked the generation before the bump may still be
+                    // writing to the old file; once they are done, carry their records over.
+                    WaitForInFlight(lockFile, generation);
+                    int newFd = open(logPath.c_str(), O_WRONLY | O_CLOEXEC | (explicitEnd ? 0 : O_APPEND));
+                    std::string carried;
+                    char buf[64 * 1024];
+                    for (std::uint64_t offset = consumed;;) {
+                        ssize_t n = pread(oldFd, buf, sizeof(buf), static_cast<off_t>(offset));
+                        if (n <= 0) break;
+                        offset += static_cast<std::uint64_t>(n);
+                        carried.append(buf, static_cast<std::size_t>(n));
+                    }
+                    // Zero bytes are preallocated space; every reserved range is written by now
+                    carried.erase(std::remove(carried.begin(), carried.end(), '\0'), carried.end());
+                    // One write, so the carried records stay together in the new file
+                    if (newFd >= 0 && !carried.empty()) {
+                        if (!explicitEnd) {
+                            WriteOnce(newFd, carried.data(), carried.size());
+                        }
+#if defined(C6_HAVE_FALLOCATE)
+                        else {
+                            std::uint64_t w = lockFile.logicalEnd->load(std::memory_order_acquire);
+                            while ((w & ~END_MASK) == EndTag(generation + 1) &&
+                                !lockFile.logicalEnd->compare_exchange_weak(w, w + carried.size(), std::memory_order_acq_rel)) {}
+                            if ((w & ~END_MASK) == EndTag(generation + 1)) WriteAt(newFd, carried.data(), carried.size(), w & END_MASK);
+                        }
+#endif
+                    }
+                    if (newFd >= 0) close(newFd);
+                    ok = true;
+                }
+            }
+            if (tmpFd >= 0) close(tmpFd);
+            if (!ok) unlink(tmpPath.c_str());
+        }
+        if (oldFd >= 0) close(oldFd);
+        flock(lockFile.fd, LOCK_UN);
+        CloseLockFile(lockFile);
+        return ok;
+    }
+
+    bool detail::SealLogFileAt(const std::string& logPath, const std::string& sealedPath) {
+        LockFile lockFile;
+        if (!OpenLockFile(logPath, lockFile)) return false;
+        // Compactors take the same lock, so a seal never renames a file mid-compaction
+        if (flock(lockFile.fd, LOCK_EX) != 0) {
+            CloseLockFile(lockFile);
+            return false;
+        }
+        int sealedFd = open(logPath.c_str(), O_RDWR | O_CLOEXEC);
+        bool ok = sealedFd >= 0 && rename(logPath.c_str(), sealedPath.c_str()) == 0;
+        if (ok) {
+            // ExplicitSize writers start the new file at offset 0
+            std::uint64_t generation = lockFile.generation->load(std::memory_order_acquire);
+            std::uint64_t word = lockFile.logicalEnd->load(std::memory_order_acquire);
+            while (word != 0 && !lockFile.logicalEnd->compare_exchange_weak(word, EndTag(generation + 1))) {}
+            lockFile.generation->fetch_add(1, std::memory_order_seq_cst);
+            // Appenders that checked the generation before the bump still write to the sealed
+            // file; those records belong to it, so wait for them before it is compressed.
+            WaitForInFlight(lockFile, generation);
+            if (word != 0 && (word & ~END_MASK) == EndTag(generation) && ftruncate(sealedFd, static_cast<off_t>(word & END_MASK)) != 0) {
+                std::cerr << RED << "[ERROR] Failed to trim preallocated log segment '" << sealedPath << "'." << RESET << std::endl;
+            }
+        }
+        if (sealedFd >= 0) close(sealedFd);
+        flock(lockFile.fd, LOCK_UN);
+        CloseLockFile(lockFile);
+        return ok;
+    }
+
+#endif // C6_APPEND_POSIX
+
+#if !defined(C6_APPEND_POSIX)
+
+    struct detail::Appender {
+        std::mutex appendMutex;
+        std::string path;
+        detail::PathFile pathFile;
+    };
+
+#endif
+
+    static std::mutex appendersMutex;
+    // Leaked like the default logger, which keeps pointers into it and must keep
+    // working from static destructors
+    static std::vector<std::unique_ptr<detail::Appender>>& Appenders() {
+        static auto* appenders = new std::vector<std::unique_ptr<detail::Appender>>;
+        return *appenders;
+    }
+
+#if defined(C6_HAVE_FALLOCATE)
+
+    // The registry never destroys its appenders, so preallocated tails are trimmed by
+    // an exit hook instead. It turns writers away from each descriptor, lets the ones
+    // holding a reserved range finish, and trims; a static destructor logging after
+    // that reopens the file and writes without preallocating.
+    static void TrimAtExit() {
+        preallocClosed.store(true, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> registryLock(appendersMutex);
+        for (auto& appender : Appenders()) {
+            detail::Appender& a = *appender;
+            std::lock_guard<std::mutex> lock(a.reopenMutex);
+            if (a.openedMode.load(std::memory_order_relaxed) == Preallocation::None) continue;
+            std::uint64_t generation = a.openedGeneration.exchange(~std::uint64_t(0), std::memory_order_seq_cst);
+            while (a.rangeWriters.load(std::memory_order_seq_cst) != 0) std::this_thread::yield();
+            TrimPreallocation(a, generation);
+        }
+    }
+
+    static void RegisterExitTrim() {
+        static bool registered = std::atexit(TrimAtExit) == 0;
+        (void)registered;
+    }
+
+#endif
+
+    detail::Appender* detail::GetAppender(const std::string& logPath) {
+        std::lock_guard<std::mutex> lock(appendersMutex);
+        for (auto& appender : Appenders()) {
+            if (appender->path == logPath) return appender.get();
+        }
+#if defined(C6_APPEND_POSIX)
+        RegisterForkHandler();
+#endif
+#if defined(C6_HAVE_FALLOCATE)
+        RegisterExitTrim();
+#endif
+        Appenders().push_back(std::make_unique<Appender>());
+        Appenders().back()->path = logPath;
+        return Appenders().back().get();
+    }
+
+    detail::PathFile& detail::GetPathFile(Appender* appender) {
+        return appender->pathFile;
+    }
+
+    void SetPreallocation(const PreallocationPolicy& policy) {
+        Preallocation mode = policy.mode;
+#if !defined(C6_HAVE_FALLOCATE)
+        mode = Preallocation::None;
+#endif
+        std::size_t extent = policy.extentBytes < (64 * 1024) ? (64 * 1024) : policy.extentBytes;
+        std::lock_guard<std::mutex> registryLock(appendersMutex);
+        preallocExtent.store(extent, std::memory_order_relaxed);
+        preallocMode.store(mode, std::memory_order_relaxed);
+#if defined(C6_APPEND_POSIX)
+        for (auto& appender : Appenders()) {
+            detail::Appender& a = *appender;
+            std::lock_guard<std::mutex> lock(a.reopenMutex);
+#if defined(C6_HAVE_FALLOCATE)
+            if (a.openedMode.load(std::memory_order_relaxed) != Preallocation::None &&
+                a.openedMode.load(std::memory_order_relaxed) != mode) {
+                TrimPreallocation(a, a.openedGeneration.load(std::memory_order_relaxed));
+            }
+#endif
+            // Reopen on the next write so the descriptor matches the mode
+            a.openedGeneration.store(~std::uint64_t(0), std::memory_order_relaxed);
+        }
+#endif
+    }
+
+    PreallocationPolicy GetPreallocation() {
+        PreallocationPolicy policy;
+        policy.mode = preallocMode.load(std::memory_order_relaxed);
+        policy.extentBytes = preallocExtent.load(std::memory_order_relaxed);
+        return policy;
+    }
+
+    void detail::FillAppendStats(LoggerStats& stats) {
+        stats.preallocations = preallocCount.load(std::memory_order_relaxed);
+    }
+
+#if !defined(C6_APPEND_POSIX)
+
+    bool detail::AppendRecordAtomic(Appender* appender, std::string_view line, std::size_t) {
+        // No O_APPEND guarantees to build on: fall back to a serialized stream append
+        std::lock_guard<std::mutex> lock(appender->appendMutex);
+        std::ofstream logFile(appender->path.c_str(), std::ios::app | std::ios::binary);
+        if (!logFile.is_open()) return false;
+        logFile.write(line.data(), static_cast<std::streamsize>(line.size()));
+        logFile.put('\n');
+        return static_cast<bool>(logFile);
+    }
+
+    bool detail::CompactLogFileAt(const std::string& logPath, std::size_t maxLines) {
+        std::ifstream in(logPath.c_str());
+        if (!in.is_open()) return false;
+        std::string compacted;
+        bool haveLines = detail::CompactLogText(in, maxLines, compacted);
+        in.close();
+        if (!haveLines) return true;
+        std::ofstream out(logPath.c_str(), std::ios::trunc);
+        if (!out.is_open()) return false;
+        out << compacted;
+        return true;
+    }
+
+    bool detail::SealLogFileAt(const std::string& logPath, const std::string& sealedPath) {
+        // Appends reopen the path for every record here, so a rename is enough
+        std::error_code ec;
+        std::filesystem::rename(logPath, sealedPath, ec);
+        return !ec;
+    }
+
+#endif
+}
@@ -0,0 +1,54 @@
+#include "../include/LogBatch.h"
+
+namespace C6Logger {
+
+    LogBatch::LogBatch(Logger& target) : logger(target) {}
+
+    LogBatch::~LogBatch() {
+        Commit();
+    }
+
+    LogBatch& LogBatch::Add(LogLevel level, std::string_view message, std::string_view messenger) {
+        if (!logger.ShouldLog(level)) return *this;
+        Record record{ level, text.size(), message.size(), 0, messenger.size(), Messenger() };
+        text.append(message.data(), message.size());
+        record.messengerOffset = text.size();
+        text.append(messenger.data(), messenger.size());
+        records.push_back(record);
+        return *this;
+    }
+
+    LogBatch& LogBatch::Add(LogLevel level, std::string_view message, const Messenger& messenger) {
+        if (!logger.ShouldLog(level) || !messenger.Admit(level)) return *this;
+        Record record{ level, text.size(), message.size(), 0, 0, messenger };
+        text.append(message.data(), message.size());
+        records.push_back(record);
+        return *this;
+    }
+
+    void LogBatch::Commit() {
+        if (records.empty()) return;
+        logger.Log(*this);
+        Discard();
+    }
+
+    void LogBatch::Discard() {
+        records.clear();
+        text.clear();
+    }
+
+    LogBatch::Entry LogBatch::At(std::size_t index) const {
+        const Record& record = records[index];
+        Entry entry;
+        entry.level = record.level;
+        entry.message = std::string_view(text).substr(record.messageOffset, record.messageLength);
+        if (record.interned.Empty()) {
+            entry.messenger = std::string_view(text).substr(record.messengerOffset, record.messengerLength);
+        }
+        else {
+            entry.messenger = record.interned.Name();
+            entry.messengerPrefix = record.interned.Prefix();
+        }
+        return entry;
+    }
+}
@@ -0,0 +1,542 @@
+#include "../include/LogBinary.h"
+#include "../include/LogClock.h"
+#include "LogInternal.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <nmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#define C6_CRC32C_SSE42 1
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define C6_BINARY_POSIX 1
+#endif
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <unordered_set>
+
+namespace C6Logger {
+
+    static constexpr char BINARY_MAGIC[4] = { 'C', '6', 'B', 'L' };
+    static constexpr std::uint8_t BINARY_VERSION = 1;
+    static constexpr std::uint64_t FILE_HEADER_SIZE = 8;
+    static constexpr std::uint64_t RECORD_HEADER_SIZE = 24;
+    static constexpr std::uint64_t CRC_START = 8; // type .. end of payload
+
+    enum RecordType : std::uint8_t { RECORD_LOG = 1, RECORD_MESSENGER = 2, RECORD_SYNC = 3 };
+
+    static constexpr unsigned char SYNC_PATTERN[16] = {
+        0x7E, 0xC6, 0xB1, 0x5C, 0x9A, 0x33, 0xD4, 0x0F, 0x62, 0xE8, 0x1B, 0xA7, 0x45, 0xF0, 0x2D, 0x99
+    };
+
+    // --- CRC-32C --------------------------------------------------------------
+
+    // Slicing-by-8 tables for the reflected Castagnoli polynomial
+    static const std::array<std::array<std::uint32_t, 256>, 8>& Crc32cTables() {
+        static const auto tables = [] {
+            std::array<std::array<std::uint32_t, 256>, 8> t{};
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                std::uint32_t crc = i;
+                for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+                t[0][i] = crc;
+            }
+            for (std::uint32_t i = 0; i < 256; ++i) {
+                for (int s = 1; s < 8; ++s) t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+            }
+            return t;
+        }();
+        return tables;
+    }
+
+    static std::uint32_t Crc32cSoftware(const unsigned char* p, std::size_t n, std::uint32_t crc) {
+        const auto& t = Crc32cTables();
+        while (n >= 8) {
+            std::uint32_t lo = crc ^ (std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8 | std::uint32_t(p[2]) << 16 | std::uint32_t(p[3]) << 24);
+            crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+                t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+            p += 8;
+            n -= 8;
+        }
+        while (n--) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+        return crc;
+    }
+
+#if defined(C6_CRC32C_SSE42)
+#if defined(__GNUC__)
+    __attribute__((target("sse4.2")))
+#endif
+    static std::uint32_t Crc32cHardware(const unsigned char* p, std::size_t n, std::uint32_t crc) {
+        std::uint64_t crc64 = crc;
+        while (n >= 8) {
+            std::uint64_t word;
+            std::memcpy(&word, p, 8);
+            crc64 = _mm_crc32_u64(crc64, word);
+            p += 8;
+            n -= 8;
+        }
+        crc = static_cast<std::uint32_t>(crc64);
+        while (n--) crc = _mm_crc32_u8(crc, *p++);
+        return crc;
+    }
+
+    static bool HasSse42() {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 20)) != 0;
+#else
+        return __builtin_cpu_supports("sse4.2");
+#endif
+    }
+#endif
+
+    std::uint32_t Crc32c(const void* data, std::size_t size, std::uint32_t crc) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        crc = ~crc;
+#if defined(C6_CRC32C_SSE42)
+        static const bool hardware = HasSse42();
+        if (hardware) return ~Crc32cHardware(p, size, crc);
+#endif
+        return ~Crc32cSoftware(p, size, crc);
+    }
+
+    // --- Record I/O -----------------------------------------------------------
+
+    struct RecordHeader {
+        std::uint32_t payloadLength;
+        std::uint32_t crc;
+        std::uint8_t type;
+        std::uint8_t level;
+        std::uint16_t flags;
+        std::uint32_t messengerId;
+        std::int64_t wallNs;
+    };
+
+    static std::uint32_t Get32(const unsigned char* p) {
+        return std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8 | std::uint32_t(p[2]) << 16 | std::uint32_t(p[3]) << 24;
+    }
+
+    static void Put32(char* p, std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) p[i] = static_cast<char>(v >> (8 * i));
+    }
+
+    static bool ReadAt(std::ifstream& in, std::uint64_t offset, char* data, std::size_t n) {
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(offset));
+        in.read(data, static_cast<std::streamsize>(n));
+        return static_cast<std::size_t>(in.gcount()) == n;
+    }
+
+    // Reads a record header; false if it cannot be a record that fits in the file
+    static bool ReadHeader(std::ifstream& in, std::uint64_t at, std::uint64_t fileSize, RecordHeader& h, char* raw) {
+        if (at + RECORD_HEADER_SIZE > fileSize || !ReadAt(in, at, raw, RECORD_HEADER_SIZE)) return false;
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(raw);
+        h.payloadLength = Get32(p);
+        h.crc = Get32(p + 4);
+        h.type = p[8];
+        h.level = p[9];
+        h.flags = static_cast<std::uint16_t>(p[10] | p[11] << 8);
+        h.messengerId = Get32(p + 12);
+        h.wallNs = static_cast<std::int64_t>(std::uint64_t(Get32(p + 16)) | std::uint64_t(Get32(p + 20)) << 32);
+        return h.payloadLength <= BINARY_MAX_PAYLOAD && h.type >= RECORD_LOG && h.type <= RECORD_SYNC &&
+            at + RECORD_HEADER_SIZE + h.payloadLength <= fileSize;
+    }
+
+    // Reads and checksums a whole record
+    static bool ReadChecked(std::ifstream& in, std::uint64_t at, std::uint64_t fileSize, RecordHeader& h, std::string& payload) {
+        char raw[RECORD_HEADER_SIZE];
+        if (!ReadHeader(in, at, fileSize, h, raw)) return false;
+        payload.resize(h.payloadLength);
+        if (h.payloadLength && !ReadAt(in, at + RECORD_HEADER_SIZE, &payload[0], h.payloadLength)) return false;
+        std::uint32_t crc = Crc32c(raw + CRC_START, RECORD_HEADER_SIZE - CRC_START);
+        crc = Crc32c(payload.data(), payload.size(), crc);
+        if (crc != h.crc) return false;
+        return h.type != RECORD_SYNC || (payload.size() == sizeof(SYNC_PATTERN) && std::memcmp(payload.data(), SYNC_PATTERN, sizeof(SYNC_PATTERN)) == 0);
+    }
+
+    // Offset of the first valid sync record starting at or after 'from', or fileSize
+    static std::uint64_t FindSyncMarker(std::ifstream& in, std::uint64_t from, std::uint64_t fileSize) {
+        constexpr std::size_t CHUNK = 64 * 1024;
+        std::vector<char> chunk(CHUNK + sizeof(SYNC_PATTERN));
+        RecordHeader h;
+        std::string payload;
+        for (std::uint64_t base = from + RECORD_HEADER_SIZE; base + sizeof(SYNC_PATTERN) <= fileSize; base += CHUNK) {
+            std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(chunk.size(), fileSize - base));
+            if (!ReadAt(in, base, chunk.data(), n)) break;
+            const char* end = chunk.data() + n;
+            for (const char* p = chunk.data(); p + sizeof(SYNC_PATTERN) <= end; ++p) {
+                p = static_cast<const char*>(std::memchr(p, SYNC_PATTERN[0], static_cast<std::size_t>(end - p)));
+                if (!p || p + sizeof(SYNC_PATTERN) > end) break;
+                if (std::memcmp(p, SYNC_PATTERN, sizeof(SYNC_PATTERN)) != 0) continue;
+                std::uint64_t candidate = base + static_cast<std::uint64_t>(p - chunk.data()) - RECORD_HEADER_SIZE;
+                if (ReadChecked(in, candidate, fileSize, h, payload) && h.type == RECORD_SYNC) return candidate;
+            }
+        }
+        return fileSize;
+    }
+
+    // --- Writer ---------------------------------------------------------------
+
+    BinaryLogWriter::BinaryLogWriter(const std::string& logPath) : path(logPath) {
+        if (!LockAgainstCompaction() || !Recover()) return;
+        out.open(path.c_str(), std::ios::binary | std::ios::app);
+        if (!out.is_open()) {
+            std::cerr << RED << "[ERROR] Failed to open binary log '" << path << "'." << RESET << std::endl;
+            return;
+        }
+        if (size == 0) {
+            char header[FILE_HEADER_SIZE] = { BINARY_MAGIC[0], BINARY_MAGIC[1], BINARY_MAGIC[2], BINARY_MAGIC[3],
+                static_cast<char>(BINARY_VERSION), 0, 0, 0 };
+            out.write(header, FILE_HEADER_SIZE);
+            size = FILE_HEADER_SIZE;
+        }
+        // Every session starts with a sync marker
+        Emit(RECORD_SYNC, LogLevel::trace, 0, 0, std::string_view(reinterpret_cast<const char*>(SYNC_PATTERN), sizeof(SYNC_PATTERN)));
+        out.flush();
+    }
+
+    BinaryLogWriter::~BinaryLogWriter() {
+        if (out.is_open()) out.close();
+#if defined(C6_BINARY_POSIX)
+        if (lockFd >= 0) close(lockFd);
+#endif
+    }
+
+    // Holds a shared flock on the file for the writer's lifetime; CompactBinaryLog()
+    // needs it exclusively. Retries if a compaction replaced the file meanwhile.
+    bool BinaryLogWriter::LockAgainstCompaction() {
+#if defined(C6_BINARY_POSIX)
+        for (;;) {
+            int fd = open(path.c_str(), O_RDONLY | O_CREAT | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                std::cerr << RED << "[ERROR] Failed to open binary log '" << path << "'." << RESET << std::endl;
+                return false;
+            }
+            while (flock(fd, LOCK_SH) != 0 && errno == EINTR) {}
+            struct stat locked, current;
+            if (fstat(fd, &locked) == 0 && stat(path.c_str(), &current) == 0 &&
+                locked.st_dev == current.st_dev && locked.st_ino == current.st_ino) {
+                lockFd = fd;
+                return true;
+            }
+            close(fd);
+        }
+#else
+        return true;
+#endif
+    }
+
+    // Restores the messenger table of an existing file and cuts off a torn tail.
+    // A damaged record followed by a sync marker is left in place for readers to skip.
+    bool BinaryLogWriter::Recover() {
+        std::error_code ec;
+        if (!std::filesystem::exists(path, ec)) return true;
+        std::uint64_t fileSize = std::filesystem::file_size(path, ec);
+        if (ec || fileSize == 0) return true;
+        std::ifstream in(path.c_str(), std::ios::binary);
+        char header[FILE_HEADER_SIZE];
+        if (!in.is_open() || fileSize < FILE_HEADER_SIZE || !ReadAt(in, 0, header, FILE_HEADER_SIZE) ||
+            std::memcmp(header, BINARY_MAGIC, 4) != 0) {
+            std::cerr << RED << "[ERROR] '" << path << "' exists and is not a binary log." << RESET << std::endl;
+            return false;
+        }
+        std::uint64_t at = FILE_HEADER_SIZE;
+        RecordHeader h;
+        std::string payload;
+        while (at < fileSize) {
+            if (!ReadChecked(in, at, fileSize, h, payload)) {
+                std::uint64_t next = FindSyncMarker(in, at + 1, fileSize);
+                if (next == fileSize) break;
+                at = next;
+                continue;
+            }
+            if (h.type == RECORD_MESSENGER) {
+                messengerIds[payload] = h.messengerId;
+                // Compaction drops unused definitions, so ids can be sparse: never reuse one
+                nextMessengerId = std::max(nextMessengerId, h.messengerId + 1);
+            }
+            at += RECORD_HEADER_SIZE + h.payloadLength;
+        }
+        in.close();
+        if (at < fileSize) {
+            std::filesystem::resize_file(path, at, ec);
+            if (ec) {
+                std::cerr << RED << "[ERROR] Failed to cut the torn tail of binary log '" << path << "'." << RESET << std::endl;
+                return false;
+            }
+        }
+        size = at;
+        lastSync = 0;
+        return true;
+    }
+
+    bool BinaryLogWriter::Emit(std::uint8_t recordType, LogLevel level, std::uint32_t messengerId, std::int64_t stamp, std::string_view data) {
+        std::size_t length = std::min<std::size_t>(data.size(), BINARY_MAX_PAYLOAD);
+        record.resize(RECORD_HEADER_SIZE + length);
+        char* p = &record[0];
+        Put32(p, static_cast<std::uint32_t>(length));
+        p[8] = static_cast<char>(recordType);
+        p[9] = static_cast<char>(level);
+        p[10] = p[11] = 0;
+        Put32(p + 12, messengerId);
+        Put32(p + 16, static_cast<std::uint32_t>(static_cast<std::uint64_t>(stamp)));
+        Put32(p + 20, static_cast<std::uint32_t>(static_cast<std::uint64_t>(stamp) >> 32));
+        std::memcpy(p + RECORD_HEADER_SIZE, data.data(), length);
+        Put32(p + 4, Crc32c(p + CRC_START, record.size() - CRC_START));
+        out.write(record.data(), static_cast<std::streamsize>(record.size()));
+        if (recordType == RECORD_SYNC) lastSync = size;
+        size += record.size();
+        return !out.fail();
+    }
+
+    bool BinaryLogWriter::Append(std::int64_t stamp, LogLevel level, std::string_view messenger, std::string_view message) {
+        if (!out.is_open()) return false;
+        if (size - lastSync >= BINARY_SYNC_INTERVAL) {
+            Emit(RECORD_SYNC, LogLevel::trace, 0, 0, std::string_view(reinterpret_cast<const char*>(SYNC_PATTERN), sizeof(SYNC_PATTERN)));
+        }
+        std::uint32_t messengerId = 0;
+        if (!messenger.empty()) {
+            auto it = messengerIds.find(std::string(messenger));
+            if (it == messengerIds.end()) {
+                messengerId = nextMessengerId++;
+                messengerIds.emplace(std::string(messenger), messengerId);
+                Emit(RECORD_MESSENGER, LogLevel::trace, messengerId, stamp, messenger);
+            }
+            else {
+                messengerId = it->second;
+            }
+        }
+        // One write() per record, like the text log
+        bool ok = Emit(RECORD_LOG, level, messengerId, stamp, message);
+        out.flush();
+        return ok && !out.fail();
+    }
+
+    bool BinaryLogWriter::Flush() {
+        if (!out.is_open()) return false;
+        out.flush();
+        return !out.fail();
+    }
+
+    void BinaryLogSink::Write(LogLevel level, std::string_view line, std::size_t headerLength) {
+        headerLength = std::min(headerLength, line.size());
+        writer.Append(ClockToWallNs(ClockNow()), level, std::string_view(), line.substr(headerLength));
+    }
+
+    void BinaryLogSink::WriteRecord(const LogRecordView& record) {
+        writer.Append(record.wallNs, record.level, record.messenger, record.message);
+    }
+
+    // --- Reader ---------------------------------------------------------------
+
+    BinaryLogReader::BinaryLogReader(const std::string& path) {
+        in.open(path.c_str(), std::ios::binary);
+        if (!in.is_open()) return;
+        std::error_code ec;
+        fileSize = std::filesystem::file_size(path, ec);
+        char header[FILE_HEADER_SIZE];
+        if (ec || fileSize < FILE_HEADER_SIZE || !ReadAt(in, 0, header, FILE_HEADER_SIZE) ||
+            std::memcmp(header, BINARY_MAGIC, 4) != 0 || static_cast<std::uint8_t>(header[4]) > BINARY_VERSION) {
+            return;
+        }
+        position = FILE_HEADER_SIZE;
+        messengersScannedTo = FILE_HEADER_SIZE;
+        valid = true;
+    }
+
+    BinaryLogReader::ReadResult BinaryLogReader::ReadRecord(std::uint64_t at, bool wantPayload) {
+        RecordHeader h;
+        if (wantPayload) {
+            if (!ReadChecked(in, at, fileSize, h, payload)) return ReadResult::Corrupt;
+        }
+        else {
+            char raw[RECORD_HEADER_SIZE];
+            if (!ReadHeader(in, at, fileSize, h, raw)) return ReadResult::Corrupt;
+        }
+        payloadLength = h.payloadLength;
+        type = h.type;
+        levelByte = h.level;
+        messengerId = h.messengerId;
+        wallNs = h.wallNs;
+        return ReadResult::Record;
+    }
+
+    bool BinaryLogReader::Resync(std::uint64_t from) {
+        position = FindSyncMarker(in, from, fileSize);
+        return position < fileSize;
+    }
+
+    bool BinaryLogReader::Seek(std::uint64_t offset) {
+        if (!valid) return false;
+        tornTail = false;
+        return Resync(std::max(offset, FILE_HEADER_SIZE));
+    }
+
+    bool BinaryLogReader::Next(BinaryRecord& record) {
+        if (!valid) return false;
+        while (position < fileSize) {
+            std::uint64_t at = position;
+            if (ReadRecord(at, true) != ReadResult::Record) {
+                // Damage followed by a sync marker is skipped; damage at the end is a torn tail
+                if (!Resync(at + 1)) {
+                    tornTail = true;
+                    return false;
+                }
+                ++corrupt;
+                continue;
+            }
+            position = at + RECORD_HEADER_SIZE + payloadLength;
+            if (type == RECORD_MESSENGER) {
+                messengers[messengerId] = payload;
+                continue;
+            }
+            if (type != RECORD_LOG) continue;
+            record.offset = at;
+            record.wallNs = wallNs;
+            record.level = static_cast<LogLevel>(std::min<std::uint8_t>(levelByte, static_cast<std::uint8_t>(LogLevel::critical)));
+            record.messengerId = messengerId;
+            record.message = payload;
+            record.messenger = MessengerName(messengerId);
+            return true;
+        }
+        return false;
+    }
+
+    // Definitions precede their first use, so an id not seen yet (after a Seek) is
+    // looked up by walking the file from the last scanned point, skipping log
+    // records by their length
+    std::string_view BinaryLogReader::MessengerName(std::uint32_t id) {
+        if (id == 0) return std::string_view();
+        auto it = messengers.find(id);
+        if (it != messengers.end()) return it->second;
+        RecordHeader h;
+        std::string name;
+        char raw[RECORD_HEADER_SIZE];
+        std::uint64_t at = messengersScannedTo;
+        while (at < position) {
+            if (!ReadHeader(in, at, fileSize, h, raw)) {
+                at = FindSyncMarker(in, at + 1, fileSize);
+                continue;
+            }
+            if (h.type == RECORD_MESSENGER && ReadChecked(in, at, fileSize, h, name)) messengers[h.messengerId] = name;
+            at += RECORD_HEADER_SIZE + h.payloadLength;
+        }
+        messengersScannedTo = std::max(messengersScannedTo, at);
+        it = messengers.find(id);
+        return it != messengers.end() ? std::string_view(it->second) : std::string_view("?");
+    }
+
+    // --- Compaction -----------------------------------------------------------
+
+    bool CompactBinaryLog(const std::string& path, std::size_t maxRecords) {
+#if defined(C6_BINARY_POSIX)
+        // Writers hold a shared lock; held until the rewritten file is in place
+        struct LockGuard {
+            int fd = -1;
+            ~LockGuard() { if (fd >= 0) close(fd); }
+        } writersLock;
+        writersLock.fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (writersLock.fd >= 0 && flock(writersLock.fd, LOCK_EX | LOCK_NB) != 0) {
+            std::cerr << RED << "[ERROR] Binary log '" << path << "' is open in a writer; compact it after the writer is closed." << RESET << std::endl;
+            return false;
+        }
+#endif
+        std::ifstream in(path.c_str(), std::ios::binary);
+        std::error_code ec;
+        std::uint64_t fileSize = std::filesystem::file_size(path, ec);
+        char fileHeader[FILE_HEADER_SIZE];
+        if (!in.is_open() || ec || fileSize < FILE_HEADER_SIZE || !ReadAt(in, 0, fileHeader, FILE_HEADER_SIZE) ||
+            std::memcmp(fileHeader, BINARY_MAGIC, 4) != 0) {
+            std::cerr << RED << "[ERROR] Failed to open binary log '" << path << "' for compaction." << RESET << std::endl;
+            return false;
+        }
+
+        // Pass 1, headers only: where the kept records start, and which messenger
+        // definitions before that point they still need
+        std::deque<std::uint64_t> kept;
+        std::unordered_map<std::uint32_t, std::uint64_t> definitions;
+        RecordHeader h;
+        char raw[RECORD_HEADER_SIZE];
+        std::uint64_t at = FILE_HEADER_SIZE;
+        while (at < fileSize) {
+            if (!ReadHeader(in, at, fileSize, h, raw)) {
+                at = FindSyncMarker(in, at + 1, fileSize);
+                continue;
+            }
+            if (h.type == RECORD_LOG && maxRecords > 0) {
+                kept.push_back(at);
+                if (kept.size() > maxRecords) kept.pop_front();
+            }
+            else if (h.type == RECORD_MESSENGER) {
+                definitions[h.messengerId] = at;
+            }
+            at += RECORD_HEADER_SIZE + h.payloadLength;
+        }
+        std::uint64_t end = at <= fileSize ? at : fileSize;
+        std::uint64_t cut = kept.empty() ? end : kept.front();
+        std::unordered_set<std::uint32_t> used;
+        for (std::uint64_t offset : kept) {
+            if (ReadHeader(in, offset, fileSize, h, raw) && h.messengerId) used.insert(h.messengerId);
+        }
+
+        // Pass 2: header, sync marker, the needed definitions, then the kept tail verbatim
+        std::string tempPath = path + ".compact";
+        std::ofstream out(tempPath.c_str(), std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << RED << "[ERROR] Failed to create '" << tempPath << "'." << RESET << std::endl;
+            return false;
+        }
+        out.write(fileHeader, FILE_HEADER_SIZE);
+        std::string payload;
+        std::vector<std::pair<std::uint64_t, std::uint32_t>> needed;
+        for (const auto& definition : definitions) {
+            if (definition.second < cut && used.count(definition.first)) needed.emplace_back(definition.second, definition.first);
+        }
+        std::sort(needed.begin(), needed.end());
+        std::vector<std::uint64_t> copies; // sync marker first
+        std::uint64_t sync = FindSyncMarker(in, FILE_HEADER_SIZE, fileSize);
+        if (sync < fileSize) copies.push_back(sync);
+        for (const auto& definition : needed) copies.push_back(definition.first);
+        for (std::uint64_t offset : copies) {
+            if (!ReadChecked(in, offset, fileSize, h, payload)) continue;
+            ReadAt(in, offset, raw, RECORD_HEADER_SIZE);
+            out.write(raw, RECORD_HEADER_SIZE);
+            out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        }
+        std::vector<char> chunk(256 * 1024);
+        for (std::uint64_t offset = cut; offset < end;) {
+            std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(chunk.size(), end - offset));
+            if (!ReadAt(in, offset, chunk.data(), n)) break;
+            out.write(chunk.data(), static_cast<std::streamsize>(n));
+            offset += n;
+        }
+        out.close();
+        in.close();
+        if (out.fail()) {
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec) {
+            std::cerr << RED << "[ERROR] Failed to replace binary log '" << path << "'." << RESET << std::endl;
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+        return true;
+    }
+
+    bool IsBinaryLog(const std::string& path) {
+        std::ifstream in(path.c_str(), std::ios::binary);
+        char magic[4];
+        return in.read(magic, sizeof(magic)) && std::memcmp(magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0;
+    }
+}
@@ -0,0 +1,268 @@
+#include "../include/LogClock.h"
+#include "LogInternal.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+#define C6_HAVE_TSC 1
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#endif
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace C6Logger {
+
+    static constexpr int SOURCE_SHIFT = 62;
+    static constexpr std::uint64_t VALUE_MASK = (std::uint64_t(1) << SOURCE_SHIFT) - 1;
+
+    static std::atomic<ClockSource> activeSource{ ClockSource::System };
+    static std::atomic<std::int64_t> monotonicToWallNs{ 0 };
+    static std::atomic<int> timestampPrecision{ 0 };
+    static std::atomic<double> measuredCallNs{ 0.0 };
+
+    static std::int64_t SystemNowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    std::int64_t MonotonicNs() {
+#if defined(__unix__) || defined(__APPLE__)
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    static std::int64_t CoarseNowNs() {
+#if defined(CLOCK_REALTIME_COARSE)
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+        return static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+        return SystemNowNs();
+#endif
+    }
+
+#if defined(C6_HAVE_TSC)
+
+    static bool HasInvariantTsc() {
+        unsigned int regs[4] = {};
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0x80000000);
+        if (static_cast<unsigned int>(info[0]) < 0x80000007u) return false;
+        __cpuid(info, 0x80000007);
+        regs[3] = static_cast<unsigned int>(info[3]);
+#else
+        if (__get_cpuid_max(0x80000000u, nullptr) < 0x80000007u) return false;
+        __get_cpuid(0x80000007u, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+        return (regs[3] & (1u << 8)) != 0; // EDX bit 8: invariant TSC
+    }
+
+    // TSC -> wall conversion: wall = baseWall + (tsc - baseTsc) * nsPerTick. The ratio is
+    // measured against an origin pair taken at first calibration, so every refresh
+    // lengthens the baseline and tightens the estimate. Readers use a seqlock.
+    struct TscCalibration {
+        std::atomic<std::uint32_t> seq{ 0 };
+        std::atomic<std::uint64_t> baseTsc{ 0 };
+        std::atomic<std::int64_t> baseWallNs{ 0 };
+        std::atomic<double> nsPerTick{ 0.0 };
+        std::atomic<std::uint64_t> refreshes{ 0 };
+        std::mutex refreshMutex;
+        std::uint64_t originTsc = 0;
+        std::int64_t originWallNs = 0;
+        bool calibrated = false;
+    };
+
+    static TscCalibration tsc;
+
+    static void SampleTscWall(std::uint64_t& ticks, std::int64_t& wallNs) {
+        // Bracket the wall clock read between two TSC reads and use the midpoint
+        std::uint64_t before = __rdtsc();
+        wallNs = SystemNowNs();
+        std::uint64_t after = __rdtsc();
+        ticks = before + (after - before) / 2;
+    }
+
+    static void PublishCalibration(std::uint64_t ticks, std::int64_t wallNs, double ratio) {
+        tsc.seq.fetch_add(1, std::memory_order_acq_rel); // odd: update in progress
+        tsc.baseTsc.store(ticks, std::memory_order_relaxed);
+        tsc.baseWallNs.store(wallNs, std::memory_order_relaxed);
+        tsc.nsPerTick.store(ratio, std::memory_order_relaxed);
+        tsc.seq.fetch_add(1, std::memory_order_release);
+    }
+
+    static void CalibrateTsc() {
+        std::lock_guard<std::mutex> lock(tsc.refreshMutex);
+        if (tsc.calibrated) return;
+        std::uint64_t t0, t1;
+        std::int64_t w0, w1;
+        SampleTscWall(t0, w0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        SampleTscWall(t1, w1);
+        if (t1 <= t0) return;
+        tsc.originTsc = t0;
+        tsc.originWallNs = w0;
+        PublishCalibration(t1, w1, static_cast<double>(w1 - w0) / static_cast<double>(t1 - t0));
+        tsc.calibrated = true;
+    }
+
+    static void RefreshTsc() {
+        std::unique_lock<std::mutex> lock(tsc.refreshMutex, std::try_to_lock);
+        if (!lock.owns_lock() || !tsc.calibrated) return; // someone else is on it
+        std::uint64_t ticks;
+        std::int64_t wallNs;
+        SampleTscWall(ticks, wallNs);
+        if (ticks <= tsc.originTsc) return;
+        PublishCalibration(ticks, wallNs, static_cast<double>(wallNs - tsc.originWallNs) / static_cast<double>(ticks - tsc.originTsc));
+        tsc.refreshes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static std::int64_t TscToWallNs(std::uint64_t ticks) {
+        std::uint64_t base;
+        std::int64_t baseWall;
+        double ratio;
+        for (;;) {
+            std::uint32_t s0 = tsc.seq.load(std::memory_order_acquire);
+            base = tsc.baseTsc.load(std::memory_order_relaxed);
+            baseWall = tsc.baseWallNs.load(std::memory_order_relaxed);
+            ratio = tsc.nsPerTick.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if ((s0 & 1) == 0 && tsc.seq.load(std::memory_order_relaxed) == s0) break;
+        }
+        if (ratio <= 0.0) return SystemNowNs();
+        double delta = static_cast<double>(static_cast<std::int64_t>(ticks - (base & VALUE_MASK)));
+        // Refresh roughly once per second of TSC time
+        if (delta * ratio > 1e9) RefreshTsc();
+        return baseWall + static_cast<std::int64_t>(delta * ratio);
+    }
+
+#endif // C6_HAVE_TSC
+
+    static bool SourceAvailable(ClockSource source) {
+        switch (source) {
+        case ClockSource::RealtimeCoarse:
+#if defined(CLOCK_REALTIME_COARSE)
+            return true;
+#else
+            return false;
+#endif
+        case ClockSource::Tsc:
+#if defined(C6_HAVE_TSC)
+            return HasInvariantTsc();
+#else
+            return false;
+#endif
+        default:
+            return true;
+        }
+    }
+
+    static double MeasureCallCost() {
+        constexpr int iterations = 4096;
+        std::uint64_t sink = 0;
+        std::int64_t start = MonotonicNs();
+        for (int i = 0; i < iterations; ++i) sink += ClockNow();
+        std::int64_t elapsed = MonotonicNs() - start;
+        // Keep the loop from being optimized away
+        if (sink == 1) measuredCallNs.store(-1.0, std::memory_order_relaxed);
+        return static_cast<double>(elapsed) / iterations;
+    }
+
+    void SetClockSource(ClockSource source) {
+        if (!SourceAvailable(source)) source = ClockSource::System;
+#if defined(C6_HAVE_TSC)
+        if (source == ClockSource::Tsc) CalibrateTsc();
+#endif
+        if (source == ClockSource::Monotonic) {
+            monotonicToWallNs.store(SystemNowNs() - MonotonicNs(), std::memory_order_relaxed);
+        }
+        activeSource.store(source, std::memory_order_release);
+        measuredCallNs.store(MeasureCallCost(), std::memory_order_relaxed);
+    }
+
+    ClockSource GetClockSource() {
+        return activeSource.load(std::memory_order_acquire);
+    }
+
+    const char* ClockSourceName(ClockSource source) {
+        switch (source) {
+        case ClockSource::System: return "system_clock";
+        case ClockSource::RealtimeCoarse: return "realtime_coarse";
+        case ClockSource::Tsc: return "tsc";
+        case ClockSource::Monotonic: return "monotonic";
+        }
+        return "unknown";
+    }
+
+    std::uint64_t ClockNow() {
+        ClockSource source = activeSource.load(std::memory_order_relaxed);
+        std::uint64_t value;
+        switch (source) {
+#if defined(C6_HAVE_TSC)
+        case ClockSource::Tsc:
+            value = __rdtsc();
+            break;
+#endif
+        case ClockSource::RealtimeCoarse:
+            value = static_cast<std::uint64_t>(CoarseNowNs());
+            break;
+        case ClockSource::Monotonic:
+            value = static_cast<std::uint64_t>(MonotonicNs());
+            break;
+        default:
+            value = static_cast<std::uint64_t>(SystemNowNs());
+            break;
+        }
+        return (value & VALUE_MASK) | (static_cast<std::uint64_t>(source) << SOURCE_SHIFT);
+    }
+
+    std::int64_t ClockToWallNs(std::uint64_t stamp) {
+        auto source = static_cast<ClockSource>(stamp >> SOURCE_SHIFT);
+        std::uint64_t value = stamp & VALUE_MASK;
+        switch (source) {
+#if defined(C6_HAVE_TSC)
+        case ClockSource::Tsc:
+            return TscToWallNs(value);
+#endif
+        case ClockSource::Monotonic:
+            return static_cast<std::int64_t>(value) + monotonicToWallNs.load(std::memory_order_relaxed);
+        default:
+            return static_cast<std::int64_t>(value);
+        }
+    }
+
+    void SetTimestampPrecision(int digits) {
+        timestampPrecision.store(digits < 0 ? 0 : (digits > 9 ? 9 : digits), std::memory_order_relaxed);
+    }
+
+    int GetTimestampPrecision() {
+        return timestampPrecision.load(std::memory_order_relaxed);
+    }
+
+    void detail::FillClockStats(LoggerStats& stats) {
+        ClockSource source = GetClockSource();
+        if (measuredCallNs.load(std::memory_order_relaxed) == 0.0) {
+            measuredCallNs.store(MeasureCallCost(), std::memory_order_relaxed);
+        }
+        stats.clockSource = ClockSourceName(source);
+        stats.clockCallNs = measuredCallNs.load(std::memory_order_relaxed);
+#if defined(C6_HAVE_TSC)
+        if (source == ClockSource::Tsc) {
+            double ratio = tsc.nsPerTick.load(std::memory_order_relaxed);
+            stats.tscGhz = ratio > 0.0 ? 1.0 / ratio : 0.0;
+            stats.tscRecalibrations = tsc.refreshes.load(std::memory_order_relaxed);
+        }
+#endif
+    }
+}
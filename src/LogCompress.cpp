@@ -0,0 +1,458 @@
+#include "../include/LogCompress.h"
+#include "LogInternal.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace C6Logger {
+
+    static constexpr char FRAME_MAGIC[4] = { 'C', '6', 'L', 'Z' };
+    static constexpr char INDEX_MAGIC[4] = { 'C', '6', 'I', 'X' };
+    static constexpr std::uint8_t FRAME_VERSION = 1;
+    static constexpr std::uint32_t STORED_RAW_FLAG = 0x80000000u;
+    static constexpr std::size_t MIN_MATCH = 4;
+    static constexpr std::size_t LAST_LITERALS = 5;  // a block always ends with literals
+    static constexpr std::size_t MAX_OFFSET = 65535;
+    static constexpr int HASH_LOG = 13;
+    static constexpr int HASH_WAYS = 4;
+
+    static inline std::uint32_t Read32(const unsigned char* p) {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static inline std::uint32_t HashSequence(std::uint32_t v) {
+        return (v * 2654435761u) >> (32 - HASH_LOG);
+    }
+
+    static void Put32(char* p, std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) p[i] = static_cast<char>((v >> (8 * i)) & 0xFF);
+    }
+
+    static void Put64(char* p, std::uint64_t v) {
+        for (int i = 0; i < 8; ++i) p[i] = static_cast<char>((v >> (8 * i)) & 0xFF);
+    }
+
+    static std::uint32_t Get32(const char* p) {
+        std::uint32_t v = 0;
+        for (int i = 3; i >= 0; --i) v = (v << 8) | static_cast<unsigned char>(p[i]);
+        return v;
+    }
+
+    static std::uint64_t Get64(const char* p) {
+        std::uint64_t v = 0;
+        for (int i = 7; i >= 0; --i) v = (v << 8) | static_cast<unsigned char>(p[i]);
+        return v;
+    }
+
+    static std::uint32_t BlockChecksum(const char* data, std::size_t n) {
+        // FNV-1a, 32-bit
+        std::uint32_t h = 2166136261u;
+        for (std::size_t i = 0; i < n; ++i) {
+            h ^= static_cast<unsigned char>(data[i]);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    std::size_t CompressBound(std::size_t n) {
+        return n + n / 255 + 16;
+    }
+
+    // Writes a length continuation: runs of 255 followed by the remainder
+    static inline bool PutLength(unsigned char*& op, const unsigned char* oend, std::size_t len) {
+        while (len >= 255) {
+            if (op >= oend) return false;
+            *op++ = 255;
+            len -= 255;
+        }
+        if (op >= oend) return false;
+        *op++ = static_cast<unsigned char>(len);
+        return true;
+    }
+
+    std::size_t CompressBlock(const char* source, std::size_t srcSize, char* dest, std::size_t dstCapacity) {
+        // Greedy LZ77 over a small bucketed hash table (the newest HASH_WAYS positions per
+        // hash, longest match wins) with LZ4-style sequences:
+        // token(lit:4|match:4) [lit ext] literals u16 offset [match ext]
+        static thread_local std::uint32_t table[1u << HASH_LOG][HASH_WAYS];
+        const unsigned char* src = reinterpret_cast<const unsigned char*>(source);
+        const unsigned char* ip = src;
+        const unsigned char* anchor = src;
+        const unsigned char* const iend = src + srcSize;
+        unsigned char* op = reinterpret_cast<unsigned char*>(dest);
+        unsigned char* const oend = op + dstCapacity;
+
+        auto emit = [&](const unsigned char* litStart, std::size_t litLen, std::size_t offset, std::size_t matchLen) -> bool {
+            std::size_t ml = matchLen ? matchLen - MIN_MATCH : 0;
+            if (op >= oend) return false;
+            unsigned char* token = op++;
+            *token = static_cast<unsigned char>((std::min<std::size_t>(litLen, 15) << 4) | (matchLen ? std::min<std::size_t>(ml, 15) : 0));
+            if (litLen >= 15 && !PutLength(op, oend, litLen - 15)) return false;
+            if (static_cast<std::size_t>(oend - op) < litLen) return false;
+            std::memcpy(op, litStart, litLen);
+            op += litLen;
+            if (!matchLen) return true;
+            if (oend - op < 2) return false;
+            *op++ = static_cast<unsigned char>(offset & 0xFF);
+            *op++ = static_cast<unsigned char>(offset >> 8);
+            if (ml >= 15 && !PutLength(op, oend, ml - 15)) return false;
+            return true;
+        };
+        auto insert = [&](const unsigned char* p) {
+            std::uint32_t* bucket = table[HashSequence(Read32(p))];
+            for (int w = HASH_WAYS - 1; w > 0; --w) bucket[w] = bucket[w - 1];
+            bucket[0] = static_cast<std::uint32_t>(p - src) + 1; // 0 marks an empty way
+        };
+
+        if (srcSize > LAST_LITERALS + MIN_MATCH + 8) {
+            std::memset(table, 0, sizeof(table));
+            const unsigned char* const matchLimit = iend - LAST_LITERALS;
+            const unsigned char* const mflimit = matchLimit - MIN_MATCH;
+            while (ip < mflimit) {
+                std::uint32_t seq = Read32(ip);
+                const std::uint32_t* bucket = table[HashSequence(seq)];
+                const unsigned char* ref = nullptr;
+                std::size_t matchLen = 0;
+                for (int w = 0; w < HASH_WAYS && bucket[w]; ++w) {
+                    const unsigned char* cand = src + bucket[w] - 1;
+                    if (static_cast<std::size_t>(ip - cand) > MAX_OFFSET) break; // older ways are further away
+                    if (Read32(cand) != seq) continue;
+                    const unsigned char* mp = ip + MIN_MATCH;
+                    const unsigned char* rp = cand + MIN_MATCH;
+                    while (mp < matchLimit && *mp == *rp) {
+                        ++mp;
+                        ++rp;
+                    }
+                    std::size_t len = static_cast<std::size_t>(mp - ip);
+                    if (len > matchLen) {
+                        matchLen = len;
+                        ref = cand;
+                    }
+                }
+                insert(ip);
+                if (!ref) {
+                    // Skip faster through incompressible stretches
+                    ip += 1 + (static_cast<std::size_t>(ip - anchor) >> 6);
+                    continue;
+                }
+                while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+                    --ip;
+                    --ref;
+                    ++matchLen;
+                }
+                if (!emit(anchor, static_cast<std::size_t>(ip - anchor), static_cast<std::size_t>(ip - ref), matchLen)) return 0;
+                ip += matchLen;
+                anchor = ip;
+                if (ip < mflimit) insert(ip - 2);
+            }
+        }
+        if (!emit(anchor, static_cast<std::size_t>(iend - anchor), 0, 0)) return 0;
+        std::size_t written = static_cast<std::size_t>(op - reinterpret_cast<unsigned char*>(dest));
+        return written < srcSize ? written : 0;
+    }
+
+    bool DecompressBlock(const char* source, std::size_t srcSize, char* dest, std::size_t rawSize) {
+        const unsigned char* ip = reinterpret_cast<const unsigned char*>(source);
+        const unsigned char* const iend = ip + srcSize;
+        unsigned char* op = reinterpret_cast<unsigned char*>(dest);
+        unsigned char* const ostart = op;
+        unsigned char* const oend = op + rawSize;
+
+        auto getLength = [&](std::size_t& len) -> bool {
+            unsigned char b;
+            do {
+                if (ip >= iend) return false;
+                b = *ip++;
+                len += b;
+            } while (b == 255);
+            return true;
+        };
+
+        while (ip < iend) {
+            unsigned char token = *ip++;
+            std::size_t litLen = token >> 4;
+            if (litLen == 15 && !getLength(litLen)) return false;
+            if (static_cast<std::size_t>(iend - ip) < litLen || static_cast<std::size_t>(oend - op) < litLen) return false;
+            std::memcpy(op, ip, litLen);
+            ip += litLen;
+            op += litLen;
+            if (ip == iend) break; // last sequence carries literals only
+            if (iend - ip < 2) return false;
+            std::size_t offset = static_cast<std::size_t>(ip[0]) | (static_cast<std::size_t>(ip[1]) << 8);
+            ip += 2;
+            std::size_t matchLen = token & 15;
+            if (matchLen == 15 && !getLength(matchLen)) return false;
+            matchLen += MIN_MATCH;
+            if (offset == 0 || offset > static_cast<std::size_t>(op - ostart)) return false;
+            if (static_cast<std::size_t>(oend - op) < matchLen) return false;
+            const unsigned char* ref = op - offset;
+            if (offset >= matchLen) {
+                std::memcpy(op, ref, matchLen);
+                op += matchLen;
+            }
+            else {
+                for (std::size_t i = 0; i < matchLen; ++i) *op++ = *ref++; // overlapping run
+            }
+        }
+        return op == oend;
+    }
+
+    static int BlockSizeLog2() {
+        int log2 = 0;
+        while ((std::size_t(1) << log2) < COMPRESS_BLOCK_SIZE) ++log2;
+        return log2;
+    }
+
+    CompressedLogWriter::CompressedLogWriter(const std::string& path)
+        : out(path.c_str(), std::ios::binary | std::ios::trunc) {
+        if (!out.is_open()) return;
+        pending.reserve(COMPRESS_BLOCK_SIZE);
+        scratch.resize(CompressBound(COMPRESS_BLOCK_SIZE));
+        char header[8] = { FRAME_MAGIC[0], FRAME_MAGIC[1], FRAME_MAGIC[2], FRAME_MAGIC[3],
+            static_cast<char>(FRAME_VERSION), 0, static_cast<char>(BlockSizeLog2()), 0 };
+        out.write(header, sizeof(header));
+        storedBytes = sizeof(header);
+    }
+
+    CompressedLogWriter::~CompressedLogWriter() {
+        if (out.is_open() && !finished) Finish();
+    }
+
+    bool CompressedLogWriter::Write(std::string_view data) {
+        if (!out.is_open() || finished) return false;
+        while (!data.empty()) {
+            std::size_t take = std::min(COMPRESS_BLOCK_SIZE - pending.size(), data.size());
+            pending.insert(pending.end(), data.data(), data.data() + take);
+            data.remove_prefix(take);
+            if (pending.size() == COMPRESS_BLOCK_SIZE && !EmitBlock()) return false;
+        }
+        return true;
+    }
+
+    bool CompressedLogWriter::EmitBlock() {
+        if (pending.empty()) return true;
+        std::size_t compressed = CompressBlock(pending.data(), pending.size(), scratch.data(), scratch.size());
+        const char* payload = compressed ? scratch.data() : pending.data();
+        std::uint32_t storedSize = compressed ? static_cast<std::uint32_t>(compressed) : static_cast<std::uint32_t>(pending.size());
+        char header[12];
+        Put32(header, static_cast<std::uint32_t>(pending.size()));
+        Put32(header + 4, compressed ? storedSize : (storedSize | STORED_RAW_FLAG));
+        Put32(header + 8, BlockChecksum(pending.data(), pending.size()));
+        index.push_back(rawBytes);
+        index.push_back(storedBytes);
+        out.write(header, sizeof(header));
+        out.write(payload, storedSize);
+        rawBytes += pending.size();
+        storedBytes += sizeof(header) + storedSize;
+        pending.clear();
+        return static_cast<bool>(out);
+    }
+
+    bool CompressedLogWriter::Finish() {
+        if (!out.is_open() || finished) return false;
+        finished = true;
+        if (!EmitBlock()) return false;
+        char endMarker[8] = {};
+        out.write(endMarker, sizeof(endMarker));
+        std::uint64_t indexOffset = storedBytes + sizeof(endMarker);
+        char entry[8];
+        for (std::uint64_t v : index) {
+            Put64(entry, v);
+            out.write(entry, sizeof(entry));
+        }
+        char footer[16];
+        Put64(footer, indexOffset);
+        Put32(footer + 8, static_cast<std::uint32_t>(index.size() / 2));
+        std::memcpy(footer + 12, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        out.write(footer, sizeof(footer));
+        storedBytes = indexOffset + index.size() * sizeof(std::uint64_t) + sizeof(footer);
+        out.close();
+        return !out.fail();
+    }
+
+    CompressedLogReader::CompressedLogReader(const std::string& path)
+        : in(path.c_str(), std::ios::binary) {
+        if (!in.is_open()) return;
+        char header[8];
+        if (!in.read(header, sizeof(header))) return;
+        if (std::memcmp(header, FRAME_MAGIC, sizeof(FRAME_MAGIC)) != 0) return;
+        if (static_cast<std::uint8_t>(header[4]) != FRAME_VERSION) return;
+        if (static_cast<unsigned char>(header[6]) > 30) return;
+        valid = true;
+        LoadIndex();
+        in.clear();
+        in.seekg(sizeof(header));
+    }
+
+    bool CompressedLogReader::LoadIndex() {
+        char footer[16];
+        in.seekg(0, std::ios::end);
+        std::streamoff size = in.tellg();
+        if (size < static_cast<std::streamoff>(8 + 8 + sizeof(footer))) return false;
+        in.seekg(size - static_cast<std::streamoff>(sizeof(footer)));
+        if (!in.read(footer, sizeof(footer))) return false;
+        if (std::memcmp(footer + 12, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) return false;
+        std::uint64_t indexOffset = Get64(footer);
+        std::uint32_t blocks = Get32(footer + 8);
+        if (indexOffset + std::uint64_t(blocks) * 16 + sizeof(footer) != static_cast<std::uint64_t>(size)) return false;
+        std::vector<char> raw(static_cast<std::size_t>(blocks) * 16);
+        in.seekg(static_cast<std::streamoff>(indexOffset));
+        if (!raw.empty() && !in.read(raw.data(), static_cast<std::streamsize>(raw.size()))) return false;
+        blockRawOffsets.resize(blocks);
+        blockFileOffsets.resize(blocks);
+        for (std::uint32_t i = 0; i < blocks; ++i) {
+            blockRawOffsets[i] = Get64(raw.data() + i * 16);
+            blockFileOffsets[i] = Get64(raw.data() + i * 16 + 8);
+        }
+        return true;
+    }
+
+    bool CompressedLogReader::NextBlock(std::string_view& data) {
+        if (!valid) return false;
+        char header[12];
+        if (!in.read(header, sizeof(header))) return false;
+        std::uint32_t rawSize = Get32(header);
+        std::uint32_t stored = Get32(header + 4);
+        if (rawSize == 0 && stored == 0) return false; // end marker
+        bool isRaw = (stored & STORED_RAW_FLAG) != 0;
+        std::uint32_t storedSize = stored & ~STORED_RAW_FLAG;
+        if (rawSize > COMPRESS_BLOCK_SIZE * 4 || storedSize > CompressBound(rawSize)) return false;
+        payload.resize(storedSize);
+        if (!in.read(payload.data(), storedSize)) return false;
+        block.resize(rawSize);
+        if (isRaw) {
+            if (storedSize != rawSize) return false;
+            std::memcpy(block.data(), payload.data(), rawSize);
+        }
+        else if (!DecompressBlock(payload.data(), storedSize, block.data(), rawSize)) {
+            return false;
+        }
+        if (BlockChecksum(block.data(), rawSize) != Get32(header + 8)) return false;
+        data = std::string_view(block.data(), rawSize);
+        return true;
+    }
+
+    bool CompressedLogReader::SeekToRawOffset(std::uint64_t rawOffset, std::size_t& skipInBlock) {
+        if (!valid || blockRawOffsets.empty()) return false;
+        auto it = std::upper_bound(blockRawOffsets.begin(), blockRawOffsets.end(), rawOffset);
+        if (it == blockRawOffsets.begin()) return false;
+        std::size_t blockIndex = static_cast<std::size_t>(it - blockRawOffsets.begin()) - 1;
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(blockFileOffsets[blockIndex]));
+        skipInBlock = static_cast<std::size_t>(rawOffset - blockRawOffsets[blockIndex]);
+        return static_cast<bool>(in);
+    }
+
+    bool CompressFile(const std::string& inPath, const std::string& outPath) {
+        std::ifstream in(inPath.c_str(), std::ios::binary);
+        if (!in.is_open()) return false;
+        CompressedLogWriter writer(outPath);
+        if (!writer.IsOpen()) return false;
+        std::vector<char> chunk(COMPRESS_BLOCK_SIZE);
+        while (in) {
+            in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            std::streamsize got = in.gcount();
+            if (got <= 0) break;
+            if (!writer.Write(std::string_view(chunk.data(), static_cast<std::size_t>(got)))) return false;
+        }
+        if (in.bad()) return false;
+        return writer.Finish();
+    }
+
+    bool IsCompressedLog(const std::string& path) {
+        std::ifstream in(path.c_str(), std::ios::binary);
+        char magic[4];
+        return in.read(magic, sizeof(magic)) && std::memcmp(magic, FRAME_MAGIC, sizeof(FRAME_MAGIC)) == 0;
+    }
+
+    // Single background thread that compresses sealed segments off the Log() path
+    class SegmentCompressionWorker {
+    public:
+        ~SegmentCompressionWorker() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            if (worker.joinable()) worker.join();
+        }
+
+        void Enqueue(const std::string& path) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                queue.push_back(path);
+                if (!worker.joinable()) worker = std::thread([this] { Run(); });
+            }
+            wake.notify_all();
+        }
+
+        void WaitIdle() {
+            std::unique_lock<std::mutex> lock(mutex);
+            idle.wait(lock, [this] { return queue.empty() && !busy; });
+        }
+
+    private:
+        void Run() {
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;) {
+                wake.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty()) return; // stopping and drained
+                std::string path = std::move(queue.front());
+                queue.pop_front();
+                busy = true;
+                lock.unlock();
+                CompressOne(path);
+                lock.lock();
+                busy = false;
+                if (queue.empty()) idle.notify_all();
+            }
+        }
+
+        static void CompressOne(const std::string& plainPath) {
+            std::filesystem::path target(plainPath);
+            target.replace_extension(".c6z");
+            std::string tmp = target.string() + ".tmp";
+            std::error_code ec;
+            if (!CompressFile(plainPath, tmp)) {
+                std::filesystem::remove(tmp, ec);
+                std::cerr << RED << "[ERROR] Failed to compress log segment '" << plainPath << "'." << RESET << std::endl;
+                return;
+            }
+            std::filesystem::rename(tmp, target, ec);
+            if (ec) {
+                std::filesystem::remove(tmp, ec);
+                return;
+            }
+            std::filesystem::remove(plainPath, ec);
+        }
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable idle;
+        std::deque<std::string> queue;
+        std::thread worker;
+        bool stopping = false;
+        bool busy = false;
+    };
+
+    static SegmentCompressionWorker& CompressionWorker() {
+        static SegmentCompressionWorker worker;
+        return worker;
+    }
+
+    void CompressSegmentAsync(const std::string& plainPath) {
+        CompressionWorker().Enqueue(plainPath);
+    }
+
+    void WaitForSegmentCompression() {
+        CompressionWorker().WaitIdle();
+    }
+}
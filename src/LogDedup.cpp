@@ -0,0 +1,254 @@
+#include "../include/Logger.h"
+#include "LogInternal.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define C6_DEDUP_POSIX 1
+#endif
+#include <cstring>
+#include <unordered_map>
+
+namespace C6Logger {
+
+    std::uint64_t detail::DedupIndex::HashKey(std::string_view key) {
+        // FNV-1a: stable across builds, since the hashes are stored in the sidecar
+        std::uint64_t hash = 1469598103934665603ull;
+        for (char c : key) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+#if defined(C6_DEDUP_POSIX)
+
+    // Sidecar layout: the header, then one Entry per line in file order. New entries
+    // are written before the header that counts them, so a crash in between leaves a
+    // header whose fingerprint no longer matches the log, and the next start rebuilds.
+    struct DedupFingerprint {
+        std::uint64_t size = 0;
+        std::int64_t mtimeNs = 0;
+        std::uint64_t inode = 0;
+
+        bool operator==(const DedupFingerprint& other) const {
+            return size == other.size && mtimeNs == other.mtimeNs && inode == other.inode;
+        }
+    };
+
+    struct DedupHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t entrySize;
+        DedupFingerprint log;
+        std::uint64_t entryCount;
+    };
+
+    static constexpr char DEDUP_MAGIC[8] = { 'C', '6', 'D', 'E', 'D', 'U', 'P', '\0' };
+    static constexpr std::uint32_t DEDUP_VERSION = 1;
+
+    static bool StatLog(const std::string& logPath, DedupFingerprint& out) {
+        struct stat sb;
+        if (stat(logPath.c_str(), &sb) != 0) return false;
+        out.size = static_cast<std::uint64_t>(sb.st_size);
+#if defined(__APPLE__)
+        out.mtimeNs = static_cast<std::int64_t>(sb.st_mtimespec.tv_sec) * 1000000000 + sb.st_mtimespec.tv_nsec;
+#else
+        out.mtimeNs = static_cast<std::int64_t>(sb.st_mtim.tv_sec) * 1000000000 + sb.st_mtim.tv_nsec;
+#endif
+        out.inode = static_cast<std::uint64_t>(sb.st_ino);
+        return true;
+    }
+
+    class detail::DedupIndex::State {
+    public:
+        ~State() {
+            CloseSidecar();
+        }
+
+        bool Attach(const std::string& logPath) {
+            DedupFingerprint now;
+            if (!StatLog(logPath, now)) {
+                Invalidate();
+                return false;
+            }
+            if (valid && logPath == path && now == log) return true;
+            Invalidate();
+            return Load(logPath, now);
+        }
+
+        void Reset(const std::string& logPath, std::vector<Entry> lines) {
+            Invalidate();
+            if (!StatLog(logPath, log)) return;
+            path = logPath;
+            entries = std::move(lines);
+            for (std::size_t i = 0; i < entries.size(); ++i) byHash[entries[i].keyHash] = i;
+            if (!OpenSidecar(O_CREAT | O_TRUNC)) return;
+            std::size_t bytes = entries.size() * sizeof(Entry);
+            if (bytes && pwrite(fd, entries.data(), bytes, sizeof(DedupHeader)) != static_cast<ssize_t>(bytes)) {
+                CloseSidecar();
+                return;
+            }
+            valid = WriteHeader();
+        }
+
+        void Invalidate() {
+            valid = false;
+            entries.clear();
+            byHash.clear();
+        }
+
+        bool Contains(std::uint64_t keyHash) const {
+            return byHash.find(keyHash) != byHash.end();
+        }
+
+        std::size_t Size() const { return entries.size(); }
+        std::uint64_t FileSize() const { return log.size; }
+        const Entry* Last() const { return entries.empty() ? nullptr : &entries.back(); }
+
+        void Append(const Entry& entry) {
+            if (!valid) return;
+            byHash[entry.keyHash] = entries.size();
+            entries.push_back(entry);
+            off_t at = static_cast<off_t>(sizeof(DedupHeader) + (entries.size() - 1) * sizeof(Entry));
+            valid = pwrite(fd, &entry, sizeof(entry), at) == static_cast<ssize_t>(sizeof(entry)) && Refresh();
+            if (!valid) Invalidate();
+        }
+
+        void UpdateLast(std::uint64_t count, std::uint64_t length) {
+            if (!valid || entries.empty()) return;
+            Entry& last = entries.back();
+            last.count = count;
+            last.length = length;
+            off_t at = static_cast<off_t>(sizeof(DedupHeader) + (entries.size() - 1) * sizeof(Entry));
+            valid = pwrite(fd, &last, sizeof(last), at) == static_cast<ssize_t>(sizeof(last)) && Refresh();
+            if (!valid) Invalidate();
+        }
+
+    private:
+        // Maps the sidecar and takes its entries if its fingerprint matches the log
+        bool Load(const std::string& logPath, const DedupFingerprint& now) {
+            path = logPath;
+            if (!OpenSidecar(0)) return false;
+            struct stat sb;
+            if (fstat(fd, &sb) != 0 || static_cast<std::size_t>(sb.st_size) < sizeof(DedupHeader)) return false;
+            std::size_t size = static_cast<std::size_t>(sb.st_size);
+            void* map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (map == MAP_FAILED) return false;
+            DedupHeader header;
+            std::memcpy(&header, map, sizeof(header));
+            bool usable = std::memcmp(header.magic, DEDUP_MAGIC, sizeof(DEDUP_MAGIC)) == 0 &&
+                header.version == DEDUP_VERSION && header.entrySize == sizeof(Entry) && header.log == now &&
+                header.entryCount <= (size - sizeof(DedupHeader)) / sizeof(Entry);
+            if (usable) {
+                const char* first = static_cast<const char*>(map) + sizeof(DedupHeader);
+                entries.resize(static_cast<std::size_t>(header.entryCount));
+                if (!entries.empty()) std::memcpy(entries.data(), first, entries.size() * sizeof(Entry));
+                for (std::size_t i = 0; i < entries.size(); ++i) byHash[entries[i].keyHash] = i;
+                log = now;
+                valid = true;
+            }
+            munmap(map, size);
+            return usable;
+        }
+
+        bool OpenSidecar(int extraFlags) {
+            std::string sidecar = path + ".dedup";
+            if (fd >= 0 && sidecar == fdPath && extraFlags == 0) return true;
+            CloseSidecar();
+            fd = open(sidecar.c_str(), O_RDWR | O_CLOEXEC | extraFlags, 0644);
+            if (fd < 0) return false;
+            fdPath = sidecar;
+            return true;
+        }
+
+        void CloseSidecar() {
+            if (fd >= 0) close(fd);
+            fd = -1;
+            fdPath.clear();
+        }
+
+        // Takes the log's new fingerprint after our own write and records it
+        bool Refresh() {
+            return StatLog(path, log) && WriteHeader();
+        }
+
+        bool WriteHeader() {
+            DedupHeader header{};
+            std::memcpy(header.magic, DEDUP_MAGIC, sizeof(DEDUP_MAGIC));
+            header.version = DEDUP_VERSION;
+            header.entrySize = sizeof(Entry);
+            header.log = log;
+            header.entryCount = entries.size();
+            return pwrite(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+        }
+
+        bool valid = false;
+        std::string path;
+        DedupFingerprint log;
+        std::vector<Entry> entries;
+        std::unordered_map<std::uint64_t, std::size_t> byHash;
+        int fd = -1;
+        std::string fdPath;
+    };
+
+#else
+
+    // No sidecar: every compacting write takes the full path
+    class detail::DedupIndex::State {
+    public:
+        bool Attach(const std::string&) { return false; }
+        void Reset(const std::string&, std::vector<Entry>) {}
+        void Invalidate() {}
+        bool Contains(std::uint64_t) const { return false; }
+        std::size_t Size() const { return 0; }
+        std::uint64_t FileSize() const { return 0; }
+        const Entry* Last() const { return nullptr; }
+        void Append(const Entry&) {}
+        void UpdateLast(std::uint64_t, std::uint64_t) {}
+    };
+
+#endif
+
+    detail::DedupIndex::DedupIndex() : state(std::make_unique<State>()) {}
+
+    detail::DedupIndex::~DedupIndex() = default;
+
+    bool detail::DedupIndex::Attach(const std::string& logPath) {
+        return state->Attach(logPath);
+    }
+
+    void detail::DedupIndex::Reset(const std::string& logPath, std::vector<Entry> entries) {
+        state->Reset(logPath, std::move(entries));
+    }
+
+    void detail::DedupIndex::Invalidate() {
+        state->Invalidate();
+    }
+
+    bool detail::DedupIndex::Contains(std::uint64_t keyHash) const {
+        return state->Contains(keyHash);
+    }
+
+    std::size_t detail::DedupIndex::Size() const {
+        return state->Size();
+    }
+
+    std::uint64_t detail::DedupIndex::FileSize() const {
+        return state->FileSize();
+    }
+
+    const detail::DedupIndex::Entry* detail::DedupIndex::Last() const {
+        return state->Last();
+    }
+
+    void detail::DedupIndex::Append(const Entry& entry) {
+        state->Append(entry);
+    }
+
+    void detail::DedupIndex::UpdateLast(std::uint64_t count, std::uint64_t length) {
+        state->UpdateLast(count, length);
+    }
+}
@@ -0,0 +1,272 @@
+#include "../include/Logger.h"
+#include "../include/LogClock.h"
+#include "LogInternal.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define C6_DURABILITY_POSIX 1
+#endif
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace C6Logger {
+
+    // Owns a read-only descriptor on the log file used only for fdatasync. Data written
+    // through any other descriptor of the same inode is covered by syncing this one;
+    // the descriptor follows the path when rotation or compaction swaps the file.
+    class detail::DurabilitySyncer::State {
+    public:
+        ~State() {
+            StopThread();
+            {
+                std::lock_guard<std::mutex> lock(asyncMutex);
+                asyncStopping = true;
+            }
+            asyncWake.notify_all();
+            if (asyncWorker.joinable()) asyncWorker.join();
+#if defined(C6_DURABILITY_POSIX)
+            if (fd >= 0) close(fd);
+#endif
+        }
+
+        void SetPolicy(const DurabilityPolicy& newPolicy) {
+            StopThread();
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                policy = newPolicy;
+                if (policy.intervalMs < 1) policy.intervalMs = 1;
+                if (policy.byteThreshold < 1) policy.byteThreshold = 1;
+                policyThreshold.store(policy.byteThreshold, std::memory_order_relaxed);
+                mode.store(policy.mode, std::memory_order_release);
+            }
+            if (newPolicy.mode == DurabilityMode::Periodic || newPolicy.mode == DurabilityMode::EveryNBytes) {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                stopping = false;
+                worker = std::thread([this] { Run(); });
+            }
+        }
+
+        DurabilityPolicy Policy() {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            return policy;
+        }
+
+        bool SyncsOn(LogLevel level) const {
+            return (level == LogLevel::error || level == LogLevel::critical) &&
+                mode.load(std::memory_order_acquire) == DurabilityMode::SyncOnError;
+        }
+
+        void AfterWrite(const std::string& logPath, LogLevel level, std::size_t bytes) {
+            DurabilityMode current = mode.load(std::memory_order_acquire);
+            if (current == DurabilityMode::None) return;
+            std::uint64_t pending = bytesSinceSync.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+            if (current == DurabilityMode::SyncOnError) {
+                if (level == LogLevel::error || level == LogLevel::critical) GroupCommit(logPath);
+                return;
+            }
+            if (current == DurabilityMode::EveryNBytes && pending >= policyThreshold.load(std::memory_order_relaxed)) {
+                {
+                    std::lock_guard<std::mutex> lock(stateMutex);
+                    syncPath = logPath;
+                    syncRequested = true;
+                }
+                wake.notify_one();
+            }
+            else if (current == DurabilityMode::Periodic) {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                if (syncPath.empty()) syncPath = logPath;
+            }
+        }
+
+        void SyncAsync(const std::string& logPath, std::function<void()> done) {
+            {
+                std::lock_guard<std::mutex> lock(asyncMutex);
+                asyncRequests.emplace_back(logPath, std::move(done));
+                if (!asyncWorker.joinable()) asyncWorker = std::thread([this] { RunAsync(); });
+            }
+            asyncWake.notify_one();
+        }
+
+        void FillStats(LoggerStats& stats) {
+            stats.syncCount = syncCount.load(std::memory_order_relaxed);
+            stats.syncTotalNs = syncTotalNs.load(std::memory_order_relaxed);
+            stats.syncMaxNs = syncMaxNs.load(std::memory_order_relaxed);
+            stats.syncWaiters = syncWaiters.load(std::memory_order_relaxed);
+            stats.syncMaxGroup = syncMaxGroup.load(std::memory_order_relaxed);
+        }
+
+    private:
+        // Error/critical writers wait for a sync that started after their write.
+        // The first waiter to find no sync in flight becomes leader and syncs on
+        // behalf of every request queued so far; later arrivals form the next group.
+        void GroupCommit(const std::string& logPath) {
+            std::unique_lock<std::mutex> lock(commitMutex);
+            std::uint64_t ticket = ++requested;
+            syncWaiters.fetch_add(1, std::memory_order_relaxed);
+            while (completed < ticket) {
+                if (syncing) {
+                    committed.wait(lock);
+                    continue;
+                }
+                syncing = true;
+                std::uint64_t target = requested;
+                std::uint64_t group = target - completed;
+                lock.unlock();
+                SyncNow(logPath);
+                lock.lock();
+                completed = target;
+                syncing = false;
+                std::uint64_t maxGroup = syncMaxGroup.load(std::memory_order_relaxed);
+                while (group > maxGroup && !syncMaxGroup.compare_exchange_weak(maxGroup, group)) {}
+                committed.notify_all();
+            }
+        }
+
+        void SyncNow(const std::string& logPath) {
+            std::lock_guard<std::mutex> lock(fdMutex);
+            bytesSinceSync.store(0, std::memory_order_relaxed);
+            std::int64_t start = MonotonicNs();
+#if defined(C6_DURABILITY_POSIX)
+            struct stat st;
+            bool stale = fd < 0 || fdPath != logPath ||
+                (stat(logPath.c_str(), &st) == 0 && (static_cast<std::uint64_t>(st.st_ino) != fdInode));
+            if (stale) {
+                if (fd >= 0) close(fd);
+                fd = open(logPath.c_str(), O_RDONLY | O_CLOEXEC);
+                fdPath = logPath;
+                struct stat opened;
+                fdInode = (fd >= 0 && fstat(fd, &opened) == 0) ? static_cast<std::uint64_t>(opened.st_ino) : 0;
+            }
+            if (fd < 0) return;
+#if defined(__APPLE__)
+            fsync(fd);
+#else
+            fdatasync(fd);
+#endif
+#endif
+            std::uint64_t elapsed = static_cast<std::uint64_t>(MonotonicNs() - start);
+            syncCount.fetch_add(1, std::memory_order_relaxed);
+            syncTotalNs.fetch_add(elapsed, std::memory_order_relaxed);
+            std::uint64_t maxNs = syncMaxNs.load(std::memory_order_relaxed);
+            while (elapsed > maxNs && !syncMaxNs.compare_exchange_weak(maxNs, elapsed)) {}
+        }
+
+        void Run() {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            while (!stopping) {
+                if (policy.mode == DurabilityMode::Periodic) {
+                    wake.wait_for(lock, std::chrono::milliseconds(policy.intervalMs), [this] { return stopping; });
+                }
+                else {
+                    wake.wait(lock, [this] { return stopping || syncRequested; });
+                }
+                syncRequested = false;
+                if (bytesSinceSync.load(std::memory_order_relaxed) == 0 || syncPath.empty()) continue;
+                std::string path = syncPath;
+                lock.unlock();
+                SyncNow(path);
+                lock.lock();
+            }
+        }
+
+        // Serves SyncAsync(): requests queued while a sync runs share the next one
+        void RunAsync() {
+            std::unique_lock<std::mutex> lock(asyncMutex);
+            for (;;) {
+                asyncWake.wait(lock, [this] { return asyncStopping || !asyncRequests.empty(); });
+                if (asyncRequests.empty()) return;
+                std::vector<std::pair<std::string, std::function<void()>>> requests;
+                requests.swap(asyncRequests);
+                lock.unlock();
+                std::string synced;
+                for (auto& request : requests) {
+                    if (request.first != synced) {
+                        SyncNow(request.first);
+                        synced = request.first;
+                    }
+                }
+                for (auto& request : requests) {
+                    if (request.second) request.second();
+                }
+                lock.lock();
+            }
+        }
+
+        void StopThread() {
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            if (worker.joinable()) worker.join();
+        }
+
+        std::atomic<DurabilityMode> mode{ DurabilityMode::None };
+        std::atomic<std::uint64_t> bytesSinceSync{ 0 };
+        std::atomic<std::uint64_t> policyThreshold{ ~0ull };
+
+        std::mutex stateMutex;
+        std::condition_variable wake;
+        DurabilityPolicy policy;
+        std::thread worker;
+        std::string syncPath;
+        bool stopping = false;
+        bool syncRequested = false;
+
+        std::mutex commitMutex;
+        std::condition_variable committed;
+        std::uint64_t requested = 0;
+        std::uint64_t completed = 0;
+        bool syncing = false;
+
+        std::mutex asyncMutex;
+        std::condition_variable asyncWake;
+        std::vector<std::pair<std::string, std::function<void()>>> asyncRequests;
+        std::thread asyncWorker;
+        bool asyncStopping = false;
+
+        std::mutex fdMutex;
+        int fd = -1;
+        std::string fdPath;
+        std::uint64_t fdInode = 0;
+
+        std::atomic<std::uint64_t> syncCount{ 0 };
+        std::atomic<std::uint64_t> syncTotalNs{ 0 };
+        std::atomic<std::uint64_t> syncMaxNs{ 0 };
+        std::atomic<std::uint64_t> syncWaiters{ 0 };
+        std::atomic<std::uint64_t> syncMaxGroup{ 0 };
+    };
+
+    detail::DurabilitySyncer::DurabilitySyncer() : state(std::make_unique<State>()) {}
+
+    detail::DurabilitySyncer::~DurabilitySyncer() = default;
+
+    void detail::DurabilitySyncer::SetPolicy(const DurabilityPolicy& policy) {
+        state->SetPolicy(policy);
+    }
+
+    DurabilityPolicy detail::DurabilitySyncer::Policy() {
+        return state->Policy();
+    }
+
+    bool detail::DurabilitySyncer::SyncsOn(LogLevel level) const {
+        return state->SyncsOn(level);
+    }
+
+    void detail::DurabilitySyncer::AfterWrite(const std::string& logPath, LogLevel level, std::size_t bytes) {
+        state->AfterWrite(logPath, level, bytes);
+    }
+
+    void detail::DurabilitySyncer::SyncAsync(const std::string& logPath, std::function<void()> done) {
+        state->SyncAsync(logPath, std::move(done));
+    }
+
+    void detail::DurabilitySyncer::FillStats(LoggerStats& stats) {
+        state->FillStats(stats);
+    }
+}
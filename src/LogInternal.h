@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../include/Logger.h"
+#include "../include/LogLayout.h"
+
+// Define ANSI color codes for terminal output
+#define GREEN      "\033[32m"
+#define YELLOW     "\033[33m"
+#define BLUE       "\033[34m"
+#define GRAY       "\033[90m"
+#define RED        "\033[31m"
+#define BRIGHT_RED "\033[91m"
+#define RESET      "\033[0m"
+
+// Helpers shared between the logger translation units. Not part of the public API.
+namespace C6Logger {
+    namespace detail {
+        // Per-thread buffer that keeps its capacity between calls; Tag tells the buffers of
+        // different call sites apart. Unlike a plain thread_local std::string it stays usable
+        // once the thread's thread_local destructors have run, which on the main thread is
+        // before the static destructors that may still log: a buffer requested after that
+        // point is left to the exiting thread instead of being freed.
+        template <typename T, typename Tag>
+        T& ThreadScratch() {
+            static thread_local T* buffer = nullptr;
+            static thread_local bool tornDown = false;
+            struct Owner {
+                ~Owner() {
+                    delete buffer;
+                    buffer = nullptr;
+                    tornDown = true;
+                }
+            };
+            if (!buffer) {
+                buffer = new T();
+                if (!tornDown) {
+                    static thread_local Owner owner;
+                    (void)owner;
+                }
+            }
+            return *buffer;
+        }
+
+        // Parses a trailing " (repeated N times)" suffix written by log compaction. N may
+        // be padded with leading spaces (counts updated in place are fixed-width).
+        bool TryParseRepeatSuffix(std::string_view s, std::size_t& outCount, std::size_t& suffixStartPos);
+
+        // Runs log compaction (dedup + trim to maxLines) over the lines read from 'in'.
+        // Returns false if there were no lines.
+        bool CompactLogText(std::istream& in, std::size_t maxLines, std::string& compacted);
+
+        // Shared O_APPEND writer for one log path; lives until exit
+        struct Appender;
+        Appender* GetAppender(const std::string& logPath);
+
+        // Compacting-mode state shared by every Logger in this process that writes one
+        // path. Each file operation runs under 'mutex' and bumps 'changes', so a logger
+        // can tell that another one rewrote the file since its own last operation.
+        struct PathFile {
+            std::mutex mutex;
+            std::uint64_t changes = 0;   // guarded by mutex
+        };
+        PathFile& GetPathFile(Appender* appender);
+
+        // Writes one record with a single write() on the appender's descriptor,
+        // splitting records over ATOMIC_RECORD_LIMIT into fragment lines that repeat
+        // the first headerLength bytes of the line.
+        bool AppendRecordAtomic(Appender* appender, std::string_view line, std::size_t headerLength);
+
+        // Cuts a line into pieces of at most recordLimit bytes, each a self-contained
+        // "[part k/n pid-id] " line that repeats the first headerLength bytes, and hands
+        // them to 'emit' in order. Stops early and returns false when emit does.
+        bool SplitIntoFragments(std::string_view line, std::size_t headerLength, std::size_t recordLimit,
+            const std::function<bool(std::string& fragment)>& emit);
+
+        // CompactLogFile() for an arbitrary log path
+        bool CompactLogFileAt(const std::string& logPath, std::size_t maxLines);
+
+        // Renames an AtomicAppend log to 'sealedPath' and moves every appender, in any
+        // process, on to a fresh file. Returns once records still in flight to the old
+        // file have landed in it, so the sealed file can be compressed.
+        bool SealLogFileAt(const std::string& logPath, const std::string& sealedPath);
+
+        // Appends newline-terminated lines to the default logger's file under its lock and
+        // compacts once. headerLengths holds each line's header length, in order. maxLevel
+        // is the most severe level among the lines, for the durability policy.
+        void AppendLogText(std::string_view text, const std::vector<std::size_t>& headerLengths, LogLevel maxLevel);
+
+        // Durability policy state of one Logger
+        class DurabilitySyncer {
+        public:
+            DurabilitySyncer();
+            ~DurabilitySyncer();
+
+            void SetPolicy(const DurabilityPolicy& policy);
+            DurabilityPolicy Policy();
+            // True if a line at 'level' must be synced before its call returns
+            bool SyncsOn(LogLevel level) const;
+
+            // Applies the policy after 'bytes' were written to logPath. Must be called
+            // without the logger's lock held: SyncOnError blocks on fdatasync.
+            void AfterWrite(const std::string& logPath, LogLevel level, std::size_t bytes);
+
+            // Syncs logPath on the syncer's own thread, then calls 'done' there
+            void SyncAsync(const std::string& logPath, std::function<void()> done);
+
+            // Adds fdatasync counts, latency and group-commit sizes to the stats
+            void FillStats(LoggerStats& stats);
+
+        private:
+            class State;
+            std::unique_ptr<State> state;
+        };
+
+        // Dedup state of a compacting log: one entry per line (hash of its compaction key,
+        // repeat count, position), mirrored to "<log>.dedup" together with the log's size,
+        // mtime and inode, so a restarted logger can skip parsing the log (LogDedup.cpp).
+        // The owning logger's lock guards it.
+        class DedupIndex {
+        public:
+            struct Entry {
+                std::uint64_t keyHash;
+                std::uint64_t count;
+                std::uint64_t offset;
+                std::uint64_t length;   // including the newline
+            };
+
+            DedupIndex();
+            ~DedupIndex();
+
+            static std::uint64_t HashKey(std::string_view key);
+
+            // True if the state describes logPath as it is on disk now; maps the sidecar
+            // when the state in memory is stale. False means a compaction must rebuild it.
+            bool Attach(const std::string& logPath);
+            // After compaction rewrote logPath with these lines; rewrites the sidecar
+            void Reset(const std::string& logPath, std::vector<Entry> entries);
+            void Invalidate();
+
+            bool Contains(std::uint64_t keyHash) const;
+            std::size_t Size() const;
+            std::uint64_t FileSize() const;
+            const Entry* Last() const;   // nullptr if empty
+
+            // After the logger appended a new line, or rewrote the last one in place
+            void Append(const Entry& entry);
+            void UpdateLast(std::uint64_t count, std::uint64_t length);
+
+        private:
+            class State;
+            std::unique_ptr<State> state;
+        };
+
+        // Appends a raw clock stamp as "YYYY-MM-DD HH:MM:SS[.fraction]" (LogLayout.cpp)
+        void AppendTimestamp(std::string& out, std::uint64_t stamp);
+
+        // Lines merged from all shards in timestamp order, newline-terminated in 'text'.
+        // A messenger the layout did not render is kept in 'messengers' instead.
+        struct ShardBatch {
+            struct Line {
+                std::size_t offset;
+                std::size_t length;
+                std::size_t headerLength;
+                std::size_t messageLength;
+                std::size_t messengerOffset;   // into the line, or into 'messengers'
+                std::size_t messengerLength;
+                bool messengerInLine;
+                std::int64_t wallNs;
+                LogLevel level;
+            };
+            std::string text;
+            std::string messengers;
+            std::vector<Line> lines;
+            LogLevel maxLevel = LogLevel::trace;
+        };
+
+        // Per-CPU buffers for a sharded Logger, drained by a merger thread that hands
+        // timestamp-ordered batches to 'deliver' (LogShards.cpp)
+        class ShardedQueue {
+        public:
+            using Deliver = std::function<void(const ShardBatch& batch)>;
+
+            ShardedQueue(std::size_t shardCount, int mergeIntervalMs, Deliver deliver);
+            ~ShardedQueue(); // delivers everything still buffered
+
+            void Enqueue(const LogLayout& layout, LogLevel level, std::string_view message, std::string_view messenger,
+                std::string_view location = std::string_view(), std::string_view messengerPrefix = std::string_view());
+            // Returns false instead of waiting when the caller's shard is full
+            bool TryEnqueue(const LogLayout& layout, LogLevel level, std::string_view message, std::string_view messenger,
+                std::string_view location = std::string_view(), std::string_view messengerPrefix = std::string_view());
+            // Stamps the line now; the merger runs 'produce' and formats it when it is emitted
+            void EnqueueDeferred(const LogLayout& layout, LogLevel level, MessageProducer produce, std::string_view messenger);
+            // Every line of the batch under one shard lock and one stamp; the merger emits them together
+            void EnqueueBatch(const LogLayout& layout, const LogBatch& lines);
+            void Flush();   // returns once everything enqueued before the call was delivered
+            // Calls 'done' on the merger thread once everything enqueued before the call was delivered
+            void FlushAsync(std::function<void()> done);
+            std::uint64_t Stalls() const;
+
+        private:
+            class State;
+            std::unique_ptr<State> state;
+        };
+
+        // Adds the number of preallocated extents to the stats
+        void FillAppendStats(LoggerStats& stats);
+
+        // Adds the clock source, its measured cost and TSC calibration state to the stats
+        void FillClockStats(LoggerStats& stats);
+
+        // Hands a formatted line to the shared-memory ring when this process is a ring
+        // producer. Returns false if it is not, and the caller writes the file itself.
+        bool PublishToSharedRing(LogLevel level, std::string_view line, std::size_t headerLength);
+
+        // One line of newline-terminated text built by Logger::Log(const LogBatch&)
+        struct TextLine {
+            std::size_t offset;
+            std::size_t headerLength;
+            LogLevel level;
+        };
+
+        // Publishes the lines of a batch as one ring record, so no other producer's lines
+        // land between them; a batch too large for one record goes line by line. Returns
+        // false if this process is not a ring producer.
+        bool PublishBatchToSharedRing(std::string_view text, const std::vector<TextLine>& lines);
+    }
+}
@@ -0,0 +1,202 @@
+#include "../include/LogLayout.h"
+#include "../include/LogClock.h"
+#include "LogInternal.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <thread>
+
+namespace C6Logger {
+
+    // Fields are copied as whole fixed-size blocks, which compile to a few moves
+    // instead of a memcpy call; the scratch buffer has room for the overshoot.
+    static constexpr std::size_t COPY_BLOCK = 16;
+    static constexpr std::size_t TIMESTAMP_BYTES = 48;
+    static constexpr std::size_t THREAD_ID_BYTES = 24;
+
+    // Pre-rendered level names, padded to one block
+    struct LevelText {
+        char text[COPY_BLOCK];
+        std::size_t length;
+    };
+    static constexpr LevelText LEVEL_TEXT[] = {
+        { "TRACE", 5 }, { "DEBUG", 5 }, { "INFO", 4 }, { "WARNING", 7 }, { "ERROR", 5 }, { "CRITICAL", 8 }
+    };
+
+    // Writes a raw clock stamp as "YYYY-MM-DD HH:MM:SS[.fraction]" (at most
+    // TIMESTAMP_BYTES) and returns the end. The calendar part is cached per thread
+    // and only re-rendered when the second changes.
+    static char* WriteTimestamp(char* p, std::uint64_t stamp) {
+        std::int64_t wallNs = ClockToWallNs(stamp);
+        std::int64_t seconds = wallNs / 1000000000;
+        std::int64_t fraction = wallNs % 1000000000;
+        if (fraction < 0) {
+            fraction += 1000000000;
+            --seconds;
+        }
+
+        static thread_local std::int64_t cachedSecond = -1;
+        static thread_local char cachedText[32];
+        static thread_local std::size_t cachedLength = 0;
+        if (seconds != cachedSecond) {
+            std::time_t in_time_t = static_cast<std::time_t>(seconds);
+            std::tm buf;
+            // Use localtime_s on MSVC, localtime_r on POSIX, fallback to localtime (unsafe) otherwise
+#if defined(_MSC_VER)
+            localtime_s(&buf, &in_time_t);
+#elif defined(__unix__) || defined(__APPLE__)
+            localtime_r(&in_time_t, &buf);
+#else
+            std::tm* tmp = std::localtime(&in_time_t);
+            if (tmp) buf = *tmp;
+#endif
+            cachedLength = std::strftime(cachedText, sizeof(cachedText), "%Y-%m-%d %H:%M:%S", &buf);
+            cachedSecond = seconds;
+        }
+        std::memcpy(p, cachedText, sizeof(cachedText));
+        p += cachedLength;
+
+        int digits = GetTimestampPrecision();
+        if (digits == 0) return p;
+        char frac[COPY_BLOCK];
+        std::snprintf(frac, sizeof(frac), ".%09lld", static_cast<long long>(fraction));
+        std::memcpy(p, frac, sizeof(frac));
+        return p + digits + 1;
+    }
+
+    void detail::AppendTimestamp(std::string& out, std::uint64_t stamp) {
+        char text[TIMESTAMP_BYTES];
+        out.append(text, static_cast<std::size_t>(WriteTimestamp(text, stamp) - text));
+    }
+
+    // The calling thread's id, rendered once per thread
+    static std::string_view ThreadIdText() {
+        static thread_local char text[THREAD_ID_BYTES];
+        static thread_local std::size_t length = 0;
+        if (length == 0) {
+#if defined(_WIN32)
+            unsigned long long id = GetCurrentThreadId();
+#elif defined(__linux__)
+            unsigned long long id = static_cast<unsigned long long>(syscall(SYS_gettid));
+#else
+            unsigned long long id = std::hash<std::thread::id>()(std::this_thread::get_id());
+#endif
+            int n = std::snprintf(text, sizeof(text), "%llu", id);
+            length = n > 0 ? static_cast<std::size_t>(n) : 0;
+        }
+        return std::string_view(text, length);
+    }
+
+    LogLayout::LogLayout(std::string_view layoutPattern) : pattern(layoutPattern) {
+        compiled = CompileLayout(pattern);
+        if (!compiled.valid) {
+            std::cerr << RED << "[ERROR] Invalid log layout '" << pattern << "'; using the default." << RESET << std::endl;
+            pattern = DEFAULT_LOG_LAYOUT;
+            compiled = CompileLayout(pattern);
+            valid = false;
+        }
+        // Literals move to a pool padded by one block, so short ones can be block-copied
+        for (std::size_t i = 0; i < compiled.count; ++i) {
+            LayoutStep& step = compiled.steps[i];
+            switch (step.op) {
+            case LayoutOp::Literal:
+                fixedBytes += step.length;
+                literals.append(pattern, step.offset, step.length);
+                step.offset = static_cast<std::uint32_t>(literals.size() - step.length);
+                break;
+            case LayoutOp::Timestamp: fixedBytes += TIMESTAMP_BYTES; break;
+            case LayoutOp::Level: fixedBytes += COPY_BLOCK; break;
+            case LayoutOp::ThreadId: fixedBytes += THREAD_ID_BYTES; break;
+            case LayoutOp::Messenger: ++messengerCount; break;
+            case LayoutOp::Location: ++locationCount; break;
+            default: break;
+            }
+        }
+        literals.append(COPY_BLOCK, '\0');
+
+        // "%{[%n] %}" is exactly an interned messenger's prefix
+        for (std::size_t i = 0; i + 3 < compiled.count; ++i) {
+            const LayoutStep* s = &compiled.steps[i];
+            if (s[0].op == LayoutOp::Group && s[0].length == 3 && s[2].op == LayoutOp::Messenger &&
+                s[1].op == LayoutOp::Literal && literals.compare(s[1].offset, s[1].length, "[") == 0 &&
+                s[3].op == LayoutOp::Literal && literals.compare(s[3].offset, s[3].length, "] ") == 0) {
+                compiled.steps[i].offset = 1;
+            }
+        }
+    }
+
+    // Writes every step with memcpy into a per-thread scratch buffer that only ever
+    // grows, then appends the line to 'out' in one piece. Growing and trimming 'out'
+    // itself costs more than the copy (resize() zero-fills).
+    LayoutSpans LogLayout::Format(std::string& out, std::uint64_t stamp, LogLevel level, std::string_view message, std::string_view messenger,
+        std::string_view location, std::string_view messengerPrefix) const {
+        struct LayoutScratch;
+        std::string& scratch = detail::ThreadScratch<std::string, LayoutScratch>();
+        LayoutSpans spans;
+        std::size_t bound = fixedBytes + message.size() + messengerCount * messenger.size() + locationCount * location.size() + COPY_BLOCK;
+        if (scratch.size() < bound) scratch.resize(bound);
+        char* const base = &scratch[0];
+        char* p = base;
+        const char* text = literals.data();
+        for (std::size_t i = 0; i < compiled.count; ++i) {
+            const LayoutStep& step = compiled.steps[i];
+            switch (step.op) {
+            case LayoutOp::Literal:
+                if (step.length <= COPY_BLOCK) std::memcpy(p, text + step.offset, COPY_BLOCK);
+                else std::memcpy(p, text + step.offset, step.length);
+                p += step.length;
+                break;
+            case LayoutOp::Timestamp:
+                p = WriteTimestamp(p, stamp);
+                break;
+            case LayoutOp::Level: {
+                const LevelText& name = LEVEL_TEXT[static_cast<int>(level)];
+                std::memcpy(p, name.text, COPY_BLOCK);
+                p += name.length;
+                break;
+            }
+            case LayoutOp::Messenger:
+                spans.messengerOffset = static_cast<std::size_t>(p - base);
+                spans.messengerRendered = true;
+                if (!messenger.empty()) std::memcpy(p, messenger.data(), messenger.size());
+                p += messenger.size();
+                break;
+            case LayoutOp::ThreadId: {
+                std::string_view id = ThreadIdText();
+                std::memcpy(p, id.data(), THREAD_ID_BYTES);
+                p += id.size();
+                break;
+            }
+            case LayoutOp::Location:
+                if (!location.empty()) std::memcpy(p, location.data(), location.size());
+                p += location.size();
+                break;
+            case LayoutOp::Message:
+                spans.headerLength = static_cast<std::size_t>(p - base);
+                if (!message.empty()) std::memcpy(p, message.data(), message.size());
+                p += message.size();
+                break;
+            case LayoutOp::Group:
+                if (messenger.empty()) i += step.length;
+                else if (step.offset == 1 && !messengerPrefix.empty()) {
+                    spans.messengerOffset = static_cast<std::size_t>(p - base) + 1;
+                    spans.messengerRendered = true;
+                    std::memcpy(p, messengerPrefix.data(), messengerPrefix.size());
+                    p += messengerPrefix.size();
+                    i += step.length;
+                }
+                break;
+            }
+        }
+        out.append(base, static_cast<std::size_t>(p - base));
+        return spans;
+    }
+}
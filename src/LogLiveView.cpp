@@ -0,0 +1,272 @@
+#include "../include/LogLiveView.h"
+#include "LogInternal.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sched.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+namespace C6Logger {
+
+    static constexpr std::uint32_t LIVE_MAGIC = 0x4C56364C; // "L6VL"
+    static constexpr std::uint32_t LIVE_VERSION = 1;
+
+    struct alignas(64) LiveHeader {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t slotCount;
+        std::uint32_t slotSize;
+        std::atomic<std::uint32_t> initState; // 0 = fresh, 1 = initializing, 2 = ready
+        alignas(64) std::atomic<std::uint64_t> head; // next sequence handed to a writer
+    };
+
+    // Record n lives in slot n % slotCount. Its sequence word is 2n + 1 while the
+    // record is written and 2n + 2 once it is complete.
+    struct LiveSlot {
+        std::atomic<std::uint64_t> sequence;
+        std::uint32_t length;
+        std::uint8_t level;
+        std::uint8_t truncated;
+        std::uint16_t reserved;
+        char data[1];
+    };
+
+    static constexpr std::size_t SLOT_HEADER_SIZE = offsetof(LiveSlot, data);
+
+    struct detail::LiveViewMapping {
+        int fd = -1;
+        void* base = nullptr;
+        std::size_t size = 0;
+        LiveHeader* header = nullptr;
+        char* slots = nullptr;
+        std::uint32_t slotCount = 0;
+        std::uint32_t slotSize = 0;
+
+        LiveSlot* Slot(std::uint64_t sequence) const {
+            return reinterpret_cast<LiveSlot*>(slots + (sequence % slotCount) * slotSize);
+        }
+    };
+
+#if defined(__linux__)
+
+    static std::string LiveShmName(const std::string& name) {
+        return "/c6live-" + name;
+    }
+
+    static void CloseView(detail::LiveViewMapping* view) {
+        if (!view) return;
+        if (view->base) munmap(view->base, view->size);
+        if (view->fd >= 0) close(view->fd);
+        delete view;
+    }
+
+    static detail::LiveViewMapping* MapView(int fd, std::size_t size, bool writable) {
+        auto* view = new detail::LiveViewMapping();
+        view->fd = fd;
+        view->size = size;
+        void* base = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            CloseView(view);
+            return nullptr;
+        }
+        view->base = base;
+        view->header = static_cast<LiveHeader*>(base);
+        view->slots = static_cast<char*>(base) + sizeof(LiveHeader);
+        return view;
+    }
+
+    static detail::LiveViewMapping* CreateView(const LiveViewConfig& config) {
+        std::uint32_t slotCount = std::max<std::uint32_t>(config.slotCount, 16);
+        std::uint32_t slotSize = std::max<std::uint32_t>(config.slotSize, 64);
+        slotSize = (slotSize + 63) & ~std::uint32_t(63);
+        std::size_t size = sizeof(LiveHeader) + std::size_t(slotCount) * slotSize;
+        std::string shmName = LiveShmName(config.name);
+
+        int fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        struct stat st;
+        if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size != 0 && static_cast<std::size_t>(st.st_size) != size) {
+            // Left behind with another geometry: replace it; readers keep the old object
+            close(fd);
+            shm_unlink(shmName.c_str());
+            fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        }
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            if (fd >= 0) close(fd);
+            return nullptr;
+        }
+        if (st.st_size == 0 && ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            close(fd);
+            return nullptr;
+        }
+        detail::LiveViewMapping* view = MapView(fd, size, true);
+        if (!view) return nullptr;
+
+        // Whichever writer maps the fresh (zero-filled) object first lays it out
+        LiveHeader* h = view->header;
+        std::uint32_t fresh = 0;
+        if (h->initState.compare_exchange_strong(fresh, 1, std::memory_order_acq_rel)) {
+            h->magic = LIVE_MAGIC;
+            h->version = LIVE_VERSION;
+            h->slotCount = slotCount;
+            h->slotSize = slotSize;
+            h->head.store(0, std::memory_order_relaxed);
+            h->initState.store(2, std::memory_order_release);
+        }
+        else {
+            for (int spins = 0; h->initState.load(std::memory_order_acquire) != 2; ++spins) {
+                if (spins > 100000) {
+                    CloseView(view);
+                    return nullptr;
+                }
+                sched_yield();
+            }
+        }
+        if (h->magic != LIVE_MAGIC || h->version != LIVE_VERSION || h->slotCount != slotCount || h->slotSize != slotSize) {
+            CloseView(view);
+            return nullptr;
+        }
+        view->slotCount = slotCount;
+        view->slotSize = slotSize;
+        return view;
+    }
+
+    static detail::LiveViewMapping* AttachView(const std::string& name) {
+        int fd = shm_open(LiveShmName(name).c_str(), O_RDONLY | O_CLOEXEC, 0);
+        struct stat st;
+        if (fd < 0) return nullptr;
+        if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(LiveHeader)) {
+            close(fd);
+            return nullptr;
+        }
+        detail::LiveViewMapping* view = MapView(fd, static_cast<std::size_t>(st.st_size), false);
+        if (!view) return nullptr;
+        const LiveHeader* h = view->header;
+        bool valid = h->initState.load(std::memory_order_acquire) == 2 && h->magic == LIVE_MAGIC &&
+            h->version == LIVE_VERSION && h->slotCount > 0 && h->slotSize > SLOT_HEADER_SIZE &&
+            sizeof(LiveHeader) + std::size_t(h->slotCount) * h->slotSize == view->size;
+        if (!valid) {
+            CloseView(view);
+            return nullptr;
+        }
+        view->slotCount = h->slotCount;
+        view->slotSize = h->slotSize;
+        return view;
+    }
+
+    LiveViewSink::LiveViewSink(LiveViewConfig config) {
+        view = CreateView(config);
+        if (!view) {
+            std::cerr << RED << "[ERROR] Failed to create live view '" << config.name << "'." << RESET << std::endl;
+        }
+    }
+
+    LiveViewSink::~LiveViewSink() {
+        CloseView(view);
+    }
+
+    void LiveViewSink::Write(LogLevel level, std::string_view line, std::size_t) {
+        if (!view) return;
+        std::uint64_t sequence = view->header->head.fetch_add(1, std::memory_order_relaxed);
+        LiveSlot* slot = view->Slot(sequence);
+        std::size_t payload = view->slotSize - SLOT_HEADER_SIZE;
+        std::size_t length = std::min(line.size(), payload);
+        slot->sequence.store(sequence * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot->length = static_cast<std::uint32_t>(length);
+        slot->level = static_cast<std::uint8_t>(level);
+        slot->truncated = length < line.size();
+        std::memcpy(slot->data, line.data(), length);
+        slot->sequence.store(sequence * 2 + 2, std::memory_order_release);
+    }
+
+    bool RemoveLiveView(const std::string& name) {
+        return shm_unlink(LiveShmName(name).c_str()) == 0;
+    }
+
+    LiveViewReader::LiveViewReader(const std::string& name) {
+        view = AttachView(name);
+    }
+
+    LiveViewReader::~LiveViewReader() {
+        CloseView(view);
+    }
+
+    enum class SlotRead { Copied, Pending, Overwritten };
+
+    // Copies record 'sequence' if its slot still holds it, complete and unchanged
+    // across the copy
+    static SlotRead ReadSlot(const detail::LiveViewMapping& view, std::uint64_t sequence, LiveRecord& record) {
+        const LiveSlot* slot = view.Slot(sequence);
+        std::uint64_t before = slot->sequence.load(std::memory_order_acquire);
+        if (before < sequence * 2 + 2) return SlotRead::Pending;
+        if (before > sequence * 2 + 2) return SlotRead::Overwritten;
+        std::size_t length = std::min<std::size_t>(slot->length, view.slotSize - SLOT_HEADER_SIZE);
+        record.line.assign(slot->data, length);
+        record.level = static_cast<LogLevel>(std::min<std::uint8_t>(slot->level, static_cast<std::uint8_t>(LogLevel::critical)));
+        record.truncated = slot->truncated != 0;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->sequence.load(std::memory_order_relaxed) != before) return SlotRead::Overwritten;
+        record.sequence = sequence;
+        return SlotRead::Copied;
+    }
+
+    std::uint64_t LiveViewReader::Head() const {
+        return view ? view->header->head.load(std::memory_order_acquire) : 0;
+    }
+
+    std::vector<LiveRecord> LiveViewReader::Snapshot(std::size_t count) const {
+        std::vector<LiveRecord> records;
+        if (!view || count == 0) return records;
+        std::uint64_t head = Head();
+        std::uint64_t span = std::min<std::uint64_t>(count, view->slotCount);
+        std::uint64_t cursor = head > span ? head - span : 0;
+        records.reserve(static_cast<std::size_t>(span));
+        ReadSince(cursor, records);
+        return records;
+    }
+
+    std::size_t LiveViewReader::ReadSince(std::uint64_t& cursor, std::vector<LiveRecord>& out, std::uint64_t* missed) const {
+        if (!view) return 0;
+        std::uint64_t head = Head();
+        std::uint64_t lost = 0;
+        if (head > view->slotCount && cursor < head - view->slotCount) {
+            lost += head - view->slotCount - cursor;
+            cursor = head - view->slotCount;
+        }
+        std::size_t appended = 0;
+        LiveRecord record;
+        for (; cursor < head; ++cursor) {
+            SlotRead result = ReadSlot(*view, cursor, record);
+            if (result == SlotRead::Pending) break; // claimed but not yet written
+            if (result == SlotRead::Overwritten) {
+                ++lost;
+                continue;
+            }
+            out.push_back(record);
+            ++appended;
+        }
+        if (missed) *missed += lost;
+        return appended;
+    }
+
+#else
+
+    LiveViewSink::LiveViewSink(LiveViewConfig) {}
+    LiveViewSink::~LiveViewSink() = default;
+    void LiveViewSink::Write(LogLevel, std::string_view, std::size_t) {}
+    bool RemoveLiveView(const std::string&) { return false; }
+    LiveViewReader::LiveViewReader(const std::string&) {}
+    LiveViewReader::~LiveViewReader() = default;
+    std::uint64_t LiveViewReader::Head() const { return 0; }
+    std::vector<LiveRecord> LiveViewReader::Snapshot(std::size_t) const { return {}; }
+    std::size_t LiveViewReader::ReadSince(std::uint64_t&, std::vector<LiveRecord>&, std::uint64_t*) const { return 0; }
+
+#endif
+}
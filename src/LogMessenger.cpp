@@ -0,0 +1,102 @@
+#include "../include/LogMessenger.h"
+#include "LogInternal.h"
+
+#include <algorithm>
+
+namespace C6Logger {
+
+    // Open addressing at most half full; slots and ids are only ever filled in, so
+    // readers need no lock and entries are never freed.
+    static constexpr std::size_t MESSENGER_SLOTS = MAX_MESSENGERS * 2;
+
+    struct MessengerTable {
+        std::atomic<detail::MessengerEntry*> slots[MESSENGER_SLOTS] = {};
+        std::atomic<detail::MessengerEntry*> byId[MAX_MESSENGERS + 1] = {};
+        std::atomic<std::uint32_t> lastId{ 0 };
+    };
+
+    static MessengerTable& Table() {
+        // Leaked on purpose: handles are used from static destructors
+        static MessengerTable* table = new MessengerTable();
+        return *table;
+    }
+
+    static std::uint64_t HashName(std::string_view name) {
+        std::uint64_t hash = 1469598103934665603ull; // FNV-1a
+        for (char c : name) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    Messenger::Messenger(std::string_view name) {
+        if (name.empty()) return;
+        MessengerTable& table = Table();
+        std::uint64_t hash = HashName(name);
+        detail::MessengerEntry* created = nullptr;
+        for (std::size_t probe = 0; probe < MESSENGER_SLOTS; ++probe) {
+            std::atomic<detail::MessengerEntry*>& slot = table.slots[(hash + probe) & (MESSENGER_SLOTS - 1)];
+            detail::MessengerEntry* current = slot.load(std::memory_order_acquire);
+            if (!current) {
+                if (!created) {
+                    std::uint32_t id = table.lastId.fetch_add(1, std::memory_order_relaxed) + 1;
+                    if (id > MAX_MESSENGERS) {
+                        std::cerr << RED << "[ERROR] Too many messengers; '" << name << "' is logged without one." << RESET << std::endl;
+                        return;
+                    }
+                    created = new detail::MessengerEntry();
+                    created->id = id;
+                    created->hash = hash;
+                    created->name = std::string(name);
+                    created->prefix = "[" + created->name + "] ";
+                }
+                if (slot.compare_exchange_strong(current, created, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    table.byId[created->id].store(created, std::memory_order_release);
+                    entry = created;
+                    return;
+                }
+                // Lost the slot to another insert; 'current' now holds the winner.
+                // Our id stays unused if the name turns out to be the same.
+            }
+            if (current->hash == hash && current->name == name) {
+                delete created;
+                entry = current;
+                return;
+            }
+        }
+        delete created;
+    }
+
+    Messenger Messenger::FromId(std::uint32_t id) {
+        if (id == 0 || id > MAX_MESSENGERS) return Messenger();
+        return Messenger(Table().byId[id].load(std::memory_order_acquire));
+    }
+
+    void Messenger::SetLevel(LogLevel level) const {
+        if (entry) entry->level.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    LogLevel Messenger::GetLevel() const {
+        return entry ? static_cast<LogLevel>(entry->level.load(std::memory_order_relaxed)) : LogLevel::trace;
+    }
+
+    MessengerStats Messenger::Stats() const {
+        MessengerStats stats;
+        if (!entry) return stats;
+        stats.lines = entry->lines.load(std::memory_order_relaxed);
+        stats.suppressed = entry->suppressed.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    std::vector<Messenger> GetMessengers() {
+        std::vector<Messenger> messengers;
+        MessengerTable& table = Table();
+        std::uint32_t last = std::min<std::uint32_t>(table.lastId.load(std::memory_order_relaxed), MAX_MESSENGERS);
+        for (std::uint32_t id = 1; id <= last; ++id) {
+            Messenger messenger = Messenger::FromId(id);
+            if (!messenger.Empty()) messengers.push_back(messenger);
+        }
+        return messengers;
+    }
+}
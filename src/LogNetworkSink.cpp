@@ -0,0 +1,575 @@
+#include "../include/LogNetworkSink.h"
+#include "../include/LogClock.h"
+#include "LogInternal.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define C6_NETWORK_SINK_POSIX 1
+#endif
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace C6Logger {
+
+#if defined(__linux__)
+    static constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    static constexpr int SEND_FLAGS = 0;
+#endif
+    static constexpr std::size_t MAX_DATAGRAM = 65507;
+    static constexpr std::size_t DATAGRAMS_PER_CALL = 64;
+
+    // Framed records queued for sending; lengths[i] includes the framing
+    struct NetworkQueue {
+        std::string text;
+        std::vector<std::uint32_t> lengths;
+
+        void Clear() {
+            text.clear();
+            lengths.clear();
+        }
+
+        std::size_t OffsetOf(std::size_t record) const {
+            std::size_t offset = 0;
+            for (std::size_t i = 0; i < record; ++i) offset += lengths[i];
+            return offset;
+        }
+    };
+
+#if defined(C6_NETWORK_SINK_POSIX)
+
+    // Records waiting for the collector, in order. Layout: a 16-byte header (magic,
+    // version, offset of the first unsent record), then records as a 4-byte
+    // little-endian length followed by the framed bytes. Replay advances the stored
+    // offset after every batch, so a restart resends at most one batch.
+    class NetworkSpool {
+    public:
+        ~NetworkSpool() {
+            if (fd >= 0) close(fd);
+        }
+
+        bool Open(const std::string& spoolPath, std::size_t limit) {
+            path = spoolPath;
+            maxBytes = limit;
+            fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                std::cerr << RED << "[ERROR] Failed to open network spool '" << path << "'." << RESET << std::endl;
+                return false;
+            }
+            unsigned char header[HEADER_SIZE];
+            struct stat st;
+            bool valid = fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(HEADER_SIZE) &&
+                pread(fd, header, HEADER_SIZE, 0) == static_cast<ssize_t>(HEADER_SIZE) && Load32(header) == MAGIC;
+            if (!valid) return Reset();
+            readOffset = Load64(header + 8);
+            std::uint64_t size = static_cast<std::uint64_t>(st.st_size);
+            if (readOffset < HEADER_SIZE || readOffset > size) return Reset();
+            // Drop a record torn by a crash mid-append
+            writeOffset = readOffset;
+            unsigned char word[4];
+            while (writeOffset + 4 <= size && pread(fd, word, 4, static_cast<off_t>(writeOffset)) == 4) {
+                std::uint64_t next = writeOffset + 4 + Load32(word);
+                if (next > size) break;
+                writeOffset = next;
+            }
+            if (writeOffset != size && ftruncate(fd, static_cast<off_t>(writeOffset)) != 0) return Reset();
+            if (readOffset == writeOffset) return Reset();
+            return true;
+        }
+
+        bool IsOpen() const { return fd >= 0; }
+        bool Empty() const { return readOffset == writeOffset; }
+
+        // Appends records [first, end) while they fit under the limit; returns how many
+        std::size_t Append(const NetworkQueue& queue, std::size_t first) {
+            if (fd < 0) return 0;
+            scratch.clear();
+            std::size_t offset = queue.OffsetOf(first);
+            std::size_t count = 0;
+            for (std::size_t i = first; i < queue.lengths.size(); ++i) {
+                std::uint32_t length = queue.lengths[i];
+                if (writeOffset - HEADER_SIZE + scratch.size() + 4 + length > maxBytes) break;
+                unsigned char word[4];
+                Store32(word, length);
+                scratch.append(reinterpret_cast<const char*>(word), 4);
+                scratch.append(queue.text, offset, length);
+                offset += length;
+                ++count;
+            }
+            if (scratch.empty()) return 0;
+            if (!WriteAll(scratch.data(), scratch.size(), writeOffset)) {
+                std::cerr << RED << "[ERROR] Failed to write network spool '" << path << "'." << RESET << std::endl;
+                return 0;
+            }
+            writeOffset += scratch.size();
+            return count;
+        }
+
+        // Reads records from the front, at least one and about maxBatch bytes
+        void Peek(NetworkQueue& out, std::size_t maxBatch) {
+            out.Clear();
+            std::uint64_t offset = readOffset;
+            unsigned char word[4];
+            while (offset < writeOffset && (out.lengths.empty() || out.text.size() < maxBatch)) {
+                if (pread(fd, word, 4, static_cast<off_t>(offset)) != 4) break;
+                std::uint32_t length = Load32(word);
+                std::size_t at = out.text.size();
+                out.text.resize(at + length);
+                if (pread(fd, &out.text[at], length, static_cast<off_t>(offset + 4)) != static_cast<ssize_t>(length)) {
+                    out.text.resize(at);
+                    break;
+                }
+                out.lengths.push_back(length);
+                offset += 4 + length;
+            }
+        }
+
+        // Forgets the first 'count' records returned by Peek()
+        void Consume(const NetworkQueue& peeked, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i) readOffset += 4 + peeked.lengths[i];
+            if (readOffset >= writeOffset) {
+                Reset();
+                return;
+            }
+            unsigned char word[8];
+            Store64(word, readOffset);
+            WriteAll(reinterpret_cast<const char*>(word), 8, 8);
+        }
+
+    private:
+        static constexpr std::uint32_t MAGIC = 0x50533643; // "C6SP"
+        static constexpr std::uint32_t VERSION = 1;
+        static constexpr std::uint64_t HEADER_SIZE = 16;
+
+        static std::uint32_t Load32(const unsigned char* p) {
+            return std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8 | std::uint32_t(p[2]) << 16 | std::uint32_t(p[3]) << 24;
+        }
+        static std::uint64_t Load64(const unsigned char* p) {
+            return std::uint64_t(Load32(p)) | std::uint64_t(Load32(p + 4)) << 32;
+        }
+        static void Store32(unsigned char* p, std::uint32_t v) {
+            for (int i = 0; i < 4; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+        }
+        static void Store64(unsigned char* p, std::uint64_t v) {
+            for (int i = 0; i < 8; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+        }
+
+        bool WriteAll(const char* data, std::size_t size, std::uint64_t offset) {
+            while (size > 0) {
+                ssize_t n = pwrite(fd, data, size, static_cast<off_t>(offset));
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return false;
+                data += n;
+                size -= static_cast<std::size_t>(n);
+                offset += static_cast<std::uint64_t>(n);
+            }
+            return true;
+        }
+
+        bool Reset() {
+            unsigned char header[HEADER_SIZE] = {};
+            Store32(header, MAGIC);
+            Store32(header + 4, VERSION);
+            Store64(header + 8, HEADER_SIZE);
+            readOffset = writeOffset = HEADER_SIZE;
+            if (ftruncate(fd, static_cast<off_t>(HEADER_SIZE)) != 0 ||
+                !WriteAll(reinterpret_cast<const char*>(header), HEADER_SIZE, 0)) {
+                std::cerr << RED << "[ERROR] Failed to initialize network spool '" << path << "'." << RESET << std::endl;
+                close(fd);
+                fd = -1;
+                return false;
+            }
+            return true;
+        }
+
+        std::string path;
+        std::size_t maxBytes = 0;
+        int fd = -1;
+        std::uint64_t readOffset = HEADER_SIZE;
+        std::uint64_t writeOffset = HEADER_SIZE;
+        std::string scratch;
+    };
+
+#endif
+
+    class NetworkSink::State {
+    public:
+        explicit State(NetworkSinkConfig sinkConfig) : config(std::move(sinkConfig)), jitter(std::random_device()()) {
+            if (config.flushIntervalMs < 1) config.flushIntervalMs = 1;
+            if (config.reconnectMinMs < 1) config.reconnectMinMs = 1;
+            if (config.reconnectMaxMs < config.reconnectMinMs) config.reconnectMaxMs = config.reconnectMinMs;
+            config.datagramBytes = std::clamp<std::size_t>(config.datagramBytes, 64, MAX_DATAGRAM);
+            backoffMs = config.reconnectMinMs;
+#if defined(C6_NETWORK_SINK_POSIX)
+            if (config.spoolPath.empty()) {
+                std::string name = "net-" + config.host + "-" + std::to_string(config.port) + ".spool";
+                config.spoolPath = (std::filesystem::path(GetLogPath()).parent_path() / name).string();
+            }
+            if (config.spoolPath != "-") spool.Open(config.spoolPath, config.maxSpoolBytes);
+            sender = std::thread([this] { Run(); });
+#else
+            std::cerr << RED << "[ERROR] The network sink is not supported on this platform." << RESET << std::endl;
+#endif
+        }
+
+        ~State() {
+            if (sender.joinable()) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stopping = true;
+                }
+                wake.notify_all();
+                sender.join();
+            }
+#if defined(C6_NETWORK_SINK_POSIX)
+            if (fd >= 0) close(fd);
+#endif
+        }
+
+        void Write(std::string_view line) {
+            if (!sender.joinable()) return;
+            std::size_t framed = line.size() + (config.framing == NetworkFraming::LengthPrefixed ? 4 : 1);
+            std::unique_lock<std::mutex> lock(mutex);
+            if (pending.text.size() + framed > config.maxQueueBytes) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            if (config.framing == NetworkFraming::LengthPrefixed) {
+                std::uint32_t length = static_cast<std::uint32_t>(line.size());
+                char prefix[4] = { static_cast<char>(length >> 24), static_cast<char>(length >> 16),
+                    static_cast<char>(length >> 8), static_cast<char>(length) };
+                pending.text.append(prefix, 4);
+                pending.text += line;
+            }
+            else {
+                pending.text += line;
+                pending.text += '\n';
+            }
+            pending.lengths.push_back(static_cast<std::uint32_t>(framed));
+            std::size_t size = pending.text.size();
+            bool wakeSender = pending.lengths.size() == 1 || (size >= config.batchBytes && size - framed < config.batchBytes);
+            lock.unlock();
+            if (wakeSender) wake.notify_one();
+        }
+
+        void Flush() {
+            if (!sender.joinable()) return;
+            std::unique_lock<std::mutex> lock(mutex);
+            std::uint64_t ticket = ++flushRequested;
+            wake.notify_one();
+            flushed.wait(lock, [&] { return flushCompleted >= ticket; });
+        }
+
+        NetworkSinkStats Stats() const {
+            NetworkSinkStats stats;
+            stats.sentRecords = sentRecords.load(std::memory_order_relaxed);
+            stats.sentBytes = sentBytes.load(std::memory_order_relaxed);
+            stats.spooled = spooled.load(std::memory_order_relaxed);
+            stats.replayed = replayed.load(std::memory_order_relaxed);
+            stats.dropped = dropped.load(std::memory_order_relaxed);
+            stats.connects = connects.load(std::memory_order_relaxed);
+            stats.connectFailures = connectFailures.load(std::memory_order_relaxed);
+            stats.connected = connected.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+    private:
+#if defined(C6_NETWORK_SINK_POSIX)
+        void Run() {
+            std::unique_lock<std::mutex> lock(mutex);
+            auto ready = [this] {
+                return stopping || flushRequested > flushCompleted || pending.text.size() >= config.batchBytes;
+            };
+            for (;;) {
+                // With a spool backlog the sender also wakes to retry the connection
+                bool backlog = spool.IsOpen() && !spool.Empty();
+                if (pending.lengths.empty() && !backlog) {
+                    wake.wait(lock, [&] { return ready() || !pending.lengths.empty(); });
+                }
+                if (!ready()) {
+                    std::int64_t waitMs = config.flushIntervalMs;
+                    if (pending.lengths.empty()) waitMs = std::max<std::int64_t>(1, (nextAttemptNs - MonotonicNs()) / 1000000);
+                    wake.wait_for(lock, std::chrono::milliseconds(waitMs), ready);
+                }
+                bool stop = stopping;
+                std::uint64_t flushTarget = flushRequested;
+                std::swap(pending, batch);
+                lock.unlock();
+                Deliver();
+                batch.Clear();
+                lock.lock();
+                if (flushTarget > flushCompleted) {
+                    flushCompleted = flushTarget;
+                    flushed.notify_all();
+                }
+                if (stop && pending.lengths.empty()) return;
+            }
+        }
+
+        // Sends the batch, behind any spool backlog; whatever cannot go out now is spooled
+        void Deliver() {
+            if (fd < 0 && MonotonicNs() >= nextAttemptNs) Connect();
+            if (fd >= 0 && spool.IsOpen() && !spool.Empty()) ReplaySpool();
+            std::size_t sent = 0;
+            bool direct = fd >= 0 && (!spool.IsOpen() || spool.Empty());
+            if (direct && !batch.lengths.empty()) sent = Send(batch);
+            if (sent == batch.lengths.size()) return;
+            std::size_t kept = spool.IsOpen() ? spool.Append(batch, sent) : 0;
+            spooled.fetch_add(kept, std::memory_order_relaxed);
+            dropped.fetch_add(batch.lengths.size() - sent - kept, std::memory_order_relaxed);
+        }
+
+        void ReplaySpool() {
+            while (fd >= 0 && !spool.Empty()) {
+                spool.Peek(replay, config.batchBytes);
+                if (replay.lengths.empty()) break;
+                std::size_t sent = Send(replay);
+                spool.Consume(replay, sent);
+                replayed.fetch_add(sent, std::memory_order_relaxed);
+            }
+        }
+
+        // Returns how many leading records were sent (or discarded as unsendable)
+        std::size_t Send(const NetworkQueue& queue) {
+            return config.protocol == NetworkProtocol::Tcp ? SendStream(queue) : SendDatagrams(queue);
+        }
+
+        std::size_t SendStream(const NetworkQueue& queue) {
+            std::size_t sent = 0;
+            while (sent < queue.text.size()) {
+                ssize_t n = send(fd, queue.text.data() + sent, queue.text.size() - sent, SEND_FLAGS);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) {
+                    Disconnect(n < 0 ? errno : ECONNRESET);
+                    break;
+                }
+                sent += static_cast<std::size_t>(n);
+            }
+            // A record cut off by a failure is resent whole on the next connection
+            std::size_t records = 0;
+            std::size_t complete = 0;
+            while (records < queue.lengths.size() && complete + queue.lengths[records] <= sent) complete += queue.lengths[records++];
+            sentRecords.fetch_add(records, std::memory_order_relaxed);
+            sentBytes.fetch_add(complete, std::memory_order_relaxed);
+            return records;
+        }
+
+        struct Datagram {
+            std::size_t offset;
+            std::size_t length;
+            std::size_t records;
+        };
+
+        // Packs consecutive whole records into datagrams of up to datagramBytes. A
+        // record too large for any datagram is dropped.
+        std::size_t SendDatagrams(const NetworkQueue& queue) {
+            std::size_t record = 0;
+            std::size_t offset = 0;
+            while (record < queue.lengths.size()) {
+                std::size_t firstRecord = record;
+                datagrams.clear();
+                while (record < queue.lengths.size() && datagrams.size() < DATAGRAMS_PER_CALL) {
+                    Datagram datagram = { offset, 0, 0 };
+                    while (record < queue.lengths.size() &&
+                        (datagram.records == 0 || datagram.length + queue.lengths[record] <= config.datagramBytes)) {
+                        datagram.length += queue.lengths[record++];
+                        ++datagram.records;
+                    }
+                    offset += datagram.length;
+                    datagrams.push_back(datagram);
+                }
+                std::size_t done = SendDatagramBatch(queue);
+                if (done < datagrams.size()) {
+                    record = firstRecord;
+                    for (std::size_t i = 0; i < done; ++i) record += datagrams[i].records;
+                    return record;
+                }
+            }
+            return record;
+        }
+
+        // Returns how many of 'datagrams' went out (or were dropped as oversized)
+        std::size_t SendDatagramBatch(const NetworkQueue& queue) {
+            std::size_t done = 0;
+            while (done < datagrams.size()) {
+                if (datagrams[done].length > MAX_DATAGRAM) {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    ++done;
+                    continue;
+                }
+#if defined(__linux__)
+                std::size_t count = 0;
+                iovecs.resize(datagrams.size());
+                messages.resize(datagrams.size());
+                while (done + count < datagrams.size() && datagrams[done + count].length <= MAX_DATAGRAM) {
+                    const Datagram& datagram = datagrams[done + count];
+                    iovecs[count].iov_base = const_cast<char*>(queue.text.data() + datagram.offset);
+                    iovecs[count].iov_len = datagram.length;
+                    std::memset(&messages[count], 0, sizeof(messages[count]));
+                    messages[count].msg_hdr.msg_iov = &iovecs[count];
+                    messages[count].msg_hdr.msg_iovlen = 1;
+                    ++count;
+                }
+                int result = sendmmsg(fd, messages.data(), static_cast<unsigned>(count), SEND_FLAGS);
+#else
+                int result = send(fd, queue.text.data() + datagrams[done].offset, datagrams[done].length, SEND_FLAGS) >= 0 ? 1 : -1;
+#endif
+                if (result > 0) {
+                    for (int i = 0; i < result; ++i) {
+                        sentRecords.fetch_add(datagrams[done].records, std::memory_order_relaxed);
+                        sentBytes.fetch_add(datagrams[done].length, std::memory_order_relaxed);
+                        ++done;
+                    }
+                    continue;
+                }
+                if (errno == EINTR) continue;
+                Disconnect(errno);
+                break;
+            }
+            return done;
+        }
+
+        void Connect() {
+            addrinfo hints = {};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = config.protocol == NetworkProtocol::Tcp ? SOCK_STREAM : SOCK_DGRAM;
+            addrinfo* addresses = nullptr;
+            std::string port = std::to_string(config.port);
+            int error = getaddrinfo(config.host.c_str(), port.c_str(), &hints, &addresses);
+            if (error == 0) {
+                for (addrinfo* address = addresses; address && fd < 0; address = address->ai_next) {
+                    fd = ConnectTo(*address);
+                }
+                freeaddrinfo(addresses);
+            }
+            if (fd < 0) {
+                connectFailures.fetch_add(1, std::memory_order_relaxed);
+                if (!reportedOutage) {
+                    std::cerr << RED << "[ERROR] Failed to connect to log collector " << config.host << ':' << config.port
+                        << "; retrying with backoff." << RESET << std::endl;
+                    reportedOutage = true;
+                }
+                // Exponential backoff with jitter in [delay/2, delay]
+                std::uniform_int_distribution<int> spread(backoffMs / 2, backoffMs);
+                nextAttemptNs = MonotonicNs() + static_cast<std::int64_t>(spread(jitter)) * 1000000;
+                backoffMs = std::min(config.reconnectMaxMs, backoffMs * 2);
+                return;
+            }
+            backoffMs = config.reconnectMinMs;
+            reportedOutage = false;
+            connects.fetch_add(1, std::memory_order_relaxed);
+            connected.store(true, std::memory_order_relaxed);
+        }
+
+        int ConnectTo(const addrinfo& address) {
+            int socketFd = socket(address.ai_family, address.ai_socktype, address.ai_protocol);
+            if (socketFd < 0) return -1;
+            fcntl(socketFd, F_SETFD, FD_CLOEXEC);
+#if defined(SO_NOSIGPIPE)
+            int one = 1;
+            setsockopt(socketFd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+            if (address.ai_socktype == SOCK_DGRAM) {
+                if (connect(socketFd, address.ai_addr, address.ai_addrlen) == 0) return socketFd;
+                close(socketFd);
+                return -1;
+            }
+            // Non-blocking connect bounded by connectTimeoutMs, then blocking sends
+            int flags = fcntl(socketFd, F_GETFL, 0);
+            fcntl(socketFd, F_SETFL, flags | O_NONBLOCK);
+            bool ok = connect(socketFd, address.ai_addr, address.ai_addrlen) == 0;
+            if (!ok && errno == EINPROGRESS) {
+                pollfd waiting = { socketFd, POLLOUT, 0 };
+                int socketError = 0;
+                socklen_t length = sizeof(socketError);
+                ok = poll(&waiting, 1, config.connectTimeoutMs) == 1 &&
+                    getsockopt(socketFd, SOL_SOCKET, SO_ERROR, &socketError, &length) == 0 && socketError == 0;
+            }
+            if (!ok) {
+                close(socketFd);
+                return -1;
+            }
+            fcntl(socketFd, F_SETFL, flags);
+            timeval timeout = { config.sendTimeoutMs / 1000, (config.sendTimeoutMs % 1000) * 1000 };
+            setsockopt(socketFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            return socketFd;
+        }
+
+        void Disconnect(int error) {
+            if (fd < 0) return;
+            close(fd);
+            fd = -1;
+            connected.store(false, std::memory_order_relaxed);
+            if (!reportedOutage) {
+                std::cerr << RED << "[ERROR] Lost connection to log collector " << config.host << ':' << config.port
+                    << ": " << std::strerror(error) << RESET << std::endl;
+                reportedOutage = true;
+            }
+            nextAttemptNs = MonotonicNs() + static_cast<std::int64_t>(backoffMs) * 1000000;
+        }
+
+        NetworkSpool spool;
+        NetworkQueue replay;
+        std::vector<Datagram> datagrams;
+#if defined(__linux__)
+        std::vector<iovec> iovecs;
+        std::vector<mmsghdr> messages;
+#endif
+#endif
+
+        NetworkSinkConfig config;
+        std::minstd_rand jitter;
+        int fd = -1;                 // sender thread only
+        int backoffMs = 0;
+        std::int64_t nextAttemptNs = 0;
+        bool reportedOutage = false;
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable flushed;
+        NetworkQueue pending;        // filled by Write()
+        NetworkQueue batch;          // owned by the sender thread
+        bool stopping = false;
+        std::uint64_t flushRequested = 0;
+        std::uint64_t flushCompleted = 0;
+        std::thread sender;
+
+        std::atomic<std::uint64_t> sentRecords{ 0 };
+        std::atomic<std::uint64_t> sentBytes{ 0 };
+        std::atomic<std::uint64_t> spooled{ 0 };
+        std::atomic<std::uint64_t> replayed{ 0 };
+        std::atomic<std::uint64_t> dropped{ 0 };
+        std::atomic<std::uint64_t> connects{ 0 };
+        std::atomic<std::uint64_t> connectFailures{ 0 };
+        std::atomic<bool> connected{ false };
+    };
+
+    NetworkSink::NetworkSink(NetworkSinkConfig config) : state(std::make_unique<State>(std::move(config))) {}
+
+    NetworkSink::~NetworkSink() = default;
+
+    void NetworkSink::Write(LogLevel, std::string_view line, std::size_t) {
+        state->Write(line);
+    }
+
+    void NetworkSink::Flush() {
+        state->Flush();
+    }
+
+    NetworkSinkStats NetworkSink::Stats() const {
+        return state->Stats();
+    }
+}
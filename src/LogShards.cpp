@@ -0,0 +1,436 @@
+#include "../include/Logger.h"
+#include "../include/LogBatch.h"
+#include "../include/LogClock.h"
+#include "LogInternal.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace C6Logger {
+
+    struct ShardRecord {
+        std::int64_t key;          // wall ns of the line's timestamp, taken under the shard lock
+        std::uint64_t seq;         // per-shard sequence, tiebreak after the shard index
+        std::size_t offset;        // into the shard's text
+        std::uint32_t length;      // of the line; an unrendered messenger follows it in the text
+        std::uint32_t headerLength;
+        std::uint32_t messageLength;
+        std::uint32_t messengerOffset;
+        std::uint32_t messengerLength;
+        std::uint32_t following;   // records after this one from the same batch, emitted with it
+        std::uint32_t deferred;    // 1 + index into the buffer's deferred lines; 0 if formatted
+        bool messengerInLine;
+        LogLevel level;
+    };
+
+    // A LogDeferred line: the merger builds the message and formats the line
+    struct DeferredLine {
+        detail::MessageProducer produce;
+        const LogLayout* layout;   // the logger keeps every layout it has used
+        std::uint64_t stamp;
+    };
+
+    struct ShardBuffer {
+        std::vector<ShardRecord> records;
+        std::vector<DeferredLine> deferred;
+        std::string text;   // formatted lines; only the messenger for deferred ones
+
+        // Bytes counted against the shard limits; a deferred line is assumed to be a typical line
+        std::size_t Footprint() const { return text.size() + deferred.size() * 128; }
+
+        void Clear() {
+            records.clear();
+            deferred.clear();
+            text.clear();
+        }
+    };
+
+    // One shard per CPU (modulo the shard count). Buffers keep their capacity across
+    // swaps, and their pages are first touched by the producers that fill them, so on
+    // NUMA hosts a shard's memory ends up on the node of the cores that use it.
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::condition_variable drained;
+        ShardBuffer active;
+        std::uint64_t seq = 0;
+        bool wakeSent = false;
+    };
+
+    class detail::ShardedQueue::State {
+    public:
+        State(std::size_t shardCount, int mergeIntervalMs, Deliver deliverFn)
+            : shards(shardCount), spare(shardCount), pending(shardCount), cursor(shardCount, 0),
+              intervalMs(mergeIntervalMs < 1 ? 1 : mergeIntervalMs), deliver(std::move(deliverFn)) {
+            merger = std::thread([this] { Run(); });
+        }
+
+        ~State() {
+            {
+                std::lock_guard<std::mutex> lock(mergeMutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            merger.join();
+        }
+
+        bool Enqueue(const LogLayout& layout, LogLevel level, std::string_view message, std::string_view messenger, std::string_view location,
+            std::string_view messengerPrefix, bool wait) {
+            Shard& shard = shards[ShardIndex()];
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            if (!Reserve(shard, lock, wait)) return false;
+            std::uint64_t stamp = ClockNow();
+            AddRecord(shard, layout, stamp, level, message, messenger, location, messengerPrefix);
+            Release(shard, lock);
+            return true;
+        }
+
+        void EnqueueDeferred(const LogLayout& layout, LogLevel level, detail::MessageProducer produce, std::string_view messenger) {
+            Shard& shard = shards[ShardIndex()];
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            Reserve(shard, lock, true);
+            std::uint64_t stamp = ClockNow();
+            ShardRecord record{};
+            record.key = ClockToWallNs(stamp);
+            record.seq = shard.seq++;
+            record.offset = shard.active.text.size();
+            record.messengerLength = static_cast<std::uint32_t>(messenger.size());
+            shard.active.text.append(messenger.data(), messenger.size());
+            shard.active.deferred.push_back(DeferredLine{ std::move(produce), &layout, stamp });
+            record.deferred = static_cast<std::uint32_t>(shard.active.deferred.size());
+            record.level = level;
+            shard.active.records.push_back(record);
+            Release(shard, lock);
+        }
+
+        void EnqueueBatch(const LogLayout& layout, const LogBatch& lines) {
+            Shard& shard = shards[ShardIndex()];
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            Reserve(shard, lock, true);
+            std::uint64_t stamp = ClockNow();
+            std::size_t first = shard.active.records.size();
+            for (std::size_t i = 0; i < lines.Size(); ++i) {
+                LogBatch::Entry entry = lines.At(i);
+                AddRecord(shard, layout, stamp, entry.level, entry.message, entry.messenger, std::string_view(), entry.messengerPrefix);
+            }
+            shard.active.records[first].following = static_cast<std::uint32_t>(lines.Size() - 1);
+            Release(shard, lock);
+        }
+
+        void Flush() {
+            // A FlushAsync callback runs on the merger, which cannot wait for its own round
+            if (std::this_thread::get_id() == merger.get_id()) return;
+            std::unique_lock<std::mutex> lock(mergeMutex);
+            std::uint64_t ticket = ++flushRequested;
+            wake.notify_all();
+            flushed.wait(lock, [&] { return flushCompleted >= ticket || stopping; });
+        }
+
+        void FlushAsync(std::function<void()> done) {
+            {
+                std::lock_guard<std::mutex> lock(mergeMutex);
+                flushCallbacks.emplace_back(++flushRequested, std::move(done));
+            }
+            wake.notify_all();
+        }
+
+        std::uint64_t Stalls() const {
+            return stalls.load(std::memory_order_relaxed);
+        }
+
+    private:
+        static constexpr std::size_t SOFT_LIMIT = 256 * 1024;
+        static constexpr std::size_t HARD_LIMIT = 4 * 1024 * 1024;
+
+        std::size_t ShardIndex() const {
+#if defined(__linux__)
+            int cpu = sched_getcpu();
+            if (cpu >= 0) return static_cast<std::size_t>(cpu) % shards.size();
+#endif
+            static thread_local std::size_t slot = std::hash<std::thread::id>()(std::this_thread::get_id());
+            return slot % shards.size();
+        }
+
+        // Waits (or with !wait gives up) while the shard is over its hard limit
+        bool Reserve(Shard& shard, std::unique_lock<std::mutex>& lock, bool wait) {
+            if (shard.active.Footprint() < HARD_LIMIT) return true;
+            stalls.fetch_add(1, std::memory_order_relaxed);
+            lock.unlock();
+            RequestMerge();
+            if (!wait) return false;
+            lock.lock();
+            shard.drained.wait(lock, [&] { return shard.active.Footprint() < HARD_LIMIT; });
+            return true;
+        }
+
+        // Formats one line into the shard's active buffer; called under the shard lock
+        void AddRecord(Shard& shard, const LogLayout& layout, std::uint64_t stamp, LogLevel level, std::string_view message,
+            std::string_view messenger, std::string_view location, std::string_view messengerPrefix) {
+            ShardRecord record;
+            record.key = ClockToWallNs(stamp);
+            record.seq = shard.seq++;
+            record.offset = shard.active.text.size();
+            LayoutSpans spans = layout.Format(shard.active.text, stamp, level, message, messenger, location, messengerPrefix);
+            record.length = static_cast<std::uint32_t>(shard.active.text.size() - record.offset);
+            record.headerLength = static_cast<std::uint32_t>(spans.headerLength);
+            record.messageLength = static_cast<std::uint32_t>(message.size());
+            record.messengerLength = static_cast<std::uint32_t>(messenger.size());
+            record.following = 0;
+            record.deferred = 0;
+            record.messengerInLine = spans.messengerRendered || messenger.empty();
+            record.messengerOffset = static_cast<std::uint32_t>(spans.messengerOffset);
+            if (!record.messengerInLine) shard.active.text += messenger;
+            record.level = level;
+            shard.active.records.push_back(record);
+        }
+
+        // Unlocks the shard, waking the merger once the shard passes its soft limit
+        void Release(Shard& shard, std::unique_lock<std::mutex>& lock) {
+            bool wakeMerger = shard.active.Footprint() >= SOFT_LIMIT && !shard.wakeSent;
+            if (wakeMerger) shard.wakeSent = true;
+            lock.unlock();
+            if (wakeMerger) RequestMerge();
+        }
+
+        void RequestMerge() {
+            {
+                std::lock_guard<std::mutex> lock(mergeMutex);
+                mergeRequested = true;
+            }
+            wake.notify_one();
+        }
+
+        void Run() {
+            std::unique_lock<std::mutex> lock(mergeMutex);
+            for (;;) {
+                wake.wait_for(lock, std::chrono::milliseconds(intervalMs),
+                    [this] { return stopping || mergeRequested || flushRequested > flushCompleted; });
+                bool stop = stopping;
+                std::uint64_t flushTarget = flushRequested;
+                bool everything = stop || flushTarget > flushCompleted;
+                mergeRequested = false;
+                lock.unlock();
+                MergeRound(everything);
+                lock.lock();
+                if (flushTarget > flushCompleted) {
+                    flushCompleted = flushTarget;
+                    flushed.notify_all();
+                }
+                std::vector<std::function<void()>> ready;
+                auto firstPending = std::stable_partition(flushCallbacks.begin(), flushCallbacks.end(),
+                    [&](const auto& callback) { return callback.first <= flushCompleted || stop; });
+                for (auto it = flushCallbacks.begin(); it != firstPending; ++it) ready.push_back(std::move(it->second));
+                flushCallbacks.erase(flushCallbacks.begin(), firstPending);
+                if (!ready.empty()) {
+                    lock.unlock();
+                    for (auto& callback : ready) callback();
+                    lock.lock();
+                }
+                if (stop) {
+                    flushed.notify_all();
+                    return;
+                }
+            }
+        }
+
+        // Appends one record to the batch being merged
+        void Emit(ShardBuffer& buffer, const ShardRecord& record) {
+            if (record.deferred) {
+                EmitDeferred(buffer, record);
+                return;
+            }
+            ShardBatch::Line line;
+            line.offset = batch.text.size();
+            line.length = record.length;
+            line.headerLength = record.headerLength;
+            line.messageLength = record.messageLength;
+            line.messengerLength = record.messengerLength;
+            line.messengerInLine = record.messengerInLine;
+            line.messengerOffset = record.messengerOffset;
+            if (!record.messengerInLine) {
+                line.messengerOffset = batch.messengers.size();
+                batch.messengers.append(buffer.text, record.offset + record.length, record.messengerLength);
+            }
+            line.wallNs = record.key;
+            line.level = record.level;
+            batch.lines.push_back(line);
+            batch.text.append(buffer.text, record.offset, record.length);
+            batch.text.push_back('\n');
+            if (record.level > batch.maxLevel) batch.maxLevel = record.level;
+        }
+
+        void EmitDeferred(ShardBuffer& buffer, const ShardRecord& record) {
+            DeferredLine& deferred = buffer.deferred[record.deferred - 1];
+            deferredMessage.clear();
+            deferred.produce(deferredMessage);
+            std::string_view messenger(buffer.text.data() + record.offset, record.messengerLength);
+            ShardBatch::Line line;
+            line.offset = batch.text.size();
+            LayoutSpans spans = deferred.layout->Format(batch.text, deferred.stamp, record.level, deferredMessage, messenger);
+            line.length = batch.text.size() - line.offset;
+            line.headerLength = spans.headerLength;
+            line.messageLength = deferredMessage.size();
+            line.messengerLength = messenger.size();
+            line.messengerInLine = spans.messengerRendered || messenger.empty();
+            line.messengerOffset = spans.messengerOffset;
+            if (!line.messengerInLine) {
+                line.messengerOffset = batch.messengers.size();
+                batch.messengers.append(messenger.data(), messenger.size());
+            }
+            line.wallNs = record.key;
+            line.level = record.level;
+            batch.lines.push_back(line);
+            batch.text.push_back('\n');
+            if (record.level > batch.maxLevel) batch.maxLevel = record.level;
+        }
+
+        // Emits every record older than the watermark in (key, shard, seq) order. The
+        // watermark is taken before any shard is drained: a record enqueued after its
+        // shard's swap is stamped later, so nothing older than the watermark can still
+        // arrive (barring wall-clock steps). Younger records stay pending for the next round.
+        void MergeRound(bool everything) {
+            std::int64_t watermark = everything ? std::numeric_limits<std::int64_t>::max() : ClockToWallNs(ClockNow());
+            for (std::size_t i = 0; i < shards.size(); ++i) {
+                Shard& shard = shards[i];
+                {
+                    std::lock_guard<std::mutex> lock(shard.mutex);
+                    if (shard.active.records.empty()) continue;
+                    std::swap(shard.active, spare[i]);
+                    shard.wakeSent = false;
+                }
+                shard.drained.notify_all();
+                ShardBuffer& in = spare[i];
+                ShardBuffer& out = pending[i];
+                std::size_t base = out.text.size();
+                std::uint32_t deferredBase = static_cast<std::uint32_t>(out.deferred.size());
+                out.text.append(in.text);
+                for (ShardRecord record : in.records) {
+                    record.offset += base;
+                    if (record.deferred) record.deferred += deferredBase;
+                    out.records.push_back(record);
+                }
+                for (DeferredLine& deferred : in.deferred) out.deferred.push_back(std::move(deferred));
+                in.Clear();
+            }
+
+            using Head = std::tuple<std::int64_t, std::size_t, std::uint64_t>; // key, shard, seq
+            std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heap;
+            for (std::size_t i = 0; i < pending.size(); ++i) {
+                const auto& records = pending[i].records;
+                if (cursor[i] < records.size() && records[cursor[i]].key < watermark) {
+                    heap.emplace(records[cursor[i]].key, i, records[cursor[i]].seq);
+                }
+            }
+            if (heap.empty()) return;
+
+            batch.text.clear();
+            batch.messengers.clear();
+            batch.lines.clear();
+            batch.maxLevel = LogLevel::trace;
+            while (!heap.empty()) {
+                std::size_t i = std::get<1>(heap.top());
+                heap.pop();
+                // A batch shares one key, so its followers are below the watermark as well
+                std::size_t last = cursor[i] + pending[i].records[cursor[i]].following;
+                while (cursor[i] <= last) Emit(pending[i], pending[i].records[cursor[i]++]);
+                const auto& records = pending[i].records;
+                if (cursor[i] < records.size() && records[cursor[i]].key < watermark) {
+                    heap.emplace(records[cursor[i]].key, i, records[cursor[i]].seq);
+                }
+            }
+            deliver(batch);
+
+            // Records of a shard are in key order, so what was emitted is a prefix
+            for (std::size_t i = 0; i < pending.size(); ++i) {
+                ShardBuffer& buffer = pending[i];
+                if (cursor[i] == 0) continue;
+                if (cursor[i] == buffer.records.size()) {
+                    buffer.Clear();
+                }
+                else {
+                    std::size_t textStart = buffer.records[cursor[i]].offset;
+                    buffer.records.erase(buffer.records.begin(), buffer.records.begin() + static_cast<std::ptrdiff_t>(cursor[i]));
+                    // Deferred lines are in record order, so the emitted ones are a prefix too
+                    std::uint32_t deferredStart = static_cast<std::uint32_t>(buffer.deferred.size());
+                    for (const ShardRecord& record : buffer.records) {
+                        if (record.deferred) {
+                            deferredStart = record.deferred - 1;
+                            break;
+                        }
+                    }
+                    buffer.deferred.erase(buffer.deferred.begin(), buffer.deferred.begin() + deferredStart);
+                    for (ShardRecord& record : buffer.records) {
+                        record.offset -= textStart;
+                        if (record.deferred) record.deferred -= deferredStart;
+                    }
+                    buffer.text.erase(0, textStart);
+                }
+                cursor[i] = 0;
+            }
+        }
+
+        std::vector<Shard> shards;
+        std::vector<ShardBuffer> spare;     // swapped in for each shard's active buffer
+        std::vector<ShardBuffer> pending;   // drained, not yet emitted
+        std::vector<std::size_t> cursor;
+        ShardBatch batch;
+        std::string deferredMessage;
+        int intervalMs;
+        Deliver deliver;
+        std::atomic<std::uint64_t> stalls{ 0 };
+
+        std::mutex mergeMutex;
+        std::condition_variable wake;
+        std::condition_variable flushed;
+        bool stopping = false;
+        bool mergeRequested = false;
+        std::uint64_t flushRequested = 0;
+        std::uint64_t flushCompleted = 0;
+        std::vector<std::pair<std::uint64_t, std::function<void()>>> flushCallbacks;
+        std::thread merger;
+    };
+
+    detail::ShardedQueue::ShardedQueue(std::size_t shardCount, int mergeIntervalMs, Deliver deliver)
+        : state(std::make_unique<State>(shardCount ? shardCount : 1, mergeIntervalMs, std::move(deliver))) {}
+
+    detail::ShardedQueue::~ShardedQueue() = default;
+
+    void detail::ShardedQueue::Enqueue(const LogLayout& layout, LogLevel level, std::string_view message, std::string_view messenger,
+        std::string_view location, std::string_view messengerPrefix) {
+        state->Enqueue(layout, level, message, messenger, location, messengerPrefix, true);
+    }
+
+    void detail::ShardedQueue::EnqueueDeferred(const LogLayout& layout, LogLevel level, MessageProducer produce, std::string_view messenger) {
+        state->EnqueueDeferred(layout, level, std::move(produce), messenger);
+    }
+
+    void detail::ShardedQueue::EnqueueBatch(const LogLayout& layout, const LogBatch& lines) {
+        state->EnqueueBatch(layout, lines);
+    }
+
+    bool detail::ShardedQueue::TryEnqueue(const LogLayout& layout, LogLevel level, std::string_view message, std::string_view messenger,
+        std::string_view location, std::string_view messengerPrefix) {
+        return state->Enqueue(layout, level, message, messenger, location, messengerPrefix, false);
+    }
+
+    void detail::ShardedQueue::Flush() {
+        state->Flush();
+    }
+
+    void detail::ShardedQueue::FlushAsync(std::function<void()> done) {
+        state->FlushAsync(std::move(done));
+    }
+
+    std::uint64_t detail::ShardedQueue::Stalls() const {
+        return state->Stalls();
+    }
+}
@@ -0,0 +1,513 @@
+#include "../include/LogSharedRing.h"
+#include "../include/LogClock.h"
+#include "../include/Logger.h"
+#include "LogInternal.h"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sched.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+namespace C6Logger {
+
+#if defined(__linux__)
+
+    static constexpr std::uint32_t RING_MAGIC = 0x43365247; // "C6RG"
+    static constexpr std::uint32_t RING_VERSION = 2;
+    static constexpr std::uint32_t SLOT_HEADER_SIZE = 24;
+    static constexpr std::uint32_t SLOT_PAYLOAD = SHARED_RING_SLOT_SIZE - SLOT_HEADER_SIZE;
+    static constexpr std::uint32_t MAX_RECORD_SLOTS = SHARED_RING_SLOT_COUNT / 8;
+    static constexpr int PRODUCER_FULL_WAIT_US = 5000;
+    // Once a stall run has timed out, how long a further unclaimed ticket is given
+    // before it is reclaimed too (a live producer claims its slot within microseconds)
+    static constexpr std::int64_t UNCLAIMED_GRACE_NS = 200000;
+
+    // Slot state word: ticket * 4 + phase. A slot is free for ticket t when its
+    // state is t * 4; the collector releases it for the next lap as (t + N) * 4.
+    enum SlotPhase : std::uint64_t { PHASE_FREE = 0, PHASE_WRITING = 1, PHASE_READY = 2 };
+
+    struct alignas(64) RingHeader {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t slotCount;
+        std::uint32_t slotSize;
+        std::atomic<std::uint32_t> initState; // 0 = fresh, 1 = initializing, 2 = ready
+        alignas(64) std::atomic<std::uint64_t> tail; // next ticket handed to a producer
+        alignas(64) std::atomic<std::uint64_t> head; // next ticket the collector consumes
+        std::atomic<std::uint32_t> wakeWord;         // futex the collector sleeps on
+        std::atomic<std::uint32_t> collectorSleeping;
+        alignas(64) std::atomic<std::uint64_t> published;
+        std::atomic<std::uint64_t> dropped;
+        std::atomic<std::uint64_t> reclaimed;
+        std::atomic<std::uint64_t> corrupt;
+    };
+
+    struct alignas(64) RingSlot {
+        std::atomic<std::uint64_t> state;
+        std::atomic<std::int32_t> owner;  // pid of the claiming producer, 0 until known
+        std::uint32_t recordLength;       // first slot of a record only
+        std::uint32_t checksum;           // first slot of a record only
+        std::uint16_t slotCount;          // first slot of a record only, | SLOTS_BATCH
+        std::uint16_t headerLevel;        // first slot only: header length (line count) << 3 | level
+        char data[SLOT_PAYLOAD];
+    };
+    // A LogBatch record: a u16 header length per line, then the lines joined by '\n'
+    static constexpr std::uint16_t SLOTS_BATCH = 0x8000;
+    // Longer headers are not repeated on fragments anyway (see AppendRecordAtomic)
+    static constexpr std::size_t MAX_RING_HEADER = 0x1FFF;
+    static_assert(sizeof(RingSlot) == SHARED_RING_SLOT_SIZE, "ring slot layout");
+
+    struct RingMapping {
+        RingHeader* header = nullptr;
+        RingSlot* slots = nullptr;
+        std::size_t size = 0;
+        int fd = -1;
+    };
+
+    static std::uint32_t RecordChecksum(const char* data, std::size_t n) {
+        std::uint32_t h = 2166136261u;
+        for (std::size_t i = 0; i < n; ++i) {
+            h ^= static_cast<unsigned char>(data[i]);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    static void FutexWait(std::atomic<std::uint32_t>* word, std::uint32_t expected, int timeoutMs) {
+        struct timespec ts = { timeoutMs / 1000, (timeoutMs % 1000) * 1000000L };
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+    }
+
+    static void FutexWake(std::atomic<std::uint32_t>* word) {
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+    }
+
+    static void CloseRing(RingMapping* ring) {
+        if (!ring) return;
+        if (ring->header) munmap(ring->header, ring->size);
+        if (ring->fd >= 0) close(ring->fd);
+        delete ring;
+    }
+
+    static RingMapping* OpenRing(const std::string& name) {
+        std::string shmName = (!name.empty() && name[0] == '/') ? name : "/" + name;
+        int fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if (fd < 0) return nullptr;
+        auto* ring = new RingMapping();
+        ring->fd = fd;
+        ring->size = sizeof(RingHeader) + std::size_t(SHARED_RING_SLOT_COUNT) * SHARED_RING_SLOT_SIZE;
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            CloseRing(ring);
+            return nullptr;
+        }
+        if (st.st_size == 0 && ftruncate(fd, static_cast<off_t>(ring->size)) != 0) {
+            CloseRing(ring);
+            return nullptr;
+        }
+        if (st.st_size != 0 && static_cast<std::size_t>(st.st_size) != ring->size) {
+            CloseRing(ring); // created by an incompatible build
+            return nullptr;
+        }
+        void* base = mmap(nullptr, ring->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            CloseRing(ring);
+            return nullptr;
+        }
+        ring->header = static_cast<RingHeader*>(base);
+        ring->slots = reinterpret_cast<RingSlot*>(static_cast<char*>(base) + sizeof(RingHeader));
+
+        // Whichever process maps the fresh (zero-filled) object first lays it out
+        RingHeader* h = ring->header;
+        std::uint32_t fresh = 0;
+        if (h->initState.compare_exchange_strong(fresh, 1, std::memory_order_acq_rel)) {
+            h->magic = RING_MAGIC;
+            h->version = RING_VERSION;
+            h->slotCount = SHARED_RING_SLOT_COUNT;
+            h->slotSize = SHARED_RING_SLOT_SIZE;
+            for (std::uint32_t i = 0; i < SHARED_RING_SLOT_COUNT; ++i) {
+                ring->slots[i].state.store(std::uint64_t(i) * 4 + PHASE_FREE, std::memory_order_relaxed);
+                ring->slots[i].owner.store(0, std::memory_order_relaxed);
+            }
+            h->initState.store(2, std::memory_order_release);
+        }
+        else {
+            std::int64_t deadline = MonotonicNs() + 1000000000;
+            while (h->initState.load(std::memory_order_acquire) != 2) {
+                if (MonotonicNs() > deadline) {
+                    CloseRing(ring);
+                    return nullptr;
+                }
+                sched_yield();
+            }
+        }
+        if (h->magic != RING_MAGIC || h->version != RING_VERSION ||
+            h->slotCount != SHARED_RING_SLOT_COUNT || h->slotSize != SHARED_RING_SLOT_SIZE) {
+            CloseRing(ring);
+            return nullptr;
+        }
+        return ring;
+    }
+
+    // Producer mappings are intentionally never unmapped: a thread may still be
+    // publishing through one when the producer is disabled or switched.
+    static std::atomic<RingMapping*> producerRing{ nullptr };
+
+    bool EnableSharedRingProducer(const std::string& name) {
+        RingMapping* ring = OpenRing(name);
+        if (!ring) {
+            std::cerr << RED << "[ERROR] Failed to open shared log ring '" << name << "'." << RESET << std::endl;
+            return false;
+        }
+        producerRing.store(ring, std::memory_order_release);
+        return true;
+    }
+
+    void DisableSharedRingProducer() {
+        producerRing.store(nullptr, std::memory_order_release);
+    }
+
+    // Claims slots for one record, copies it in and publishes it; a ring that stays full
+    // drops it. The record must fit in MAX_RECORD_SLOTS slots (PublishLine splits longer lines).
+    static void PublishRecord(RingMapping* ring, std::uint16_t headerLevel, std::uint16_t flags, std::string_view line) {
+        RingHeader* h = ring->header;
+        const std::uint64_t n = SHARED_RING_SLOT_COUNT;
+
+        const std::size_t length = line.size();
+        const std::uint64_t k = length == 0 ? 1 : (length + SLOT_PAYLOAD - 1) / SLOT_PAYLOAD;
+
+        // Don't take tickets while the ring is visibly full; give the collector a moment first
+        std::int64_t deadline = MonotonicNs() + std::int64_t(PRODUCER_FULL_WAIT_US) * 1000;
+        while (h->tail.load(std::memory_order_relaxed) - h->head.load(std::memory_order_acquire) + k > n) {
+            if (MonotonicNs() > deadline) {
+                h->dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            sched_yield();
+        }
+
+        static const std::int32_t pid = static_cast<std::int32_t>(getpid());
+        std::uint64_t ticket = h->tail.fetch_add(k, std::memory_order_acq_rel);
+        for (std::uint64_t j = 0; j < k; ++j) {
+            RingSlot& slot = ring->slots[(ticket + j) % n];
+            std::uint64_t expected = (ticket + j) * 4 + PHASE_FREE;
+            bool claimed = false;
+            for (;;) {
+                std::uint64_t s = slot.state.load(std::memory_order_acquire);
+                if (s == expected) {
+                    if (slot.state.compare_exchange_weak(s, expected + PHASE_WRITING, std::memory_order_acq_rel)) {
+                        claimed = true;
+                        break;
+                    }
+                    continue;
+                }
+                // Our ticket was already reclaimed by the collector, or the ring never drained
+                if ((s >> 2) > ticket + j || MonotonicNs() > deadline) break;
+                sched_yield();
+            }
+            if (!claimed) {
+                // Hand back what we hold; the collector reclaims the rest after its stall timeout
+                for (std::uint64_t r = 0; r < j; ++r) {
+                    RingSlot& held = ring->slots[(ticket + r) % n];
+                    std::uint64_t mine = (ticket + r) * 4 + PHASE_WRITING;
+                    held.owner.store(0, std::memory_order_relaxed);
+                    held.state.compare_exchange_strong(mine, (ticket + r + n) * 4 + PHASE_FREE, std::memory_order_acq_rel);
+                }
+                h->dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            slot.owner.store(pid, std::memory_order_relaxed);
+        }
+
+        RingSlot& first = ring->slots[ticket % n];
+        first.recordLength = static_cast<std::uint32_t>(length);
+        first.checksum = RecordChecksum(line.data(), length);
+        first.slotCount = static_cast<std::uint16_t>(k | flags);
+        first.headerLevel = headerLevel;
+        for (std::uint64_t j = 0; j < k; ++j) {
+            std::size_t begin = std::size_t(j) * SLOT_PAYLOAD;
+            std::size_t chunk = std::min<std::size_t>(SLOT_PAYLOAD, length - begin);
+            std::memcpy(ring->slots[(ticket + j) % n].data, line.data() + begin, chunk);
+        }
+        // Publish back to front so a ready first slot implies the whole record is ready
+        for (std::uint64_t j = k; j-- > 0;) {
+            std::uint64_t writing = (ticket + j) * 4 + PHASE_WRITING;
+            ring->slots[(ticket + j) % n].state.compare_exchange_strong(writing, writing + 1, std::memory_order_acq_rel);
+        }
+        h->published.fetch_add(1, std::memory_order_relaxed);
+        h->wakeWord.fetch_add(1, std::memory_order_release);
+        if (h->collectorSleeping.load(std::memory_order_acquire)) FutexWake(&h->wakeWord);
+    }
+
+    static std::uint16_t HeaderLevel(std::size_t headerLength, LogLevel level) {
+        if (headerLength > MAX_RING_HEADER) headerLength = 0;
+        return static_cast<std::uint16_t>(headerLength << 3 | static_cast<std::size_t>(level));
+    }
+
+    // Publishes one line, splitting a line too long for one record into "[part k/n]"
+    // fragment records the way AtomicAppend splits lines too long for one write
+    static void PublishLine(RingMapping* ring, LogLevel level, std::string_view line, std::size_t headerLength) {
+        if (headerLength > line.size()) headerLength = 0;
+        const std::size_t recordLimit = std::size_t(MAX_RECORD_SLOTS) * SLOT_PAYLOAD;
+        if (line.size() <= recordLimit) {
+            PublishRecord(ring, HeaderLevel(headerLength, level), 0, line);
+            return;
+        }
+        if (headerLength > MAX_RING_HEADER) headerLength = 0;
+        detail::SplitIntoFragments(line, headerLength, recordLimit, [&](std::string& fragment) {
+            PublishRecord(ring, HeaderLevel(headerLength, level), 0, fragment);
+            return true;
+        });
+    }
+
+    bool detail::PublishToSharedRing(LogLevel level, std::string_view line, std::size_t headerLength) {
+        RingMapping* ring = producerRing.load(std::memory_order_acquire);
+        if (!ring) return false;
+        PublishLine(ring, level, line, headerLength);
+        return true;
+    }
+
+    bool detail::PublishBatchToSharedRing(std::string_view text, const std::vector<TextLine>& lines) {
+        RingMapping* ring = producerRing.load(std::memory_order_acquire);
+        if (!ring) return false;
+        auto line = [&](std::size_t i) {
+            std::size_t end = i + 1 < lines.size() ? lines[i + 1].offset : text.size();
+            return text.substr(lines[i].offset, end - lines[i].offset - 1);
+        };
+        std::size_t joined = text.empty() ? 0 : text.size() - 1;   // without the last newline
+        // The table has an entry per line of text: a message with newlines adds lines
+        // that have no header of their own
+        std::size_t textLines = static_cast<std::size_t>(std::count(text.begin(), text.end(), '\n'));
+        if (lines.size() < 2 || textLines > MAX_RING_HEADER || textLines * 2 + joined > std::size_t(MAX_RECORD_SLOTS) * SLOT_PAYLOAD) {
+            for (std::size_t i = 0; i < lines.size(); ++i) {
+                PublishLine(ring, lines[i].level, line(i), lines[i].headerLength);
+            }
+            return true;
+        }
+        struct BatchPayload;
+        std::string& payload = ThreadScratch<std::string, BatchPayload>();
+        payload.clear();
+        LogLevel maxLevel = LogLevel::trace;
+        for (std::size_t i = 0; i < lines.size(); ++i) {
+            const TextLine& l = lines[i];
+            std::size_t header = l.headerLength <= 0xFFFF ? l.headerLength : 0;
+            payload.push_back(static_cast<char>(header & 0xFF));
+            payload.push_back(static_cast<char>(header >> 8));
+            std::string_view body = line(i);
+            payload.append(2 * static_cast<std::size_t>(std::count(body.begin(), body.end(), '\n')), '\0');
+            if (l.level > maxLevel) maxLevel = l.level;
+        }
+        payload.append(text.data(), joined);
+        PublishRecord(ring, static_cast<std::uint16_t>(textLines << 3 | static_cast<std::size_t>(maxLevel)), SLOTS_BATCH, payload);
+        return true;
+    }
+
+    SharedRingCollector::SharedRingCollector(const std::string& name) {
+        RingMapping* opened = OpenRing(name);
+        if (!opened) {
+            std::cerr << RED << "[ERROR] Failed to open shared log ring '" << name << "'." << RESET << std::endl;
+            return;
+        }
+        // Exactly one collector per ring
+        if (flock(opened->fd, LOCK_EX | LOCK_NB) != 0) {
+            std::cerr << RED << "[ERROR] Shared log ring '" << name << "' already has a collector." << RESET << std::endl;
+            CloseRing(opened);
+            return;
+        }
+        ring = opened;
+        record.resize(std::size_t(MAX_RECORD_SLOTS) * SLOT_PAYLOAD);
+        pendingText.reserve(64 * 1024);
+        pendingHeaders.reserve(1024);
+    }
+
+    SharedRingCollector::~SharedRingCollector() {
+        CloseRing(ring);
+    }
+
+    bool SharedRingCollector::TryReclaim(std::uint64_t ticket, bool ownerKnownDead, bool claimed) {
+        std::int64_t now = MonotonicNs();
+        if (stallTicket != ticket) {
+            stallTicket = ticket;
+            stallSinceNs = now;
+        }
+        if (stallRunSinceNs == 0) stallRunSinceNs = now;
+        const std::int64_t timeoutNs = std::int64_t(stallTimeoutMs) * 1000000;
+        RingSlot& slot = ring->slots[ticket % SHARED_RING_SLOT_COUNT];
+        if (!ownerKnownDead) {
+            if (claimed) {
+                if (now - stallSinceNs < timeoutNs) return false;
+            }
+            else {
+                if (now - stallRunSinceNs < timeoutNs) return false;
+                // The run has timed out: give this ticket only a short grace
+                std::uint64_t seen = slot.state.load(std::memory_order_acquire);
+                while (MonotonicNs() - stallSinceNs < UNCLAIMED_GRACE_NS) {
+                    if (slot.state.load(std::memory_order_acquire) != seen) return false;
+                    sched_yield();
+                }
+            }
+        }
+        std::uint64_t s = slot.state.load(std::memory_order_acquire);
+        if ((s >> 2) != ticket || (s & 3) == PHASE_READY) return false; // moved on meanwhile
+        slot.owner.store(0, std::memory_order_relaxed);
+        if (!slot.state.compare_exchange_strong(s, (ticket + SHARED_RING_SLOT_COUNT) * 4 + PHASE_FREE, std::memory_order_acq_rel)) {
+            return false;
+        }
+        ring->header->reclaimed.fetch_add(1, std::memory_order_relaxed);
+        ring->header->head.store(ticket + 1, std::memory_order_release);
+        stallTicket = ~0ull;
+        return true;
+    }
+
+    std::size_t SharedRingCollector::Drain() {
+        if (!ring) return 0;
+        RingHeader* h = ring->header;
+        const std::uint64_t n = SHARED_RING_SLOT_COUNT;
+        std::size_t drained = 0;
+        pendingText.clear();
+        pendingHeaders.clear();
+        LogLevel maxLevel = LogLevel::trace;
+        // One lap at most: producers that keep pace would otherwise keep this loop going,
+        // with nothing reaching the file and pendingText growing
+        const std::uint64_t lapEnd = h->head.load(std::memory_order_relaxed) + n;
+        for (;;) {
+            std::uint64_t head = h->head.load(std::memory_order_relaxed);
+            if (head >= lapEnd) break;
+            RingSlot& slot = ring->slots[head % n];
+            std::uint64_t s = slot.state.load(std::memory_order_acquire);
+            std::uint64_t ticket = s >> 2;
+            std::uint64_t phase = s & 3;
+            if (ticket >= head + n) {
+                // Handed back by a producer that gave up on a full ring
+                h->head.store(head + 1, std::memory_order_release);
+                continue;
+            }
+            if (ticket != head) break; // not reachable with a consistent ring
+            if (phase == PHASE_READY) {
+                std::uint64_t k = slot.slotCount & ~SLOTS_BATCH;
+                bool batch = (slot.slotCount & SLOTS_BATCH) != 0;
+                std::uint32_t length = slot.recordLength;
+                bool valid = k >= 1 && k <= MAX_RECORD_SLOTS && length <= k * SLOT_PAYLOAD;
+                for (std::uint64_t j = 1; valid && j < k; ++j) {
+                    valid = ring->slots[(head + j) % n].state.load(std::memory_order_acquire) == (head + j) * 4 + PHASE_READY;
+                }
+                if (!valid) k = 1;
+                if (valid) {
+                    for (std::uint64_t j = 0; j < k; ++j) {
+                        std::size_t begin = std::size_t(j) * SLOT_PAYLOAD;
+                        std::size_t chunk = std::min<std::size_t>(SLOT_PAYLOAD, length - begin);
+                        std::memcpy(record.data() + begin, ring->slots[(head + j) % n].data, chunk);
+                    }
+                    valid = RecordChecksum(record.data(), length) == slot.checksum;
+                }
+                std::size_t lineCount = batch ? (slot.headerLevel >> 3) : 1;
+                if (valid && batch) valid = lineCount * 2 <= length;
+                if (valid) {
+                    if (batch) {
+                        const unsigned char* table = reinterpret_cast<const unsigned char*>(record.data());
+                        for (std::size_t i = 0; i < lineCount; ++i) pendingHeaders.push_back(table[2 * i] | std::size_t(table[2 * i + 1]) << 8);
+                        pendingText.append(record.data() + lineCount * 2, length - lineCount * 2);
+                    }
+                    else {
+                        // A message with newlines spans several lines of text; only the
+                        // first has a header
+                        pendingText.append(record.data(), length);
+                        pendingHeaders.push_back(slot.headerLevel >> 3);
+                        pendingHeaders.resize(pendingHeaders.size() + static_cast<std::size_t>(std::count(record.data(), record.data() + length, '\n')), 0);
+                    }
+                    pendingText.push_back('\n');
+                    std::uint8_t level = slot.headerLevel & 7;
+                    if (level > static_cast<std::uint8_t>(maxLevel) && level <= static_cast<std::uint8_t>(LogLevel::critical)) {
+                        maxLevel = static_cast<LogLevel>(level);
+                    }
+                    ++drained;
+                }
+                else {
+                    h->corrupt.fetch_add(1, std::memory_order_relaxed);
+                }
+                for (std::uint64_t j = 0; j < k; ++j) {
+                    RingSlot& done = ring->slots[(head + j) % n];
+                    done.owner.store(0, std::memory_order_relaxed);
+                    done.state.store((head + j + n) * 4 + PHASE_FREE, std::memory_order_release);
+                }
+                h->head.store(head + k, std::memory_order_release);
+                stallTicket = ~0ull;
+                stallRunSinceNs = 0;
+                continue;
+            }
+            if (phase == PHASE_WRITING) {
+                std::int32_t owner = slot.owner.load(std::memory_order_relaxed);
+                bool dead = owner > 0 && kill(owner, 0) != 0 && errno == ESRCH;
+                if (TryReclaim(head, dead, true)) continue;
+                break;
+            }
+            // Free for this ticket: either the ring is empty, or a producer took the
+            // ticket and has not claimed the slot yet (or died right after taking it)
+            if (h->tail.load(std::memory_order_acquire) <= head) {
+                stallRunSinceNs = 0;
+                break;
+            }
+            if (TryReclaim(head, false, false)) continue;
+            break;
+        }
+        if (!pendingText.empty()) detail::AppendLogText(pendingText, pendingHeaders, maxLevel);
+        collected += drained;
+        return drained;
+    }
+
+    void SharedRingCollector::Run(const std::atomic<bool>& stop) {
+        if (!ring) return;
+        RingHeader* h = ring->header;
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (Drain() > 0) continue;
+            h->collectorSleeping.store(1, std::memory_order_seq_cst);
+            std::uint32_t seq = h->wakeWord.load(std::memory_order_acquire);
+            bool pending = h->tail.load(std::memory_order_acquire) != h->head.load(std::memory_order_relaxed);
+            // A pending but unpublished record means a producer is mid-write or stalled: poll it
+            FutexWait(&h->wakeWord, seq, pending ? 5 : 100);
+            h->collectorSleeping.store(0, std::memory_order_relaxed);
+        }
+        while (Drain() > 0) {}
+    }
+
+    SharedRingStats SharedRingCollector::Stats() const {
+        SharedRingStats stats;
+        if (!ring) return stats;
+        stats.published = ring->header->published.load(std::memory_order_relaxed);
+        stats.dropped = ring->header->dropped.load(std::memory_order_relaxed);
+        stats.reclaimed = ring->header->reclaimed.load(std::memory_order_relaxed);
+        stats.corrupt = ring->header->corrupt.load(std::memory_order_relaxed);
+        stats.collected = collected;
+        return stats;
+    }
+
+#else // !__linux__
+
+    struct RingMapping {};
+
+    bool EnableSharedRingProducer(const std::string&) { return false; }
+    void DisableSharedRingProducer() {}
+    bool detail::PublishToSharedRing(LogLevel, std::string_view, std::size_t) { return false; }
+    bool detail::PublishBatchToSharedRing(std::string_view, const std::vector<TextLine>&) { return false; }
+
+    SharedRingCollector::SharedRingCollector(const std::string&) {}
+    SharedRingCollector::~SharedRingCollector() {}
+    bool SharedRingCollector::TryReclaim(std::uint64_t, bool, bool) { return false; }
+    std::size_t SharedRingCollector::Drain() { return 0; }
+    void SharedRingCollector::Run(const std::atomic<bool>&) {}
+    SharedRingStats SharedRingCollector::Stats() const { return SharedRingStats(); }
+
+#endif
+}
@@ -0,0 +1,137 @@
+#include "../include/LogSite.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+
+namespace C6Logger {
+
+    // Registration and the control functions take the mutex; logging never does
+    class LogSiteRegistry {
+    public:
+        static LogSiteRegistry& Get() {
+            // Leaked on purpose: handles in other static objects unregister at exit
+            static LogSiteRegistry* registry = new LogSiteRegistry();
+            return *registry;
+        }
+
+        void Add(LogSiteHandle& handle) {
+            std::lock_guard<std::mutex> lock(mutex);
+            handle.id = ++lastId;
+            for (const Rule& rule : rules) {
+                if (Matches(handle.site, rule.location)) handle.enabled.store(rule.enabled, std::memory_order_relaxed);
+            }
+            handles.push_back(&handle);
+        }
+
+        void Remove(LogSiteHandle& handle) {
+            std::lock_guard<std::mutex> lock(mutex);
+            handles.erase(std::remove(handles.begin(), handles.end(), &handle), handles.end());
+        }
+
+        std::vector<LogSiteInfo> Snapshot() {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::vector<LogSiteInfo> sites;
+            sites.reserve(handles.size());
+            for (const LogSiteHandle* handle : handles) {
+                LogSiteInfo info;
+                info.id = handle->id;
+                info.site = handle->site;
+                info.enabled = handle->enabled.load(std::memory_order_relaxed);
+                info.hits = handle->hits.load(std::memory_order_relaxed);
+                sites.push_back(info);
+            }
+            return sites;
+        }
+
+        bool SetEnabled(std::uint32_t id, bool enabled) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (LogSiteHandle* handle : handles) {
+                if (handle->id != id) continue;
+                handle->enabled.store(enabled, std::memory_order_relaxed);
+                return true;
+            }
+            return false;
+        }
+
+        std::size_t SetEnabled(std::string_view location, bool enabled) {
+            std::lock_guard<std::mutex> lock(mutex);
+            // A newer rule for the same location replaces the old one
+            rules.erase(std::remove_if(rules.begin(), rules.end(), [&](const Rule& rule) { return rule.location == location; }), rules.end());
+            rules.push_back({ std::string(location), enabled });
+            std::size_t matched = 0;
+            for (LogSiteHandle* handle : handles) {
+                if (!Matches(handle->site, location)) continue;
+                handle->enabled.store(enabled, std::memory_order_relaxed);
+                ++matched;
+            }
+            return matched;
+        }
+
+        void ResetHits() {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (LogSiteHandle* handle : handles) handle->hits.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        struct Rule {
+            std::string location;
+            bool enabled;
+        };
+
+        // "file" or "file:line" against the end of the site's path, on a path separator
+        static bool Matches(const LogSite& site, std::string_view location) {
+            std::string_view file = location;
+            int line = 0;
+            std::size_t colon = location.rfind(':');
+            if (colon != std::string_view::npos && colon + 1 < location.size() &&
+                location.find_first_not_of("0123456789", colon + 1) == std::string_view::npos) {
+                file = location.substr(0, colon);
+                line = std::atoi(std::string(location.substr(colon + 1)).c_str());
+            }
+            if (line != 0 && line != site.line) return false;
+            std::string_view path(site.file);
+            if (file.empty() || file.size() > path.size() || path.substr(path.size() - file.size()) != file) return false;
+            if (file.size() == path.size()) return true;
+            char before = path[path.size() - file.size() - 1];
+            return before == '/' || before == '\\';
+        }
+
+        std::mutex mutex;
+        std::vector<LogSiteHandle*> handles;
+        std::vector<Rule> rules;
+        std::uint32_t lastId = 0;
+    };
+
+    LogSiteHandle::LogSiteHandle(const LogSite& logSite) : site(logSite), messenger(logSite.messenger ? logSite.messenger : "") {
+        const char* file = site.file;
+        for (const char* p = site.file; *p; ++p) {
+            if (*p == '/' || *p == '\\') file = p + 1;
+        }
+        int n = std::snprintf(location, sizeof(location), "%s:%d", file, site.line);
+        locationLength = n < 0 ? 0 : std::min(static_cast<std::size_t>(n), sizeof(location) - 1);
+        LogSiteRegistry::Get().Add(*this);
+    }
+
+    LogSiteHandle::~LogSiteHandle() {
+        LogSiteRegistry::Get().Remove(*this);
+    }
+
+    std::vector<LogSiteInfo> GetLogSites() {
+        return LogSiteRegistry::Get().Snapshot();
+    }
+
+    bool SetLogSiteEnabled(std::uint32_t id, bool enabled) {
+        return LogSiteRegistry::Get().SetEnabled(id, enabled);
+    }
+
+    std::size_t SetLogSitesEnabled(std::string_view location, bool enabled) {
+        return LogSiteRegistry::Get().SetEnabled(location, enabled);
+    }
+
+    void ResetLogSiteHits() {
+        LogSiteRegistry::Get().ResetHits();
+    }
+}
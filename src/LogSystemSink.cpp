@@ -0,0 +1,384 @@
+#include "../include/LogSystemSink.h"
+#include "LogInternal.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define C6_SYSTEM_SINK_POSIX 1
+#endif
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+namespace C6Logger {
+
+    static constexpr std::size_t MAX_BATCH_RECORDS = 1024; // UIO_MAXIOV
+
+    // trace, debug, info, warning, error, critical -> syslog severities
+    static constexpr int LEVEL_SEVERITY[] = { 7, 7, 6, 4, 3, 2 };
+
+    // For lines handed to Write() directly: in the default layout the header is
+    // "[timestamp] [messenger] [LEVEL] " or "[timestamp] [LEVEL] ", and the
+    // messenger sits between the first and the last "] [".
+    static std::string_view HeaderMessenger(std::string_view header) {
+        std::size_t first = header.find("] [");
+        std::size_t last = header.rfind("] [");
+        if (first == std::string_view::npos || last == first) return std::string_view();
+        return header.substr(first + 3, last - first - 3);
+    }
+
+    // Journald native field: "KEY=value\n", or for values containing a newline
+    // "KEY\n" followed by the value's 64-bit little-endian length, the value and "\n"
+    static void AppendJournalField(std::string& out, std::string_view key, std::string_view value) {
+        out += key;
+        if (value.find('\n') == std::string_view::npos) {
+            out += '=';
+        }
+        else {
+            out += '\n';
+            std::uint64_t length = value.size();
+            for (int i = 0; i < 8; ++i) out += static_cast<char>((length >> (8 * i)) & 0xFF);
+        }
+        out += value;
+        out += '\n';
+    }
+
+    // RFC 5424 header fields are printable US-ASCII without spaces, of bounded length
+    static void AppendSyslogToken(std::string& out, std::string_view value, std::size_t maxLength) {
+        if (value.empty()) {
+            out += '-';
+            return;
+        }
+        std::size_t length = std::min(value.size(), maxLength);
+        for (std::size_t i = 0; i < length; ++i) {
+            unsigned char c = static_cast<unsigned char>(value[i]);
+            out += (c > 32 && c < 127) ? static_cast<char>(c) : '_';
+        }
+    }
+
+    static std::string ProgramName() {
+#if defined(__GLIBC__)
+        if (program_invocation_short_name && *program_invocation_short_name) return program_invocation_short_name;
+#endif
+        return "c6logger";
+    }
+
+    class SystemLogSink::State {
+    public:
+        explicit State(SystemSinkConfig sinkConfig) : config(std::move(sinkConfig)) {
+            if (config.batchRecords < 1) config.batchRecords = 1;
+            if (config.batchRecords > MAX_BATCH_RECORDS) config.batchRecords = MAX_BATCH_RECORDS;
+            if (config.flushIntervalMs < 1) config.flushIntervalMs = 1;
+            if (config.identifier.empty()) config.identifier = ProgramName();
+            if (config.socketPath.empty()) {
+                config.socketPath = config.format == SystemLogFormat::Journald ? "/run/systemd/journal/socket" : "/dev/log";
+            }
+#if defined(C6_SYSTEM_SINK_POSIX)
+            if (config.socketPath.size() >= sizeof(address.sun_path)) {
+                std::cerr << RED << "[ERROR] System log socket path '" << config.socketPath << "' is too long." << RESET << std::endl;
+                return;
+            }
+            address.sun_family = AF_UNIX;
+            std::memcpy(address.sun_path, config.socketPath.c_str(), config.socketPath.size() + 1);
+#if defined(__linux__)
+            fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+#else
+            fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+            if (fd >= 0) fcntl(fd, F_SETFD, FD_CLOEXEC);
+#endif
+            if (fd < 0) {
+                std::cerr << RED << "[ERROR] Failed to create a socket for the system log: " << std::strerror(errno) << RESET << std::endl;
+                return;
+            }
+            if (config.format == SystemLogFormat::Syslog) {
+                char name[256] = {};
+                if (gethostname(name, sizeof(name) - 1) == 0) hostname = name;
+                pid = std::to_string(static_cast<long long>(getpid()));
+            }
+            sender = std::thread([this] { Run(); });
+#else
+            std::cerr << RED << "[ERROR] The system log sink is not supported on this platform." << RESET << std::endl;
+#endif
+        }
+
+        ~State() {
+            if (sender.joinable()) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stopping = true;
+                }
+                wake.notify_all();
+                sender.join();
+            }
+#if defined(C6_SYSTEM_SINK_POSIX)
+            if (fd >= 0) close(fd);
+#endif
+        }
+
+        bool IsOpen() const {
+            return fd >= 0;
+        }
+
+        void Write(LogLevel level, std::string_view messenger, std::string_view message) {
+            if (fd < 0) return;
+            std::unique_lock<std::mutex> lock(mutex);
+            if (pending.text.size() >= config.maxPendingBytes) {
+                if (config.overflow == SinkOverflow::Drop) {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                wake.notify_one();
+                drained.wait(lock, [this] { return pending.text.size() < config.maxPendingBytes; });
+            }
+            message = message.substr(0, config.maxMessageBytes);
+            Datagram datagram;
+            datagram.offset = pending.text.size();
+            if (config.format == SystemLogFormat::Journald) FormatJournal(level, messenger, message);
+            else FormatSyslog(level, messenger, message);
+            datagram.length = pending.text.size() - datagram.offset;
+            pending.datagrams.push_back(datagram);
+            std::size_t count = pending.datagrams.size();
+            lock.unlock();
+            if (count == 1 || count == config.batchRecords) wake.notify_one();
+        }
+
+        void Flush() {
+            if (!sender.joinable()) return;
+            std::unique_lock<std::mutex> lock(mutex);
+            std::uint64_t ticket = ++flushRequested;
+            wake.notify_one();
+            flushed.wait(lock, [&] { return flushCompleted >= ticket; });
+        }
+
+        SystemSinkStats Stats() const {
+            SystemSinkStats stats;
+            stats.sent = sent.load(std::memory_order_relaxed);
+            stats.dropped = dropped.load(std::memory_order_relaxed);
+            stats.sendCalls = sendCalls.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+    private:
+        struct Datagram {
+            std::size_t offset;
+            std::size_t length;
+        };
+
+        struct Queue {
+            std::string text;
+            std::vector<Datagram> datagrams;
+        };
+
+        void FormatJournal(LogLevel level, std::string_view messenger, std::string_view message) {
+            std::string& out = pending.text;
+            out += "PRIORITY=";
+            out += static_cast<char>('0' + LEVEL_SEVERITY[static_cast<int>(level)]);
+            out += "\nSYSLOG_FACILITY=";
+            out += std::to_string(config.facility);
+            out += '\n';
+            if (config.messengerAsIdentifier) {
+                AppendJournalField(out, "SYSLOG_IDENTIFIER", messenger.empty() ? std::string_view(config.identifier) : messenger);
+            }
+            else {
+                AppendJournalField(out, "SYSLOG_IDENTIFIER", config.identifier);
+                if (!messenger.empty()) AppendJournalField(out, "C6_MESSENGER", messenger);
+            }
+            AppendJournalField(out, "MESSAGE", message);
+        }
+
+        void FormatSyslog(LogLevel level, std::string_view messenger, std::string_view message) {
+            std::string& out = pending.text;
+            out += '<';
+            out += std::to_string(config.facility * 8 + LEVEL_SEVERITY[static_cast<int>(level)]);
+            out += ">1 ";
+            AppendUtcTimestamp(out);
+            out += ' ';
+            AppendSyslogToken(out, hostname, 255);
+            out += ' ';
+            bool messengerIsApp = config.messengerAsIdentifier && !messenger.empty();
+            AppendSyslogToken(out, messengerIsApp ? messenger : std::string_view(config.identifier), 48);
+            out += ' ';
+            AppendSyslogToken(out, pid, 128);
+            out += ' ';
+            AppendSyslogToken(out, messengerIsApp ? std::string_view() : messenger, 32);
+            out += " - ";
+            out += message;
+        }
+
+        // "2026-10-16T17:10:00.123456Z"; the date part is cached per second
+        void AppendUtcTimestamp(std::string& out) {
+            std::int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            std::int64_t seconds = micros / 1000000;
+            if (seconds != cachedSecond) {
+                std::time_t t = static_cast<std::time_t>(seconds);
+                std::tm buf = {};
+#if defined(_MSC_VER)
+                gmtime_s(&buf, &t);
+#else
+                gmtime_r(&t, &buf);
+#endif
+                cachedLength = std::strftime(cachedText, sizeof(cachedText), "%Y-%m-%dT%H:%M:%S", &buf);
+                cachedSecond = seconds;
+            }
+            out.append(cachedText, cachedLength);
+            char fraction[16];
+            std::snprintf(fraction, sizeof(fraction), ".%06lldZ", static_cast<long long>(micros % 1000000));
+            out += fraction;
+        }
+
+        void Run() {
+            std::unique_lock<std::mutex> lock(mutex);
+            auto ready = [this] {
+                return stopping || flushRequested > flushCompleted || pending.datagrams.size() >= config.batchRecords;
+            };
+            for (;;) {
+                if (pending.datagrams.empty()) wake.wait(lock, [&] { return ready() || !pending.datagrams.empty(); });
+                if (!ready()) wake.wait_for(lock, std::chrono::milliseconds(config.flushIntervalMs), ready);
+                bool stop = stopping;
+                std::uint64_t flushTarget = flushRequested;
+                if (!pending.datagrams.empty()) {
+                    std::swap(pending, sending);
+                    lock.unlock();
+                    drained.notify_all();
+                    Send();
+                    sending.text.clear();
+                    sending.datagrams.clear();
+                    lock.lock();
+                }
+                if (flushTarget > flushCompleted) {
+                    flushCompleted = flushTarget;
+                    flushed.notify_all();
+                }
+                if (stop && pending.datagrams.empty()) return;
+            }
+        }
+
+        void Send() {
+#if defined(C6_SYSTEM_SINK_POSIX)
+            const std::size_t total = sending.datagrams.size();
+            const int flags = config.overflow == SinkOverflow::Drop ? MSG_DONTWAIT : 0;
+            iovecs.resize(config.batchRecords);
+#if defined(__linux__)
+            messages.resize(config.batchRecords);
+#endif
+            std::size_t next = 0;
+            while (next < total) {
+                std::size_t count = std::min(total - next, config.batchRecords);
+                for (std::size_t i = 0; i < count; ++i) {
+                    const Datagram& datagram = sending.datagrams[next + i];
+                    iovecs[i].iov_base = &sending.text[datagram.offset];
+                    iovecs[i].iov_len = datagram.length;
+                }
+#if defined(__linux__)
+                for (std::size_t i = 0; i < count; ++i) {
+                    msghdr& header = messages[i].msg_hdr;
+                    std::memset(&messages[i], 0, sizeof(messages[i]));
+                    header.msg_name = &address;
+                    header.msg_namelen = sizeof(address);
+                    header.msg_iov = &iovecs[i];
+                    header.msg_iovlen = 1;
+                }
+                int result = sendmmsg(fd, messages.data(), static_cast<unsigned>(count), flags);
+#else
+                msghdr header = {};
+                header.msg_name = &address;
+                header.msg_namelen = sizeof(address);
+                header.msg_iov = &iovecs[0];
+                header.msg_iovlen = 1;
+                int result = sendmsg(fd, &header, flags) >= 0 ? 1 : -1;
+#endif
+                sendCalls.fetch_add(1, std::memory_order_relaxed);
+                if (result > 0) {
+                    sent.fetch_add(static_cast<std::uint64_t>(result), std::memory_order_relaxed);
+                    next += static_cast<std::size_t>(result);
+                    lastError = 0;
+                    continue;
+                }
+                int error = errno;
+                if (error == EINTR) continue;
+                if (error == EAGAIN || error == EWOULDBLOCK || error == ENOBUFS) {
+                    // Only reachable with MSG_DONTWAIT: the daemon is behind, shed the rest of this round
+                    dropped.fetch_add(total - next, std::memory_order_relaxed);
+                    return;
+                }
+                // Daemon not running, restarting, or the datagram is too large: lose
+                // this record and keep going, reporting each new error once
+                if (error != lastError) {
+                    std::cerr << RED << "[ERROR] Failed to send to the system log at '" << config.socketPath << "': "
+                        << std::strerror(error) << RESET << std::endl;
+                    lastError = error;
+                }
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                ++next;
+            }
+#endif
+        }
+
+        SystemSinkConfig config;
+        std::string hostname;
+        std::string pid;
+        std::int64_t cachedSecond = -1;
+        char cachedText[32] = {};
+        std::size_t cachedLength = 0;
+
+        int fd = -1;
+#if defined(C6_SYSTEM_SINK_POSIX)
+        sockaddr_un address = {};
+        std::vector<iovec> iovecs;
+#if defined(__linux__)
+        std::vector<mmsghdr> messages;
+#endif
+#endif
+        int lastError = 0;
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable drained;
+        std::condition_variable flushed;
+        Queue pending;    // filled by Write()
+        Queue sending;    // owned by the sender thread
+        bool stopping = false;
+        std::uint64_t flushRequested = 0;
+        std::uint64_t flushCompleted = 0;
+        std::thread sender;
+
+        std::atomic<std::uint64_t> sent{ 0 };
+        std::atomic<std::uint64_t> dropped{ 0 };
+        std::atomic<std::uint64_t> sendCalls{ 0 };
+    };
+
+    SystemLogSink::SystemLogSink(SystemSinkConfig config) : state(std::make_unique<State>(std::move(config))) {}
+
+    SystemLogSink::~SystemLogSink() = default;
+
+    bool SystemLogSink::IsOpen() const {
+        return state->IsOpen();
+    }
+
+    void SystemLogSink::Write(LogLevel level, std::string_view line, std::size_t headerLength) {
+        headerLength = std::min(headerLength, line.size());
+        state->Write(level, HeaderMessenger(line.substr(0, headerLength)), line.substr(headerLength));
+    }
+
+    void SystemLogSink::WriteRecord(const LogRecordView& record) {
+        state->Write(record.level, record.messenger, record.message);
+    }
+
+    void SystemLogSink::Flush() {
+        state->Flush();
+    }
+
+    SystemSinkStats SystemLogSink::Stats() const {
+        return state->Stats();
+    }
+}
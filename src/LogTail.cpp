@@ -0,0 +1,440 @@
+#include "../include/LogTail.h"
+#include "LogInternal.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define C6_TAIL_POSIX 1
+#endif
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace C6Logger {
+
+    static std::uint64_t HashLine(std::string_view line) {
+        // FNV-1a over the line without the compaction repeat suffix, so a line keeps
+        // its identity when compaction later appends " (repeated N times)" to it.
+        std::size_t count = 0, suffixStart = 0;
+        if (detail::TryParseRepeatSuffix(line, count, suffixStart)) {
+            line = line.substr(0, suffixStart);
+        }
+        std::uint64_t h = 1469598103934665603ull;
+        for (char c : line) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 1099511628211ull;
+        }
+        return h == 0 ? 1 : h; // 0 is reserved for "nothing delivered yet"
+    }
+
+    static std::uint64_t ParseStamp(std::string_view line) {
+        // "[YYYY-MM-DD HH:MM:SS..." -> YYYYMMDDhhmmss
+        static constexpr int digitPos[] = { 1, 2, 3, 4, 6, 7, 9, 10, 12, 13, 15, 16, 18, 19 };
+        if (line.size() < 20 || line[0] != '[') return 0;
+        std::uint64_t v = 0;
+        for (int p : digitPos) {
+            char c = line[static_cast<std::size_t>(p)];
+            if (!std::isdigit(static_cast<unsigned char>(c))) return 0;
+            v = v * 10 + static_cast<std::uint64_t>(c - '0');
+        }
+        return v;
+    }
+
+    std::string TailCursor::Serialize() const {
+        char text[160];
+        std::snprintf(text, sizeof(text), "c6tail1:%llx:%llx:%llx:%llx:%x:%llx",
+            static_cast<unsigned long long>(device), static_cast<unsigned long long>(inode),
+            static_cast<unsigned long long>(offset), static_cast<unsigned long long>(lastLineHash),
+            static_cast<unsigned>(lastLineLength), static_cast<unsigned long long>(lastStamp));
+        return text;
+    }
+
+    bool TailCursor::Deserialize(const std::string& text, TailCursor& out) {
+        static const std::string tag = "c6tail1:";
+        if (text.compare(0, tag.size(), tag) != 0) return false;
+        std::uint64_t fields[6];
+        const char* p = text.c_str() + tag.size();
+        for (int i = 0; i < 6; ++i) {
+            char* end = nullptr;
+            fields[i] = std::strtoull(p, &end, 16);
+            if (end == p) return false;
+            if (i < 5 && *end != ':') return false;
+            if (i == 5 && *end != '\0') return false;
+            p = end + 1;
+        }
+        out.device = fields[0];
+        out.inode = fields[1];
+        out.offset = fields[2];
+        out.lastLineHash = fields[3];
+        out.lastLineLength = static_cast<std::uint32_t>(fields[4]);
+        out.lastStamp = fields[5];
+        return true;
+    }
+
+    LogTail::LogTail(std::string logPath)
+        : LogTail(std::move(logPath), TailCursor()) {
+    }
+
+    LogTail::LogTail(std::string logPath, const TailCursor& resumeFrom)
+        : path(std::move(logPath)), cursor(resumeFrom) {
+        std::filesystem::path p(path);
+        fileName = p.filename().string();
+        buffer.resize(CHUNK_SIZE);
+        views.reserve(CHUNK_SIZE / 32);
+#if defined(__linux__)
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd >= 0) {
+            std::string dir = p.has_parent_path() ? p.parent_path().string() : std::string(".");
+            // Watch the directory rather than the file so rename/recreate rotation is seen too
+            watchFd = inotify_add_watch(inotifyFd, dir.c_str(),
+                IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO);
+            if (watchFd < 0) {
+                close(inotifyFd);
+                inotifyFd = -1;
+            }
+        }
+#endif
+        OpenFile();
+    }
+
+    LogTail::~LogTail() {
+        CloseFile();
+#if defined(__linux__)
+        if (inotifyFd >= 0) close(inotifyFd);
+#endif
+    }
+
+    // Identity, size and modification time of a path, for the polling fallback
+    struct PathState {
+        std::uint64_t inode = 0;   // 0 where the platform has no file identities
+        std::uint64_t size = 0;
+        std::int64_t mtimeNs = 0;
+    };
+
+#if defined(C6_TAIL_POSIX)
+
+    static bool StatPath(const std::string& path, PathState& out) {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) return false;
+        out.inode = static_cast<std::uint64_t>(st.st_ino);
+        out.size = static_cast<std::uint64_t>(st.st_size);
+#if defined(__APPLE__)
+        out.mtimeNs = static_cast<std::int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+        out.mtimeNs = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+        return true;
+    }
+
+    bool LogTail::OpenFile() {
+        fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            CloseFile();
+            return false;
+        }
+        // A resumed cursor may come from a file that has since been replaced; Next()
+        // verifies the position against the last delivered line before reading on.
+        cursor.device = static_cast<std::uint64_t>(st.st_dev);
+        cursor.inode = static_cast<std::uint64_t>(st.st_ino);
+        return true;
+    }
+
+    void LogTail::CloseFile() {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+
+    bool LogTail::CheckRotation() {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) return false; // rotated away, not recreated yet
+        if (static_cast<std::uint64_t>(st.st_ino) == cursor.inode &&
+            static_cast<std::uint64_t>(st.st_dev) == cursor.device) {
+            return false;
+        }
+        // Old file fully drained by the caller; start the new one from the beginning
+        CloseFile();
+        cursor = TailCursor();
+        return OpenFile();
+    }
+
+    bool LogTail::IsOpen() const {
+        return fd >= 0;
+    }
+
+    std::int64_t LogTail::ReadAt(std::uint64_t offset, char* data, std::size_t size) {
+        return pread(fd, data, size, static_cast<off_t>(offset));
+    }
+
+    bool LogTail::OpenSize(std::uint64_t& size) {
+        struct stat st;
+        if (fstat(fd, &st) != 0) return false;
+        size = static_cast<std::uint64_t>(st.st_size);
+        return true;
+    }
+
+#else // !C6_TAIL_POSIX
+
+    // Standard library file access. There are no file identities to compare, so a
+    // rotation shows up as a file whose contents no longer match the cursor.
+    static bool StatPath(const std::string& path, PathState& out) {
+        std::error_code ec;
+        std::uint64_t size = static_cast<std::uint64_t>(std::filesystem::file_size(path, ec));
+        if (ec) return false;
+        auto mtime = std::filesystem::last_write_time(path, ec);
+        if (ec) return false;
+        out.size = size;
+        out.mtimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(mtime.time_since_epoch()).count();
+        return true;
+    }
+
+    bool LogTail::OpenFile() {
+        stream = std::make_unique<std::ifstream>(path, std::ios::binary);
+        if (!stream->is_open()) {
+            CloseFile();
+            return false;
+        }
+        return true;
+    }
+
+    void LogTail::CloseFile() {
+        stream.reset();
+    }
+
+    bool LogTail::CheckRotation() {
+        // Reopen the path once caught up; Next() then checks the cursor against it
+        PathState st;
+        if (!StatPath(path, st)) return false;
+        CloseFile();
+        return OpenFile();
+    }
+
+    bool LogTail::IsOpen() const {
+        return stream != nullptr;
+    }
+
+    std::int64_t LogTail::ReadAt(std::uint64_t offset, char* data, std::size_t size) {
+        stream->clear();
+        stream->seekg(static_cast<std::streamoff>(offset));
+        if (!*stream) return -1;
+        stream->read(data, static_cast<std::streamsize>(size));
+        return static_cast<std::int64_t>(stream->gcount());
+    }
+
+    bool LogTail::OpenSize(std::uint64_t& size) {
+        stream->clear();
+        stream->seekg(0, std::ios::end);
+        std::streamoff end = stream->tellg();
+        if (end < 0) return false;
+        size = static_cast<std::uint64_t>(end);
+        return true;
+    }
+
+#endif
+
+    bool LogTail::VerifyCursor() {
+        std::uint64_t size = 0;
+        if (!OpenSize(size) || size < cursor.offset) return false;
+        if (cursor.lastLineHash == 0 || cursor.offset == 0) return true;
+        std::uint64_t need = static_cast<std::uint64_t>(cursor.lastLineLength) + 1;
+        if (need > cursor.offset) return false;
+        if (buffer.size() < need) buffer.resize(static_cast<std::size_t>(need));
+        std::int64_t n = ReadAt(cursor.offset - need, buffer.data(), static_cast<std::size_t>(need));
+        if (n != static_cast<std::int64_t>(need) || buffer[need - 1] != '\n') return false;
+        std::size_t len = cursor.lastLineLength;
+        if (len > 0 && buffer[len - 1] == '\r') --len;
+        return HashLine(std::string_view(buffer.data(), len)) == cursor.lastLineHash;
+    }
+
+    void LogTail::Resync() {
+        // The bytes before the cursor changed: find the last delivered line again.
+        // Exact match first; otherwise resume after the last line that is strictly older
+        // than it, which compaction keeps in timestamp order (at-least-once delivery).
+        std::uint64_t exactEnd = 0, olderEnd = 0;
+        bool exactFound = false;
+        std::uint64_t pos = 0;
+        std::size_t carry = 0;
+        for (;;) {
+            std::int64_t n = ReadAt(pos + carry, buffer.data() + carry, buffer.size() - carry);
+            if (n <= 0) break;
+            std::size_t avail = carry + static_cast<std::size_t>(n);
+            std::size_t start = 0;
+            for (std::size_t i = 0; i < avail; ++i) {
+                if (buffer[i] != '\n') continue;
+                std::string_view line(buffer.data() + start, i - start);
+                std::uint64_t lineEnd = pos + i + 1;
+                if (!line.empty()) {
+                    if (HashLine(line) == cursor.lastLineHash) {
+                        exactEnd = lineEnd;
+                        exactFound = true;
+                    }
+                    std::uint64_t stamp = ParseStamp(line);
+                    if (stamp != 0 && cursor.lastStamp != 0 && stamp < cursor.lastStamp) olderEnd = lineEnd;
+                }
+                start = i + 1;
+            }
+            if (start == 0 && avail == buffer.size()) {
+                buffer.resize(buffer.size() * 2); // single line longer than the buffer
+                carry = avail;
+                continue;
+            }
+            std::memmove(buffer.data(), buffer.data() + start, avail - start);
+            carry = avail - start;
+            pos += start;
+        }
+        cursor.offset = exactFound ? exactEnd : olderEnd;
+        if (!exactFound) {
+            cursor.lastLineHash = 0;
+            cursor.lastLineLength = 0;
+        }
+        pendingResync = true;
+    }
+
+    bool LogTail::FillBatch(TailBatch& batch) {
+        for (;;) {
+            std::int64_t n = ReadAt(cursor.offset, buffer.data(), buffer.size());
+            if (n <= 0) return false;
+            std::size_t avail = static_cast<std::size_t>(n);
+            const char* data = buffer.data();
+            // Zero bytes are preallocated space (Preallocation::ExplicitSize) or a record
+            // another writer has reserved but not written yet: stop in front of them
+            if (const void* zero = std::memchr(data, 0, avail)) {
+                avail = static_cast<std::size_t>(static_cast<const char*>(zero) - data);
+                if (avail == 0) {
+                    std::size_t run = 0;
+                    while (run < static_cast<std::size_t>(n) && data[run] == '\0') ++run;
+                    if (run == static_cast<std::size_t>(n)) return false; // end of the written data
+                    // Records follow the hole; if it stays for a second its writer died
+                    std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch()).count();
+                    if (holeOffset != cursor.offset) {
+                        holeOffset = cursor.offset;
+                        holeSinceNs = now;
+                        return false;
+                    }
+                    if (now - holeSinceNs < 1000000000) return false;
+                    cursor.offset += run;
+                    continue;
+                }
+            }
+            const void* nl = nullptr;
+            for (std::size_t i = avail; i > 0; --i) {
+                if (data[i - 1] == '\n') { nl = data + i - 1; break; }
+            }
+            if (!nl) {
+                if (avail < buffer.size()) return false; // partial line still being written
+                buffer.resize(buffer.size() * 2);
+                continue;
+            }
+            std::size_t used = static_cast<std::size_t>(static_cast<const char*>(nl) - data) + 1;
+            views.clear();
+            std::size_t start = 0;
+            for (std::size_t i = 0; i < used; ++i) {
+                if (data[i] != '\n') continue;
+                std::size_t end = i;
+                if (end > start && data[end - 1] == '\r') --end;
+                if (end > start) views.emplace_back(data + start, end - start);
+                start = i + 1;
+            }
+            cursor.offset += used;
+            if (!views.empty()) {
+                const std::string_view& last = views.back();
+                // Length of the raw line as stored, including a stripped '\r'
+                std::size_t rawLen = static_cast<std::size_t>(data + used - 1 - last.data());
+                cursor.lastLineHash = HashLine(last);
+                cursor.lastLineLength = static_cast<std::uint32_t>(rawLen);
+                std::uint64_t stamp = ParseStamp(last);
+                if (stamp != 0) cursor.lastStamp = stamp;
+            }
+            else {
+                continue; // only blank lines in this chunk
+            }
+            batch.lines = views.data();
+            batch.count = views.size();
+            batch.resynced = pendingResync;
+            pendingResync = false;
+            return true;
+        }
+    }
+
+    bool LogTail::Next(TailBatch& batch) {
+        batch = TailBatch();
+        if (!IsOpen() && !OpenFile()) return false;
+        if (!VerifyCursor()) Resync();
+        if (FillBatch(batch)) return true;
+        if (!CheckRotation()) return false;
+        if (!VerifyCursor()) Resync();
+        return FillBatch(batch);
+    }
+
+    bool LogTail::Wait(int timeoutMs) {
+#if defined(__linux__)
+        if (inotifyFd >= 0) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+            alignas(struct inotify_event) char events[4096];
+            for (;;) {
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+                if (left < 0) left = 0;
+                struct pollfd pfd = { inotifyFd, POLLIN, 0 };
+                if (poll(&pfd, 1, static_cast<int>(left)) <= 0) return false;
+                bool relevant = false;
+                ssize_t n;
+                while ((n = read(inotifyFd, events, sizeof(events))) > 0) {
+                    for (char* p = events; p < events + n;) {
+                        auto* ev = reinterpret_cast<struct inotify_event*>(p);
+                        if (ev->len > 0 && fileName == ev->name) relevant = true;
+                        if (ev->mask & IN_Q_OVERFLOW) relevant = true;
+                        p += sizeof(struct inotify_event) + ev->len;
+                    }
+                }
+                if (relevant) return true;
+                if (left == 0) return false;
+            }
+        }
+#endif
+        // Polling fallback: watch inode, size and mtime of the path
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        for (;;) {
+            PathState st;
+            if (StatPath(path, st)) {
+                bool changed = st.inode != seenInode || st.size != seenSize || st.mtimeNs != seenMtimeNs;
+                seenInode = st.inode;
+                seenSize = st.size;
+                seenMtimeNs = st.mtimeNs;
+                if (changed) return true;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+
+
+    std::size_t LogTail::Poll(const std::function<void(const TailBatch&)>& onBatch) {
+        std::size_t delivered = 0;
+        TailBatch batch;
+        while (Next(batch)) {
+            delivered += batch.count;
+            onBatch(batch);
+        }
+        return delivered;
+    }
+
+    void LogTail::Follow(const std::function<void(const TailBatch&)>& onBatch, const std::atomic<bool>& stop, int pollIntervalMs) {
+        while (!stop.load(std::memory_order_relaxed)) {
+            Poll(onBatch);
+            Wait(pollIntervalMs);
+        }
+        Poll(onBatch);
+    }
+}
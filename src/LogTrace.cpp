@@ -0,0 +1,317 @@
+#include "../include/LogTrace.h"
+#include "../include/LogClock.h"
+#include "LogInternal.h"
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace C6Logger {
+
+    struct SpanRecord {
+        std::uint64_t begin;
+        std::uint64_t end;
+        const char* name;
+        const char* messenger;
+        const char* argKeys[TraceSpan::MAX_ARGS];
+        std::int64_t argValues[TraceSpan::MAX_ARGS];
+        int argCount;
+    };
+
+    // Spans of one thread. Only the owning thread appends; exporters read the
+    // published prefix [0, count). Chunks are allocated on demand and never move.
+    // When the thread exits the buffer is retired: its spans still export until the
+    // next StartTracing(), and a new thread may take it over once they are stale.
+    struct ThreadTraceBuffer {
+        static constexpr std::size_t CHUNK_SPANS = 4096;
+        static constexpr std::size_t MAX_CHUNKS = 256;
+
+        std::atomic<SpanRecord*> chunks[MAX_CHUNKS] = {};
+        std::atomic<std::size_t> count{ 0 };
+        std::atomic<std::uint64_t> epoch{ 0 };
+        std::atomic<const char*> threadName{ nullptr };
+        std::atomic<bool> retired{ false };
+        std::uint64_t tid = 0;
+
+        ~ThreadTraceBuffer() {
+            for (auto& chunk : chunks) delete[] chunk.load(std::memory_order_relaxed);
+        }
+    };
+
+    static std::atomic<bool> tracingEnabled{ false };
+    static std::atomic<std::uint64_t> traceEpoch{ 1 };
+    static std::atomic<std::uint64_t> droppedSpans{ 0 };
+    static std::atomic<bool> traceLogging{ false };
+    static std::atomic<LogLevel> traceLogLevel{ LogLevel::trace };
+
+    static std::mutex registryMutex;
+    static std::vector<std::unique_ptr<ThreadTraceBuffer>>& Registry() {
+        static std::vector<std::unique_ptr<ThreadTraceBuffer>> buffers;
+        return buffers;
+    }
+
+    static std::uint64_t CurrentThreadId() {
+#if defined(__linux__)
+        return static_cast<std::uint64_t>(syscall(SYS_gettid));
+#else
+        return static_cast<std::uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()) & 0xFFFFFFFF);
+#endif
+    }
+
+    // The calling thread's buffer, or nullptr once its thread_local destructors ran.
+    // Buffers outlive their threads so spans of finished threads still export.
+    static ThreadTraceBuffer* LocalBuffer() {
+        static thread_local ThreadTraceBuffer* local = nullptr;
+        static thread_local bool exited = false;
+        struct Retirer {
+            ~Retirer() {
+                if (local) local->retired.store(true, std::memory_order_release);
+                local = nullptr;
+                exited = true;
+            }
+        };
+        if (local || exited) return local;
+        std::uint64_t epoch = traceEpoch.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(registryMutex);
+        // Take over the buffer of an exited thread whose spans no capture needs any more
+        for (const auto& buffer : Registry()) {
+            if (!buffer->retired.load(std::memory_order_acquire)) continue;
+            if (buffer->epoch.load(std::memory_order_relaxed) == epoch && buffer->count.load(std::memory_order_relaxed) != 0) continue;
+            buffer->count.store(0, std::memory_order_relaxed);
+            buffer->threadName.store(nullptr, std::memory_order_relaxed);
+            buffer->retired.store(false, std::memory_order_relaxed);
+            local = buffer.get();
+            break;
+        }
+        if (!local) {
+            Registry().push_back(std::make_unique<ThreadTraceBuffer>());
+            local = Registry().back().get();
+        }
+        local->tid = CurrentThreadId();
+        local->epoch.store(epoch, std::memory_order_relaxed);
+        static thread_local Retirer retirer;
+        (void)retirer;
+        return local;
+    }
+
+    void StartTracing() {
+        traceEpoch.fetch_add(1, std::memory_order_acq_rel);
+        droppedSpans.store(0, std::memory_order_relaxed);
+        {
+            // Buffers of exited threads only held spans of the capture just discarded
+            std::lock_guard<std::mutex> lock(registryMutex);
+            auto& buffers = Registry();
+            buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                [](const std::unique_ptr<ThreadTraceBuffer>& buffer) { return buffer->retired.load(std::memory_order_acquire); }),
+                buffers.end());
+        }
+        tracingEnabled.store(true, std::memory_order_release);
+    }
+
+    void StopTracing() {
+        tracingEnabled.store(false, std::memory_order_release);
+    }
+
+    bool IsTracing() {
+        return tracingEnabled.load(std::memory_order_relaxed);
+    }
+
+    void SetTraceLogging(bool enabled, LogLevel level) {
+        traceLogLevel.store(level, std::memory_order_relaxed);
+        traceLogging.store(enabled, std::memory_order_relaxed);
+    }
+
+    void SetTraceThreadName(const char* name) {
+        if (ThreadTraceBuffer* buffer = LocalBuffer()) buffer->threadName.store(name, std::memory_order_release);
+    }
+
+    std::uint64_t DroppedTraceSpans() {
+        return droppedSpans.load(std::memory_order_relaxed);
+    }
+
+    TraceSpan::TraceSpan(const char* spanName, const char* spanMessenger)
+        : begin(0), name(spanName), messenger(spanMessenger) {
+        if (tracingEnabled.load(std::memory_order_relaxed)) begin = ClockNow();
+    }
+
+    TraceSpan& TraceSpan::Arg(const char* key, std::int64_t value) {
+        if (argCount < MAX_ARGS) {
+            argKeys[argCount] = key;
+            argValues[argCount] = value;
+            ++argCount;
+        }
+        return *this;
+    }
+
+    TraceSpan::~TraceSpan() {
+        if (begin == 0) return;
+        std::uint64_t end = ClockNow();
+
+        // Null for a span ended by a destructor that ran after its thread's buffer was retired
+        ThreadTraceBuffer* buffer = LocalBuffer();
+        std::uint64_t epoch = traceEpoch.load(std::memory_order_relaxed);
+        if (buffer && buffer->epoch.load(std::memory_order_relaxed) != epoch) {
+            // Publish the new epoch before any slot is rewritten; an exporter that copied
+            // a slot re-checks the epoch afterwards and drops the buffer if it moved
+            buffer->epoch.store(epoch, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            buffer->count.store(0, std::memory_order_relaxed);
+        }
+        std::size_t index = buffer ? buffer->count.load(std::memory_order_relaxed) : 0;
+        std::size_t chunkIndex = index / ThreadTraceBuffer::CHUNK_SPANS;
+        if (!buffer || chunkIndex >= ThreadTraceBuffer::MAX_CHUNKS) {
+            droppedSpans.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            SpanRecord* chunk = buffer->chunks[chunkIndex].load(std::memory_order_relaxed);
+            if (!chunk) {
+                chunk = new SpanRecord[ThreadTraceBuffer::CHUNK_SPANS];
+                buffer->chunks[chunkIndex].store(chunk, std::memory_order_release);
+            }
+            SpanRecord& record = chunk[index % ThreadTraceBuffer::CHUNK_SPANS];
+            record.begin = begin;
+            record.end = end;
+            record.name = name;
+            record.messenger = messenger;
+            record.argCount = argCount;
+            for (int i = 0; i < argCount; ++i) {
+                record.argKeys[i] = argKeys[i];
+                record.argValues[i] = argValues[i];
+            }
+            buffer->count.store(index + 1, std::memory_order_release);
+        }
+
+        if (traceLogging.load(std::memory_order_relaxed)) {
+            std::int64_t durationNs = ClockToWallNs(end) - ClockToWallNs(begin);
+            char text[256];
+            int n = std::snprintf(text, sizeof(text), "span %s took %lld.%03lld us", name ? name : "",
+                static_cast<long long>(durationNs / 1000), static_cast<long long>(durationNs % 1000));
+            if (n > 0) {
+                std::size_t length = static_cast<std::size_t>(n) < sizeof(text) ? static_cast<std::size_t>(n) : sizeof(text) - 1;
+                Log(traceLogLevel.load(std::memory_order_relaxed), std::string_view(text, length),
+                    std::string_view(messenger ? messenger : ""));
+            }
+        }
+    }
+
+    static void AppendJsonString(std::string& out, const char* text) {
+        out += '"';
+        for (const char* p = text ? text : ""; *p; ++p) {
+            unsigned char c = static_cast<unsigned char>(*p);
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += static_cast<char>(c);
+            }
+            else if (c < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            }
+            else {
+                out += static_cast<char>(c);
+            }
+        }
+        out += '"';
+    }
+
+    // Trace-event timestamps are microseconds; print ns precision without going through double
+    static void AppendMicros(std::string& out, std::int64_t ns) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%lld.%03lld", static_cast<long long>(ns / 1000), static_cast<long long>(ns % 1000));
+        out += text;
+    }
+
+    bool WriteChromeTrace(const std::string& path) {
+        std::string outPath = path;
+        if (outPath.empty()) {
+            outPath = (std::filesystem::path(GetLogPath()).parent_path() / "trace.json").string();
+        }
+        std::ofstream out(outPath.c_str(), std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << RED << "[ERROR] Failed to open trace file '" << outPath << "' for writing." << RESET << std::endl;
+            return false;
+        }
+#if defined(__unix__) || defined(__APPLE__)
+        long long pid = static_cast<long long>(getpid());
+#else
+        long long pid = 1;
+#endif
+        std::uint64_t epoch = traceEpoch.load(std::memory_order_acquire);
+        bool first = true;
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        std::string events;
+        for (const auto& buffer : Registry()) {
+            if (buffer->epoch.load(std::memory_order_acquire) != epoch) continue;
+            std::size_t count = buffer->count.load(std::memory_order_acquire);
+            if (count == 0) continue;
+            // The owning thread may restart this buffer for a newer epoch while we read it,
+            // so collect its events first and keep them only if the epoch held throughout
+            events.clear();
+            bool empty = first;
+            const char* threadName = buffer->threadName.load(std::memory_order_acquire);
+            if (threadName) {
+                events += empty ? "\n" : ",\n";
+                events += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" + std::to_string(pid) +
+                    ",\"tid\":" + std::to_string(buffer->tid) + ",\"args\":{\"name\":";
+                AppendJsonString(events, threadName);
+                events += "}}";
+                empty = false;
+            }
+            bool restarted = false;
+            for (std::size_t i = 0; i < count; ++i) {
+                const SpanRecord* chunk = buffer->chunks[i / ThreadTraceBuffer::CHUNK_SPANS].load(std::memory_order_acquire);
+                SpanRecord span = chunk[i % ThreadTraceBuffer::CHUNK_SPANS];
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (buffer->epoch.load(std::memory_order_relaxed) != epoch) {
+                    restarted = true;
+                    break;
+                }
+                std::int64_t beginNs = ClockToWallNs(span.begin);
+                std::int64_t endNs = ClockToWallNs(span.end);
+                events += empty ? "\n" : ",\n";
+                events += "{\"ph\":\"X\",\"name\":";
+                AppendJsonString(events, span.name);
+                if (span.messenger) {
+                    events += ",\"cat\":";
+                    AppendJsonString(events, span.messenger);
+                }
+                events += ",\"ts\":";
+                AppendMicros(events, beginNs);
+                events += ",\"dur\":";
+                AppendMicros(events, endNs > beginNs ? endNs - beginNs : 0);
+                events += ",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(buffer->tid);
+                if (span.argCount > 0) {
+                    events += ",\"args\":{";
+                    for (int a = 0; a < span.argCount; ++a) {
+                        if (a) events += ',';
+                        AppendJsonString(events, span.argKeys[a]);
+                        events += ':' + std::to_string(span.argValues[a]);
+                    }
+                    events += '}';
+                }
+                events += '}';
+                empty = false;
+            }
+            // Spans of a restarted buffer belong to a later capture; StartTracing() discarded ours
+            if (restarted) continue;
+            out << events;
+            first = empty;
+        }
+        out << "\n]}\n";
+        out.close();
+        return !out.fail();
+    }
+}
@@ -1,4 +1,10 @@
 #include "../include/Logger.h"
+#include "../include/LogClock.h"
+#include "../include/LogBatch.h"
+#include "../include/LogCompress.h"
+#include "../include/LogMessenger.h"
+#include "../include/LogSite.h"
+#include "LogInternal.h"
 
 #if defined(_WIN32)
 #include <windows.h>
@@ -8,6 +14,11 @@
 #include <unistd.h>
 #include <limits.h>
 #endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include <string>
 #include <cstring>
 #include <vector>
@@ -15,25 +26,154 @@
 #include <algorithm>
 #include <cctype>
 #include <filesystem>
-
-// Define ANSI color codes for terminal output
-#define GREEN      "\033[32m"
-#define YELLOW     "\033[33m"
-#define BLUE       "\033[34m"
-#define GRAY       "\033[90m"
-#define RED        "\033[31m"
-#define BRIGHT_RED "\033[91m"
-#define RESET      "\033[0m"
+#include <ctime>
+#include <cstdio>
+#include <atomic>
 
 namespace C6Logger {
 
-    static std::mutex logMutex;
+    // Durations gathered while lock profiling is on, in log2 buckets
+    struct LockTimeCounters {
+        std::atomic<std::uint64_t> count{ 0 };
+        std::atomic<std::uint64_t> totalNs{ 0 };
+        std::atomic<std::uint64_t> maxNs{ 0 };
+        std::atomic<std::uint64_t> buckets[LOCK_TIME_BUCKETS] = {};
+
+        void Add(std::uint64_t ns) {
+            count.fetch_add(1, std::memory_order_relaxed);
+            totalNs.fetch_add(ns, std::memory_order_relaxed);
+            std::uint64_t previous = maxNs.load(std::memory_order_relaxed);
+            while (ns > previous && !maxNs.compare_exchange_weak(previous, ns, std::memory_order_relaxed)) {}
+            std::size_t bucket = 0;
+            while (bucket + 1 < LOCK_TIME_BUCKETS && (ns >> (bucket + 1)) != 0) ++bucket;
+            buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void Fill(LockTimes& times) const {
+            times.count = count.load(std::memory_order_relaxed);
+            times.totalNs = totalNs.load(std::memory_order_relaxed);
+            times.maxNs = maxNs.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i < LOCK_TIME_BUCKETS; ++i) times.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+        }
+    };
+
+    static std::atomic<bool> lockProfiling{ false };
+
+    static std::uint64_t ElapsedNs(std::uint64_t from, std::uint64_t to) {
+        std::int64_t ns = ClockToWallNs(to) - ClockToWallNs(from);
+        return ns > 0 ? static_cast<std::uint64_t>(ns) : 0;
+    }
+
+    // The last line of a compacting logger's file, so a repeat of it can update the
+    // line in place instead of rewriting the file
+    struct RepeatTail {
+        bool valid = false;
+        std::string key;             // ExtractKey() of the line
+        std::uint64_t offset = 0;    // where the line starts
+        std::uint64_t fileSize = 0;  // the file's size when we last wrote it
+        std::uint64_t inode = 0;     // and its inode, which a rename-based compaction changes
+        std::size_t count = 0;
+    };
+
+    // Everything one Logger owns. Loggers share only the console lock and, when they
+    // write the same path, the process-wide appender and PathFile for it.
+    struct detail::LoggerState {
+        std::mutex mutex;
+        std::string path;
+        std::size_t maxLines = 1000;
+        bool console = true;
+        bool fileOutput = true;
+        bool isDefault = false;
+        std::atomic<FileMode> fileMode{ FileMode::Compacting };
+        detail::Appender* appender = nullptr;
+        detail::DurabilitySyncer syncer;
+        std::vector<std::shared_ptr<LogSink>> sinks;
+        // Read without the lock; every layout ever set lives until the logger does
+        std::atomic<const LogLayout*> layout{ nullptr };
+        std::vector<std::unique_ptr<LogLayout>> layouts;
+        LockTimeCounters lockWait;
+        LockTimeCounters lockHold;
+        LockTimeCounters compaction;   // inside CompressAndTrimLogFile, part of lockHold
+        RepeatTail repeatTail;         // guarded by mutex
+        detail::DedupIndex dedup;      // guarded by mutex
+        std::uint64_t seenChanges = 0; // PathFile::changes after our last file operation, guarded by mutex
+        // Last so the merger thread stops before the state it delivers into goes away
+        std::unique_ptr<detail::ShardedQueue> shards;
+    };
+
+    static std::mutex consoleMutex;
+
+    // Exclusive hold of a logger's mutex on the logging paths. While lock profiling
+    // is on it records how long the caller waited for the mutex and how long it held it.
+    class LogLock {
+    public:
+        explicit LogLock(detail::LoggerState& state) : st(state) { lock(); }
+        ~LogLock() {
+            if (owned) unlock();
+        }
+
+        LogLock(const LogLock&) = delete;
+        LogLock& operator=(const LogLock&) = delete;
+
+        void lock() {
+            if (!lockProfiling.load(std::memory_order_relaxed)) {
+                st.mutex.lock();
+                acquiredAt = 0;
+            }
+            else {
+                std::uint64_t start = ClockNow();
+                st.mutex.lock();
+                acquiredAt = ClockNow();
+                st.lockWait.Add(ElapsedNs(start, acquiredAt));
+            }
+            owned = true;
+        }
 
-    // Keep log size under control
-    static constexpr std::size_t MAX_LOG_LINES = 1000; // trim to last 1000 lines
+        void unlock() {
+            if (acquiredAt) st.lockHold.Add(ElapsedNs(acquiredAt, ClockNow()));
+            owned = false;
+            st.mutex.unlock();
+        }
+
+    private:
+        detail::LoggerState& st;
+        std::uint64_t acquiredAt = 0;
+        bool owned = false;
+    };
+
+    // Holds the path's PathFile lock around a Compacting-mode file operation; taken after
+    // the logger's own mutex. If another logger on the path touched the file since this
+    // one last did, the repeat tail and dedup state in memory are stale and are dropped.
+    class FileLock {
+    public:
+        explicit FileLock(detail::LoggerState& state) : st(state), file(detail::GetPathFile(state.appender)), lock(file.mutex) {
+            if (file.changes != st.seenChanges) {
+                st.repeatTail.valid = false;
+                st.dedup.Invalidate();
+            }
+        }
+        ~FileLock() {
+            st.seenChanges = ++file.changes;
+        }
+
+        FileLock(const FileLock&) = delete;
+        FileLock& operator=(const FileLock&) = delete;
+
+    private:
+        detail::LoggerState& st;
+        detail::PathFile& file;
+        std::lock_guard<std::mutex> lock;
+    };
+
+    static detail::LoggerState* defaultState = nullptr;
+
+    static const char* const LEVEL_COLORS[] = { BLUE, "", GRAY, YELLOW, RED, BRIGHT_RED };
 
     // Resolve and cache the log file path once
-    static std::string GetLogPathOnce() {
+    static const std::string& GetLogPathOnce() {
+        // Loggers may be constructed concurrently
+        static std::mutex pathMutex;
+        std::lock_guard<std::mutex> lock(pathMutex);
         static std::string cachedPath;
         if (!cachedPath.empty()) return cachedPath;
 
@@ -112,25 +252,10 @@ namespace C6Logger {
         return cachedPath;
     }
 
-    static std::string ExtractKey(const std::string& line) {
-        // Expect: "[timestamp] [messenger] [LEVEL] message" or "[timestamp] [LEVEL] message"
-        // Need to find the second "] [" that precedes the level when messenger is present
-        std::size_t first = line.find("] [");
-        if (first == std::string::npos) return line; // fallback
-        std::size_t second = line.find("] [", first + 1);
-        if (second == std::string::npos) {
-            // messenger absent, fall back to original behavior: use substring after first "] ["
-            return line.substr(first + 2);
-        }
-        // Skip "] " after the second bracket to return key starting with "[LEVEL] message"
-        if (second + 2 >= line.size()) return line;
-        return line.substr(second + 2);
-    }
-
-    static bool TryParseRepeatSuffix(const std::string& s, std::size_t& outCount, std::size_t& suffixStartPos) {
+    bool detail::TryParseRepeatSuffix(std::string_view s, std::size_t& outCount, std::size_t& suffixStartPos) {
         // Suffix format: " (repeated N times)" at the end of the line
-        static const std::string prefix = " (repeated ";
-        static const std::string suffix = " times)";
+        static constexpr std::string_view prefix = " (repeated ";
+        static constexpr std::string_view suffix = " times)";
         if (s.size() < prefix.size() + suffix.size() + 1) return false;
         std::size_t pos = s.rfind(prefix);
         if (pos == std::string::npos) return false;
@@ -139,6 +264,8 @@ namespace C6Logger {
         if (end + suffix.size() != s.size()) return false; // must be at end
         if (end <= pos + prefix.size()) return false;
         std::size_t numStart = pos + prefix.size();
+        while (numStart < end && s[numStart] == ' ') ++numStart;
+        if (numStart == end) return false;
         std::size_t numLen = end - numStart;
         std::size_t value = 0;
         for (std::size_t i = 0; i < numLen; ++i) {
@@ -152,15 +279,39 @@ namespace C6Logger {
         return true;
     }
 
+    static std::string_view ExtractKey(std::string_view line) {
+        // Expect: "[timestamp] [messenger] [LEVEL] message" or "[timestamp] [LEVEL] message"
+        // Need to find the second "] [" that precedes the level when messenger is present
+        std::size_t first = line.find("] [");
+        if (first == std::string::npos) return line; // fallback
+        std::size_t second = line.find("] [", first + 1);
+        if (second == std::string::npos) {
+            // messenger absent, fall back to original behavior: use substring after first "] ["
+            return line.substr(first + 2);
+        }
+        // Skip "] " after the second bracket to return key starting with "[LEVEL] message"
+        if (second + 2 >= line.size()) return line;
+        return line.substr(second + 2);
+    }
+
+    // Width the count is padded to when it is updated in place, so the line keeps its length
+    static constexpr int REPEAT_COUNT_WIDTH = 8;
+
+    static void AppendRepeatSuffix(std::string& out, std::size_t count, int width) {
+        char text[48];
+        std::snprintf(text, sizeof(text), " (repeated %*zu times)", width, count);
+        out += text;
+    }
+
     static std::string StripRepeatSuffix(const std::string& s) {
         std::size_t count = 0, startPos = 0;
-        if (TryParseRepeatSuffix(s, count, startPos)) {
+        if (detail::TryParseRepeatSuffix(s, count, startPos)) {
             return s.substr(0, startPos);
         }
         return s;
     }
 
-    static bool IsTimestampStart(const std::string& s, std::size_t i) {
+    static bool IsTimestampStart(std::string_view s, std::size_t i) {
         if (i >= s.size()) return false;
         if (s[i] != '[') return false;
         if (i + 6 >= s.size()) return false; // need at least "[YYYY-"
@@ -190,9 +341,11 @@ namespace C6Logger {
         }
     }
 
-    static void CompressAndTrimLogFile(const std::string& logPath, std::size_t maxLines) {
-        std::ifstream in(logPath.c_str());
-        if (!in.is_open()) return;
+    // Deduplicates and trims the lines read from 'in' into 'compacted'; false if there were none.
+    // 'tail', if given, receives the key, offset and count of the last line, and 'entries'
+    // the dedup entry of every line.
+    static bool CompactLogLines(std::istream& in, std::size_t maxLines, std::string& compacted, RepeatTail* tail = nullptr,
+        std::vector<detail::DedupIndex::Entry>* entries = nullptr) {
         std::vector<std::string> lines;
         std::string line;
         while (std::getline(in, line)) {
@@ -204,9 +357,8 @@ namespace C6Logger {
                 if (!p.empty()) lines.emplace_back(std::move(p));
             }
         }
-        in.close();
 
-        if (lines.empty()) return;
+        if (lines.empty()) return false;
 
         struct Record { std::string baseLine; std::size_t count; std::size_t lastIndex; };
         std::unordered_map<std::string, std::size_t> indexByKey;
@@ -218,7 +370,7 @@ namespace C6Logger {
             // Determine how many occurrences this line represents (1 or parsed N)
             std::size_t parsedCount = 1;
             std::size_t suffixStart = 0;
-            if (TryParseRepeatSuffix(l, parsedCount, suffixStart)) {
+            if (detail::TryParseRepeatSuffix(l, parsedCount, suffixStart)) {
                 // ok, parsedCount set; use the line without suffix as the base line
             }
             else {
@@ -227,7 +379,7 @@ namespace C6Logger {
             }
 
             std::string base = (suffixStart == std::string::npos) ? l : l.substr(0, suffixStart);
-            std::string key = ExtractKey(base); // key should not include suffix
+            std::string key(ExtractKey(base)); // key should not include suffix
             auto it = indexByKey.find(key);
             if (it == indexByKey.end()) {
                 std::size_t idx = records.size();
@@ -250,80 +402,762 @@ namespace C6Logger {
             records.erase(records.begin(), records.end() - static_cast<std::ptrdiff_t>(maxLines));
         }
 
-        std::ofstream out(logPath.c_str(), std::ios::trunc);
-        if (!out.is_open()) return;
+        compacted.clear();
+        if (entries) entries->clear();
         for (const auto& kv : records) {
             const auto& rec = kv.second;
-            if (rec.count > 1) {
-                out << rec.baseLine << " (repeated " << rec.count << " times)" << '\n';
+            std::size_t offset = compacted.size();
+            if (tail) tail->offset = offset;
+            compacted += rec.baseLine;
+            if (rec.count > 1) AppendRepeatSuffix(compacted, rec.count, 0);
+            compacted += '\n';
+            if (entries) entries->push_back({ detail::DedupIndex::HashKey(kv.first), rec.count, offset, compacted.size() - offset });
+        }
+        if (tail) {
+            tail->key = records.back().first;
+            tail->count = records.back().second.count;
+            tail->fileSize = compacted.size();
+        }
+        return true;
+    }
+
+    // Leaves 'tail' and 'dedup' valid only if the file was rewritten
+    static void CompressAndTrimLogFile(const std::string& logPath, std::size_t maxLines, RepeatTail& tail, detail::DedupIndex& dedup) {
+        tail.valid = false;
+        dedup.Invalidate();
+        std::ifstream in(logPath.c_str());
+        if (!in.is_open()) return;
+        std::string compacted;
+        std::vector<detail::DedupIndex::Entry> entries;
+        bool haveLines = CompactLogLines(in, maxLines, compacted, &tail, &entries);
+        in.close();
+        if (!haveLines) return;
+
+        std::ofstream out(logPath.c_str(), std::ios::trunc);
+        if (!out.is_open()) return;
+        out << compacted;
+        out.close();
+        tail.valid = static_cast<bool>(out);
+#if defined(__unix__) || defined(__APPLE__)
+        struct stat sb;
+        tail.valid = tail.valid && stat(logPath.c_str(), &sb) == 0;
+        if (tail.valid) tail.inode = static_cast<std::uint64_t>(sb.st_ino);
+#endif
+        if (tail.valid) dedup.Reset(logPath, std::move(entries));
+    }
+
+    // Compaction on the logging path, timed separately while lock profiling is on
+    static void CompactUnderLock(detail::LoggerState& st) {
+        if (!lockProfiling.load(std::memory_order_relaxed)) {
+            CompressAndTrimLogFile(st.path, st.maxLines, st.repeatTail, st.dedup);
+            return;
+        }
+        std::uint64_t start = ClockNow();
+        CompressAndTrimLogFile(st.path, st.maxLines, st.repeatTail, st.dedup);
+        st.compaction.Add(ElapsedNs(start, ClockNow()));
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    // After a restart: the last line's position comes from the dedup sidecar, its key
+    // from reading just that line back
+    static void RestoreRepeatTail(detail::LoggerState& st) {
+        if (!st.dedup.Attach(st.path)) return;
+        const detail::DedupIndex::Entry* last = st.dedup.Last();
+        if (!last || last->length == 0 || last->length > 64 * 1024) return;
+        int fd = open(st.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+        std::string text(static_cast<std::size_t>(last->length), '\0');
+        struct stat sb;
+        bool ok = fstat(fd, &sb) == 0 &&
+            pread(fd, &text[0], text.size(), static_cast<off_t>(last->offset)) == static_cast<ssize_t>(text.size());
+        close(fd);
+        if (!ok || text.back() != '\n') return;
+        text.pop_back();
+        std::size_t count = 0, suffixStart = 0;
+        if (detail::TryParseRepeatSuffix(text, count, suffixStart)) text.resize(suffixStart);
+        RepeatTail& tail = st.repeatTail;
+        tail.key = std::string(ExtractKey(text));
+        tail.offset = last->offset;
+        tail.fileSize = st.dedup.FileSize();
+        tail.inode = static_cast<std::uint64_t>(sb.st_ino);
+        tail.count = static_cast<std::size_t>(last->count);
+        tail.valid = true;
+    }
+#endif
+
+    // A line that repeats the file's last line replaces it, timestamp and a padded
+    // count, with one pwrite at the end of the file; the result is what compaction
+    // would have produced. Falls back (false) if the file changed behind our back.
+    static bool RepeatInPlace(detail::LoggerState& st, std::string_view line) {
+#if defined(__unix__) || defined(__APPLE__)
+        RepeatTail& tail = st.repeatTail;
+        if (!tail.valid) RestoreRepeatTail(st);
+        if (!tail.valid || ExtractKey(line) != tail.key) return false;
+        tail.valid = false;
+        int fd = open(st.path.c_str(), O_WRONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat sb;
+        if (fstat(fd, &sb) != 0 || static_cast<std::uint64_t>(sb.st_size) != tail.fileSize ||
+            static_cast<std::uint64_t>(sb.st_ino) != tail.inode) {
+            close(fd);
+            return false;
+        }
+        struct RepeatRecord;
+        std::string& record = detail::ThreadScratch<std::string, RepeatRecord>();
+        record.assign(line.data(), line.size());
+        AppendRepeatSuffix(record, tail.count + 1, REPEAT_COUNT_WIDTH);
+        record.push_back('\n');
+        std::uint64_t end = tail.offset + record.size();
+        bool ok = pwrite(fd, record.data(), record.size(), static_cast<off_t>(tail.offset)) == static_cast<ssize_t>(record.size());
+        if (ok && end < tail.fileSize) ok = ftruncate(fd, static_cast<off_t>(end)) == 0;
+        close(fd);
+        if (!ok) return false;   // the full path appends and compacts the file back into shape
+        ++tail.count;
+        tail.fileSize = end;
+        tail.valid = true;
+        st.dedup.UpdateLast(tail.count, record.size());
+        return true;
+#else
+        (void)st;
+        (void)line;
+        return false;
+#endif
+    }
+
+    // True if compaction would read 'line' back as more than one line: it holds a
+    // newline, or another timestamp start that SplitConcatenatedLines() cuts at
+    static bool SplitsWhenRead(std::string_view line) {
+        if (line.find('\n') != std::string_view::npos) return true;
+        for (std::size_t i = line.find('[', 1); i != std::string_view::npos; i = line.find('[', i + 1)) {
+            if (IsTimestampStart(line, i)) return true;
+        }
+        return false;
+    }
+
+    // A line with a key the file does not hold yet, in a file below maxLines, leaves
+    // nothing to deduplicate or trim: it is appended and recorded in the dedup index.
+    // A line that compaction would split takes the full path, so the index keeps one
+    // entry per line of the file.
+    static bool AppendNewLine(detail::LoggerState& st, std::string_view line) {
+#if defined(__unix__) || defined(__APPLE__)
+        if (SplitsWhenRead(line)) return false;
+        detail::DedupIndex& dedup = st.dedup;
+        if (!dedup.Attach(st.path) || dedup.Size() >= st.maxLines) return false;
+        std::string_view key = ExtractKey(line);
+        std::uint64_t keyHash = detail::DedupIndex::HashKey(key);
+        if (dedup.Contains(keyHash)) return false;
+        int fd = open(st.path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct NewLineRecord;
+        std::string& record = detail::ThreadScratch<std::string, NewLineRecord>();
+        record.assign(line.data(), line.size());
+        record.push_back('\n');
+        struct stat sb;
+        bool ok = write(fd, record.data(), record.size()) == static_cast<ssize_t>(record.size()) && fstat(fd, &sb) == 0;
+        close(fd);
+        if (!ok) {
+            dedup.Invalidate();
+            return false;
+        }
+        std::uint64_t offset = dedup.FileSize();
+        dedup.Append({ keyHash, 1, offset, record.size() });
+        RepeatTail& tail = st.repeatTail;
+        tail.key.assign(key.data(), key.size());
+        tail.offset = offset;
+        tail.fileSize = offset + record.size();
+        tail.inode = static_cast<std::uint64_t>(sb.st_ino);
+        tail.count = 1;
+        tail.valid = true;
+        return true;
+#else
+        (void)st;
+        (void)line;
+        return false;
+#endif
+    }
+
+    bool detail::CompactLogText(std::istream& in, std::size_t maxLines, std::string& compacted) {
+        return CompactLogLines(in, maxLines, compacted);
+    }
+
+    std::string GetTimestamp() {
+        std::string timestamp;
+        detail::AppendTimestamp(timestamp, ClockNow());
+        return timestamp;
+    }
+
+    static std::string ResolveLogPath(const std::string& configured) {
+        if (configured.empty()) return GetLogPathOnce();
+        std::filesystem::path p(configured);
+        if (p.is_relative()) p = std::filesystem::path(GetLogPathOnce()).parent_path() / p;
+        std::error_code ec;
+        if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path(), ec);
+        return p.string();
+    }
+
+    // Writes newline-terminated text to the logger's file and applies compaction and
+    // the durability policy. Called with the logger's lock held; releases it. headerOf(i)
+    // is the header length of the i-th line, repeated on the fragments of a line over
+    // ATOMIC_RECORD_LIMIT. With 'contiguous', appended lines go out in one write when
+    // they fit in an atomic record, and otherwise with the lock still held.
+    template<class HeaderOf>
+    static void WriteLogText(detail::LoggerState& st, LogLock& lock, std::string_view text, LogLevel maxLevel, HeaderOf headerOf,
+        bool contiguous = false) {
+        const std::string& logPath = st.path;
+        if (st.fileMode.load(std::memory_order_relaxed) == FileMode::AtomicAppend) {
+            bool ok = true;
+            if (contiguous && text.size() <= ATOMIC_RECORD_LIMIT) {
+                lock.unlock();
+                ok = detail::AppendRecordAtomic(st.appender, text.substr(0, text.size() - 1), 0);
             }
             else {
-                out << rec.baseLine << '\n';
+                if (!contiguous) lock.unlock();
+                std::size_t start = 0;
+                for (std::size_t i = 0; ok && start < text.size(); ++i) {
+                    std::size_t end = text.find('\n', start);
+                    if (end == std::string_view::npos) end = text.size();
+                    ok = detail::AppendRecordAtomic(st.appender, text.substr(start, end - start), headerOf(i));
+                    start = end + 1;
+                }
+                if (contiguous) lock.unlock();
             }
+            if (!ok) {
+                std::cerr << RED << "[ERROR] Failed to append to log file '" << logPath << "'." << RESET << std::endl;
+                return;
+            }
+            st.syncer.AfterWrite(logPath, maxLevel, text.size());
+            return;
         }
-        out.close();
+        {
+            FileLock fileLock(st);
+            std::ofstream logFile(logPath.c_str(), std::ios::app | std::ios::binary);
+            if (!logFile.is_open()) {
+                std::cerr << RED << "[ERROR] Failed to open log file '" << logPath << "' for writing." << RESET << std::endl;
+                return;
+            }
+            logFile.write(text.data(), static_cast<std::streamsize>(text.size()));
+            logFile.close();
+            CompactUnderLock(st);
+        }
+        lock.unlock();
+        st.syncer.AfterWrite(logPath, maxLevel, text.size());
     }
 
-    std::string GetTimestamp() {
-        auto now = std::chrono::system_clock::now();
-        auto in_time_t = std::chrono::system_clock::to_time_t(now);
+    // Console, sinks and file for a merged batch of a sharded logger
+    static void DeliverMerged(detail::LoggerState& st, const detail::ShardBatch& batch) {
+        LogLock lock(st);
+        if (st.console) {
+            std::lock_guard<std::mutex> consoleLock(consoleMutex);
+            for (const auto& line : batch.lines) {
+                std::ostream& out = (line.level == LogLevel::error || line.level == LogLevel::critical) ? std::cerr : std::cout;
+                out << LEVEL_COLORS[static_cast<int>(line.level)];
+                out.write(batch.text.data() + line.offset, static_cast<std::streamsize>(line.length));
+                out << RESET << '\n';
+            }
+            std::cout.flush();
+        }
+        if (!st.sinks.empty()) {
+            for (const auto& line : batch.lines) {
+                LogRecordView record;
+                record.wallNs = line.wallNs;
+                record.level = line.level;
+                record.line = std::string_view(batch.text).substr(line.offset, line.length);
+                record.headerLength = line.headerLength;
+                record.message = record.line.substr(line.headerLength, line.messageLength);
+                std::string_view messengers = line.messengerInLine ? record.line : std::string_view(batch.messengers);
+                record.messenger = messengers.substr(line.messengerOffset, line.messengerLength);
+                for (const auto& sink : st.sinks) sink->WriteRecord(record);
+            }
+        }
+        if (!st.fileOutput) return;
+        WriteLogText(st, lock, batch.text, batch.maxLevel, [&batch](std::size_t i) { return batch.lines[i].headerLength; });
+    }
+
+    Logger::Logger(LoggerConfig config) : state(std::make_unique<detail::LoggerState>()) {
+        state->path = ResolveLogPath(config.path);
+        state->maxLines = config.maxLines ? config.maxLines : 1;
+        state->console = config.console;
+        state->fileOutput = config.fileOutput;
+        state->fileMode.store(config.fileMode, std::memory_order_relaxed);
+        state->appender = detail::GetAppender(state->path);
+        SetLayout(config.layout.empty() ? std::string_view(DEFAULT_LOG_LAYOUT) : std::string_view(config.layout));
+        if (config.shards > 0) {
+            detail::LoggerState* st = state.get();
+            state->shards = std::make_unique<detail::ShardedQueue>(config.shards, config.mergeIntervalMs,
+                [st](const detail::ShardBatch& batch) { DeliverMerged(*st, batch); });
+        }
+    }
+
+    Logger::~Logger() = default;
+
+    Logger& Logger::Default() {
+        // Leaked on purpose: Log() must keep working from other static destructors
+        static Logger* instance = [] {
+            Logger* logger = new Logger();
+            logger->state->isDefault = true;
+            defaultState = logger->state.get();
+            return logger;
+        }();
+        return *instance;
+    }
+
+    void Logger::SetFileMode(FileMode mode) {
+        state->fileMode.store(mode, std::memory_order_relaxed);
+    }
+
+    FileMode Logger::GetFileMode() const {
+        return state->fileMode.load(std::memory_order_relaxed);
+    }
+
+    bool Logger::SetLayout(std::string_view pattern) {
+        auto layout = std::make_unique<LogLayout>(pattern);
+        bool valid = layout->IsValid();
+        std::lock_guard<std::mutex> lock(state->mutex);
+        // A rejected pattern only falls back to the default for a new logger
+        if (!valid && state->layout.load(std::memory_order_relaxed)) return false;
+        state->layout.store(layout.get(), std::memory_order_release);
+        state->layouts.push_back(std::move(layout));
+        return valid;
+    }
+
+    std::string Logger::GetLayout() const {
+        return state->layout.load(std::memory_order_acquire)->Pattern();
+    }
+
+    void Logger::SetDurabilityPolicy(const DurabilityPolicy& policy) {
+        state->syncer.SetPolicy(policy);
+    }
+
+    DurabilityPolicy Logger::GetDurabilityPolicy() const {
+        return state->syncer.Policy();
+    }
+
+    void Logger::AddSink(std::shared_ptr<LogSink> sink) {
+        if (!sink) return;
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->sinks.push_back(std::move(sink));
+    }
+
+    void Logger::RemoveSink(const std::shared_ptr<LogSink>& sink) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->sinks.erase(std::remove(state->sinks.begin(), state->sinks.end(), sink), state->sinks.end());
+    }
+
+    void Logger::Flush() {
+        if (state->shards) state->shards->Flush();
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->console) {
+            std::lock_guard<std::mutex> consoleLock(consoleMutex);
+            std::cout.flush();
+        }
+        for (const auto& sink : state->sinks) sink->Flush();
+    }
+
+    void Logger::FlushAsync(std::function<void()> done) {
+        if (!state->shards) {
+            Flush();
+            if (done) done();
+            return;
+        }
+        detail::LoggerState* st = state.get();
+        state->shards->FlushAsync([st, done = std::move(done)] {
+            {
+                std::lock_guard<std::mutex> lock(st->mutex);
+                if (st->console) {
+                    std::lock_guard<std::mutex> consoleLock(consoleMutex);
+                    std::cout.flush();
+                }
+                for (const auto& sink : st->sinks) sink->Flush();
+            }
+            if (done) done();
+        });
+    }
+
+    void Logger::SyncAsync(std::function<void()> done) {
+        detail::LoggerState* st = state.get();
+        auto sync = [st, done = std::move(done)]() mutable { st->syncer.SyncAsync(st->path, std::move(done)); };
+        if (state->shards) {
+            state->shards->FlushAsync(std::move(sync));
+        }
+        else {
+            sync();
+        }
+    }
+
+    bool Logger::CompactLogFile() {
+        if (state->fileMode.load(std::memory_order_relaxed) == FileMode::AtomicAppend) {
+            return detail::CompactLogFileAt(state->path, state->maxLines);
+        }
+        // Compacting-mode writers rewrite the file in place; keep them out meanwhile. The
+        // compactor renames a new file over the log, so nothing we remember about it holds.
+        std::lock_guard<std::mutex> lock(state->mutex);
+        FileLock fileLock(*state);
+        state->repeatTail.valid = false;
+        state->dedup.Invalidate();
+        return detail::CompactLogFileAt(state->path, state->maxLines);
+    }
+
+    const std::string& Logger::GetLogPath() const {
+        return state->path;
+    }
+
+    LoggerStats Logger::GetStats() const {
+        LoggerStats stats;
+        detail::FillClockStats(stats);
+        state->syncer.FillStats(stats);
+        detail::FillAppendStats(stats);
+        if (state->shards) stats.shardStalls = state->shards->Stalls();
+        state->lockWait.Fill(stats.lockWait);
+        state->lockHold.Fill(stats.lockHold);
+        state->compaction.Fill(stats.compaction);
+        return stats;
+    }
+
+    void detail::AppendLogText(std::string_view text, const std::vector<std::size_t>& headerLengths, LogLevel maxLevel) {
+        Logger::Default();
+        LogLock lock(*defaultState);
+        WriteLogText(*defaultState, lock, text, maxLevel,
+            [&headerLengths](std::size_t i) { return i < headerLengths.size() ? headerLengths[i] : 0; });
+    }
+
+    std::string Logger::SealLogSegment() {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->repeatTail.valid = false;
+        state->dedup.Invalidate();
+        std::filesystem::path logPath(state->path);
+        std::error_code ec;
+        if (!std::filesystem::exists(logPath, ec) || std::filesystem::file_size(logPath, ec) == 0) return std::string();
+
+        // log.txt -> log-YYYYMMDD-HHMMSS[-N].txt next to the active log
+        auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
         std::tm buf;
-        // Use localtime_s on MSVC, localtime_r on POSIX, fallback to localtime (unsafe) otherwise
 #if defined(_MSC_VER)
-        localtime_s(&buf, &in_time_t);
+        localtime_s(&buf, &now);
 #elif defined(__unix__) || defined(__APPLE__)
-        localtime_r(&in_time_t, &buf);
+        localtime_r(&now, &buf);
 #else
-        std::tm* tmp = std::localtime(&in_time_t);
+        std::tm* tmp = std::localtime(&now);
         if (tmp) buf = *tmp;
 #endif
-        std::stringstream ss;
-        ss << std::put_time(&buf, "%Y-%m-%d %X");
-        return ss.str();
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &buf);
+        std::string stem = logPath.stem().string() + "-" + stamp;
+        std::filesystem::path sealed;
+        for (int n = 0;; ++n) {
+            std::string name = stem + (n ? "-" + std::to_string(n) : std::string()) + logPath.extension().string();
+            sealed = logPath.parent_path() / name;
+            std::filesystem::path compressed = sealed;
+            compressed.replace_extension(".c6z");
+            if (!std::filesystem::exists(sealed, ec) && !std::filesystem::exists(compressed, ec)) break;
+        }
+        if (state->fileMode.load(std::memory_order_relaxed) == FileMode::AtomicAppend) {
+            // Appenders in every process hold descriptors on the file; the lock file
+            // moves them over, and waiting for their last records needs no mutex
+            lock.unlock();
+            if (!detail::SealLogFileAt(logPath.string(), sealed.string())) ec = std::make_error_code(std::errc::io_error);
+        }
+        else {
+            FileLock fileLock(*state);
+            std::filesystem::rename(logPath, sealed, ec);
+        }
+        if (ec) {
+            std::cerr << RED << "[ERROR] Failed to seal log file '" << logPath.string() << "'." << RESET << std::endl;
+            return std::string();
+        }
+        CompressSegmentAsync(sealed.string());
+        return sealed.string();
     }
 
-    // Two-argument overload forwards to three-argument version with empty messenger
-    void Log(LogLevel level, const std::string& message) {
-        Log(level, message, std::string());
+    // SyncOnError on a sharded logger: the merger writes the line and syncs it, so an
+    // error/critical call waits for the merge round that carries it
+    static void AwaitMergedSync(detail::LoggerState& st, LogLevel level) {
+        if (st.syncer.SyncsOn(level)) st.shards->Flush();
     }
 
-    void Log(LogLevel level, const std::string& message, const std::string& messenger) {
-        std::lock_guard<std::mutex> lock(logMutex);
+    bool Logger::TryLog(LogLevel level, std::string_view message, std::string_view messenger) {
+        if (!ShouldLog(level)) return true;
+        if (!state->shards) {
+            Log(level, message, messenger);
+            return true;
+        }
+        if (!state->shards->TryEnqueue(*state->layout.load(std::memory_order_acquire), level, message, messenger)) return false;
+        AwaitMergedSync(*state, level);
+        return true;
+    }
+
+    static void LogLine(detail::LoggerState& st, LogLevel level, std::string_view message, std::string_view messenger,
+        std::string_view location, std::string_view messengerPrefix) {
+        if (st.shards) {
+            // Stamped and formatted under the shard lock, so merge order matches the timestamps
+            st.shards->Enqueue(*st.layout.load(std::memory_order_acquire), level, message, messenger, location, messengerPrefix);
+            AwaitMergedSync(st, level);
+            return;
+        }
+
+        // Raw clock capture first; conversion to wall time happens while formatting
+        std::uint64_t stamp = ClockNow();
+
+        // base line (without any repeat suffix), built in a per-thread buffer that keeps
+        // its capacity so steady-state calls don't allocate
+        struct BaseLine;
+        std::string& baseLine = detail::ThreadScratch<std::string, BaseLine>();
+        baseLine.clear();
+        const LogLayout& layout = *st.layout.load(std::memory_order_acquire);
+        std::size_t headerLength = layout.Format(baseLine, stamp, level, message, messenger, location, messengerPrefix).headerLength;
 
-        static const char* levelStr[] = { "TRACE", "DEBUG", "INFO", "WARNING", "ERROR", "CRITICAL" };
-        static const char* colorStr[] = { BLUE, "", GRAY, YELLOW, RED, BRIGHT_RED };
+        LogLock lock(st);
 
-        std::string timestamp = GetTimestamp();
-        // base line (without any repeat suffix)
-        bool hasMessenger = !messenger.empty();
-        std::string baseLine;
-        if (hasMessenger) {
-            baseLine = "[" + timestamp + "] [" + messenger + "] [" + levelStr[static_cast<int>(level)] + "] " + message;
+        // Console output
+        if (st.console) {
+            std::lock_guard<std::mutex> consoleLock(consoleMutex);
+            std::ostream& out = (level == LogLevel::error || level == LogLevel::critical) ? std::cerr : std::cout;
+            out << LEVEL_COLORS[static_cast<int>(level)] << baseLine << RESET << std::endl;
         }
-        else {
-            baseLine = "[" + timestamp + "] [" + levelStr[static_cast<int>(level)] + "] " + message;
+
+        if (!st.sinks.empty()) {
+            LogRecordView record;
+            record.wallNs = ClockToWallNs(stamp);
+            record.level = level;
+            record.messenger = messenger;
+            record.message = message;
+            record.line = baseLine;
+            record.headerLength = headerLength;
+            for (const auto& sink : st.sinks) sink->WriteRecord(record);
         }
-        // key used to detect duplicates, independent of timestamp and messenger
-        std::string key = std::string("[") + levelStr[static_cast<int>(level)] + "] " + message;
 
-        // Console output
-        std::ostream& out = (level == LogLevel::error || level == LogLevel::critical) ? std::cerr : std::cout;
-        out << colorStr[static_cast<int>(level)] << baseLine << RESET << std::endl;
+        if (!st.fileOutput) return;
 
-        // Log file path (cached)
-        std::string logPath = GetLogPathOnce();
+        // Shared-ring producers leave the file to the collector process
+        if (st.isDefault && detail::PublishToSharedRing(level, baseLine, headerLength)) return;
 
-        // Always append the new line first
-        std::ofstream logFile(logPath.c_str(), std::ios::app);
-        if (logFile.is_open()) {
-            logFile << baseLine << std::endl;
-            logFile.close();
+        const std::string& logPath = st.path;
+
+        if (st.fileMode.load(std::memory_order_relaxed) == FileMode::AtomicAppend) {
+            // One write() on a shared O_APPEND descriptor; the file needs no lock
+            lock.unlock();
+            if (!detail::AppendRecordAtomic(st.appender, baseLine, headerLength)) {
+                std::cerr << RED << "[ERROR] Failed to append to log file '" << logPath << "'." << RESET << std::endl;
+                return;
+            }
+            st.syncer.AfterWrite(logPath, level, baseLine.size() + 1);
+            return;
         }
-        else {
-            std::cerr << RED << "[ERROR] Failed to open log file '" << logPath << "' for writing." << RESET << std::endl;
+
+        {
+            // Other loggers in this process may write the same path
+            FileLock fileLock(st);
+
+            // A back-to-back repeat only rewrites the last line, and a line with a new
+            // key only needs appending while the file is below maxLines
+            if (!RepeatInPlace(st, baseLine) && !AppendNewLine(st, baseLine)) {
+                // Always append the new line first
+                std::ofstream logFile(logPath.c_str(), std::ios::app);
+                if (logFile.is_open()) {
+                    logFile << baseLine << std::endl;
+                    logFile.close();
+                }
+                else {
+                    std::cerr << RED << "[ERROR] Failed to open log file '" << logPath << "' for writing." << RESET << std::endl;
+                }
+
+                // Compress duplicates across the entire file and enforce line limit
+                CompactUnderLock(st);
+            }
+        }
+
+        // Sync outside the lock so waiting for the disk doesn't stall other threads
+        lock.unlock();
+        st.syncer.AfterWrite(logPath, level, baseLine.size() + 1);
+    }
+
+    void Logger::Log(LogLevel level, std::string_view message, std::string_view messenger) {
+        if (!ShouldLog(level)) return;
+        LogLine(*state, level, message, messenger, std::string_view(), std::string_view());
+    }
+
+    void Logger::Log(LogLevel level, std::string_view message, const Messenger& messenger) {
+        if (!ShouldLog(level) || !messenger.Admit(level)) return;
+        LogLine(*state, level, message, messenger.Name(), std::string_view(), messenger.Prefix());
+    }
+
+    void Logger::Log(const LogBatch& batch) {
+        detail::LoggerState& st = *state;
+        if (batch.Empty()) return;
+        const LogLayout& layout = *st.layout.load(std::memory_order_acquire);
+        if (st.shards) {
+            st.shards->EnqueueBatch(layout, batch);
+            if (st.syncer.SyncsOn(LogLevel::critical)) {
+                LogLevel maxLevel = LogLevel::trace;
+                for (std::size_t i = 0; i < batch.Size(); ++i) maxLevel = std::max(maxLevel, batch.At(i).level);
+                AwaitMergedSync(st, maxLevel);
+            }
+            return;
+        }
+
+        // One stamp for the whole batch; the lines are formatted before taking the lock
+        std::uint64_t stamp = ClockNow();
+        struct BatchText;
+        std::string& text = detail::ThreadScratch<std::string, BatchText>();
+        std::vector<detail::TextLine>& lineStarts = detail::ThreadScratch<std::vector<detail::TextLine>, BatchText>();
+        text.clear();
+        lineStarts.clear();
+        LogLevel maxLevel = LogLevel::trace;
+        for (std::size_t i = 0; i < batch.Size(); ++i) {
+            LogBatch::Entry entry = batch.At(i);
+            std::size_t offset = text.size();
+            LayoutSpans spans = layout.Format(text, stamp, entry.level, entry.message, entry.messenger, std::string_view(), entry.messengerPrefix);
+            text.push_back('\n');
+            lineStarts.push_back({ offset, spans.headerLength, entry.level });
+            if (entry.level > maxLevel) maxLevel = entry.level;
+        }
+        auto line = [&](std::size_t i) {
+            std::size_t end = i + 1 < lineStarts.size() ? lineStarts[i + 1].offset : text.size();
+            return std::string_view(text).substr(lineStarts[i].offset, end - lineStarts[i].offset - 1);
+        };
+
+        LogLock lock(st);
+        if (st.console) {
+            std::lock_guard<std::mutex> consoleLock(consoleMutex);
+            for (std::size_t i = 0; i < lineStarts.size(); ++i) {
+                LogLevel level = batch.At(i).level;
+                std::ostream& out = (level == LogLevel::error || level == LogLevel::critical) ? std::cerr : std::cout;
+                out << LEVEL_COLORS[static_cast<int>(level)] << line(i) << RESET << '\n';
+            }
+            std::cout.flush();
+            std::cerr.flush();
+        }
+        if (!st.sinks.empty()) {
+            for (std::size_t i = 0; i < lineStarts.size(); ++i) {
+                LogBatch::Entry entry = batch.At(i);
+                LogRecordView record;
+                record.wallNs = ClockToWallNs(stamp);
+                record.level = entry.level;
+                record.messenger = entry.messenger;
+                record.message = entry.message;
+                record.line = line(i);
+                record.headerLength = lineStarts[i].headerLength;
+                for (const auto& sink : st.sinks) sink->WriteRecord(record);
+            }
+        }
+        if (!st.fileOutput) return;
+        if (st.isDefault && detail::PublishBatchToSharedRing(text, lineStarts)) return;
+        WriteLogText(st, lock, text, maxLevel, [&lineStarts](std::size_t i) { return lineStarts[i].headerLength; }, true);
+    }
+
+    void Logger::LogDeferredProducer(LogLevel level, detail::MessageProducer produce, std::string_view messenger) {
+        detail::LoggerState& st = *state;
+        if (st.shards) {
+            st.shards->EnqueueDeferred(*st.layout.load(std::memory_order_acquire), level, std::move(produce), messenger);
+            AwaitMergedSync(st, level);
+            return;
         }
+        detail::LazyMessage message;
+        produce(message.Text());
+        LogLine(st, level, message.Text(), messenger, std::string_view(), std::string_view());
+    }
+
+    void Logger::Log(LogSiteHandle& site, std::string_view message) {
+        const Messenger& messenger = site.GetMessenger();
+        if (!ShouldLog(site.Site().level) || !messenger.Admit(site.Site().level)) return;
+        site.CountHit();
+        LogLine(*state, site.Site().level, message, messenger.Name(), site.Location(), messenger.Prefix());
+    }
+
+    // Nesting depth and buffers of the calling thread's lazy messages
+    struct LazyMessages;
+    static thread_local std::size_t lazyDepth = 0;
+
+    detail::LazyMessage::LazyMessage() {
+        auto& lazyMessages = detail::ThreadScratch<std::vector<std::unique_ptr<std::string>>, LazyMessages>();
+        if (lazyDepth == lazyMessages.size()) lazyMessages.push_back(std::make_unique<std::string>());
+        text = lazyMessages[lazyDepth++].get();
+        text->clear();
+    }
+
+    detail::LazyMessage::~LazyMessage() {
+        --lazyDepth;
+    }
+
+    // Free functions: the default logger
+
+    LoggerStats GetStats() {
+        return Logger::Default().GetStats();
+    }
+
+    void SetLogLevel(LogLevel level) {
+        Logger::Default().SetLevel(level);
+    }
+
+    LogLevel GetLogLevel() {
+        return Logger::Default().GetLevel();
+    }
+
+    void SetLockProfiling(bool enabled) {
+        lockProfiling.store(enabled, std::memory_order_relaxed);
+    }
+
+    std::string GetLogPath() {
+        return Logger::Default().GetLogPath();
+    }
+
+    void SetFileMode(FileMode mode) {
+        Logger::Default().SetFileMode(mode);
+    }
+
+    FileMode GetFileMode() {
+        return Logger::Default().GetFileMode();
+    }
+
+    bool SetLogLayout(std::string_view pattern) {
+        return Logger::Default().SetLayout(pattern);
+    }
+
+    std::string GetLogLayout() {
+        return Logger::Default().GetLayout();
+    }
+
+    void SetDurabilityPolicy(const DurabilityPolicy& policy) {
+        Logger::Default().SetDurabilityPolicy(policy);
+    }
+
+    DurabilityPolicy GetDurabilityPolicy() {
+        return Logger::Default().GetDurabilityPolicy();
+    }
+
+    bool CompactLogFile() {
+        return Logger::Default().CompactLogFile();
+    }
+
+    std::string SealLogSegment() {
+        return Logger::Default().SealLogSegment();
+    }
+
+    // Two-argument overload forwards to three-argument version with empty messenger
+    void Log(LogLevel level, const std::string& message) {
+        Logger::Default().Log(level, message);
+    }
+
+    void Log(LogLevel level, const std::string& message, const std::string& messenger) {
+        Logger::Default().Log(level, message, messenger);
+    }
+
+    void Log(LogLevel level, const char* message) {
+        Logger::Default().Log(level, std::string_view(message ? message : ""));
+    }
+
+    void Log(LogLevel level, const char* message, const char* messenger) {
+        Logger::Default().Log(level, std::string_view(message ? message : ""), std::string_view(messenger ? messenger : ""));
+    }
+
+    void Log(LogLevel level, std::string_view message) {
+        Logger::Default().Log(level, message);
+    }
+
+    void Log(LogLevel level, std::string_view message, std::string_view messenger) {
+        Logger::Default().Log(level, message, messenger);
+    }
 
-        // Compress duplicates across the entire file and enforce line limit
-        CompressAndTrimLogFile(logPath, MAX_LOG_LINES);
+    void Log(LogLevel level, std::string_view message, const Messenger& messenger) {
+        Logger::Default().Log(level, message, messenger);
     }
-}
\ No newline at end of file
+}
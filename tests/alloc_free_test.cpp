@@ -0,0 +1,197 @@
+// alloc_free_test: the steady-state Log() paths documented as allocation-free must
+// not touch the heap.
+//
+//   alloc_free_test [--dir DIR]
+//
+// Replaces the global operator new with one that counts calls made from the test
+// thread. Each case is warmed up so per-thread buffers reach their size, then
+// called again while counting; any allocation fails the case. Covers
+// FileMode::AtomicAppend through a Logger instance and through the free functions
+// (the default logger, with its console output sent to /dev/null), the
+// string_view, const char* and Messenger overloads, lazy messages and the
+// C6_LOG site macros. Exits non-zero if any case allocates.
+//
+// Also logs from a static destructor, which runs after the main thread's
+// thread_local destructors, and checks that the lines reached the file.
+
+#include "../include/Logger.h"
+#include "../include/LogMessenger.h"
+#include "../include/LogSite.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+static thread_local bool counting = false;
+static thread_local std::size_t allocations = 0;
+
+static void* CountedAlloc(std::size_t size) {
+    if (counting) ++allocations;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size) { return CountedAlloc(size); }
+void* operator new[](std::size_t size) { return CountedAlloc(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    if (counting) ++allocations;
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    if (counting) ++allocations;
+    return std::malloc(size ? size : 1);
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+static const int WARMUP_CALLS = 200;
+static const int COUNTED_CALLS = 2000;
+
+// Messages vary in content and length from call to call, up to a fixed maximum
+static const char* Message(int i) {
+    static thread_local char text[160];
+    std::snprintf(text, sizeof(text), "request %d served in %d us%.*s", i, (i * 37) % 1000, i % 64,
+        "................................................................");
+    return text;
+}
+
+struct Case {
+    const char* name;
+    std::function<void(int)> call;
+};
+
+// Logs through the default logger once main() has returned, when the per-thread
+// buffers of the main thread and every static constructed after this one are gone
+class LogAtExit {
+public:
+    std::filesystem::path dir;   // empty until main() armed the check
+    bool removeDir = false;
+
+    ~LogAtExit() {
+        if (dir.empty()) return;
+        // Once through each file mode: they reach the file through different state
+        const char* messages[] = { "logged from a static destructor (AtomicAppend)", "logged from a static destructor (Compacting)" };
+        C6Logger::Log(C6Logger::LogLevel::info, messages[0], "Exit");
+        C6Logger::SetFileMode(C6Logger::FileMode::Compacting);
+        C6Logger::Log(C6Logger::LogLevel::info, messages[1], "Exit");
+        std::ifstream in(C6Logger::GetLogPath());
+        std::string line;
+        bool seen[2] = { false, false };
+        while (std::getline(in, line)) {
+            for (int i = 0; i < 2; ++i) seen[i] = seen[i] || line.find(messages[i]) != std::string::npos;
+        }
+        bool found = seen[0] && seen[1];
+        std::printf("%-42s %s\n", "Log() from a static destructor", found ? "ok" : "line missing");
+        std::fflush(stdout);
+        std::error_code ec;
+        if (found && removeDir) std::filesystem::remove_all(dir, ec);
+        if (!found) std::_Exit(1);
+    }
+};
+static LogAtExit logAtExit;
+
+// Console output of the default logger goes to /dev/null while the cases run
+class QuietConsole {
+public:
+    QuietConsole() {
+        std::fflush(stdout);
+        std::fflush(stderr);
+        savedOut = dup(1);
+        savedErr = dup(2);
+        int devNull = open("/dev/null", O_WRONLY | O_CLOEXEC);
+        dup2(devNull, 1);
+        dup2(devNull, 2);
+        close(devNull);
+    }
+    ~QuietConsole() {
+        std::fflush(stdout);
+        std::fflush(stderr);
+        dup2(savedOut, 1);
+        dup2(savedErr, 2);
+        close(savedOut);
+        close(savedErr);
+    }
+
+private:
+    int savedOut = -1;
+    int savedErr = -1;
+};
+
+int main(int argc, char** argv) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "c6logger_alloc_free";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) dir = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: %s [--dir DIR]\n", argv[0]);
+            return 2;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir, ec);
+    // The default logger's file goes under DIR, not the user's log directory
+    setenv("XDG_STATE_HOME", dir.c_str(), 1);
+    setenv("HOME", dir.c_str(), 1);
+
+    C6Logger::SetFileMode(C6Logger::FileMode::AtomicAppend);
+    C6Logger::LoggerConfig config;
+    config.path = (dir / "instance.txt").string();
+    config.fileMode = C6Logger::FileMode::AtomicAppend;
+    config.console = false;
+    C6Logger::Logger logger(config);
+    const C6Logger::Messenger net("Net");
+    using C6Logger::LogLevel;
+
+    std::vector<Case> cases = {
+        { "Logger::Log(string_view, string_view)", [&](int i) { logger.Log(LogLevel::info, std::string_view(Message(i)), "Net"); } },
+        { "Logger::Log(string_view)", [&](int i) { logger.Log(LogLevel::info, std::string_view(Message(i))); } },
+        { "Logger::Log(string_view, Messenger)", [&](int i) { logger.Log(LogLevel::info, std::string_view(Message(i)), net); } },
+        { "Logger::LogLazy", [&](int i) { logger.LogLazy(LogLevel::info, [i](std::string& out) { out += Message(i); }, "Net"); } },
+        { "C6_LOG_TO", [&](int i) { C6_LOG_TO(logger, LogLevel::info, "Net", std::string_view(Message(i))); } },
+        { "Log(string_view, string_view)", [](int i) { C6Logger::Log(LogLevel::info, std::string_view(Message(i)), std::string_view("Net")); } },
+        { "Log(const char*, const char*)", [](int i) { C6Logger::Log(LogLevel::info, Message(i), "Net"); } },
+        { "Log(const char*)", [](int i) { C6Logger::Log(LogLevel::info, Message(i)); } },
+        { "Log(string_view, Messenger)", [&](int i) { C6Logger::Log(LogLevel::info, std::string_view(Message(i)), net); } },
+        { "C6_INFO", [](int i) { C6_INFO("Net", std::string_view(Message(i))); } },
+        { "C6_WARNING (to stderr)", [](int i) { C6_WARNING("Net", std::string_view(Message(i))); } },
+    };
+
+    struct Result {
+        const char* name;
+        std::size_t allocations;
+    };
+    std::vector<Result> results;
+    results.reserve(cases.size());
+    {
+        QuietConsole quiet;
+        for (const Case& c : cases) {
+            for (int i = 0; i < WARMUP_CALLS; ++i) c.call(i);
+            allocations = 0;
+            counting = true;
+            for (int i = 0; i < COUNTED_CALLS; ++i) c.call(i);
+            counting = false;
+            results.push_back({ c.name, allocations });
+        }
+    }
+
+    bool ok = true;
+    for (const Result& r : results) {
+        std::printf("%-42s %zu allocations in %d calls\n", r.name, r.allocations, COUNTED_CALLS);
+        ok = ok && r.allocations == 0;
+    }
+    logAtExit.dir = dir;
+    logAtExit.removeDir = ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,258 @@
+// append_stress_test: several processes append to one log in FileMode::AtomicAppend
+// and every resulting line must be whole.
+//
+//   append_stress_test [--dir DIR] [--writers N] [--lines L]
+//
+// Forks N writer processes with two threads each. Their records range from a few
+// bytes to well over ATOMIC_RECORD_LIMIT, so both single-write records and
+// "[part k/n id]" fragment lines are exercised. Meanwhile the parent keeps running
+// CompactLogFile() and SealLogSegment() on the log. The active file and every
+// sealed segment are then checked together: every line has a header, every
+// record's payload is intact, fragments reassemble, and no record is missing or
+// duplicated. Runs once per preallocation mode the platform has. Exits non-zero on
+// the first failing mode.
+
+#include "../include/Logger.h"
+#include "../include/LogCompress.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <chrono>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+static const std::size_t RECORD_SIZES[] = { 40, 700, 3000, 4090, 9000, 40000 };
+static const int THREADS_PER_WRITER = 2;
+
+static char PayloadChar(int writer, int thread, int seq, std::size_t i) {
+    return static_cast<char>('a' + (static_cast<std::size_t>(writer * 7 + thread * 3 + seq) + i) % 26);
+}
+
+static std::string MakeRecord(int writer, int thread, int seq) {
+    std::size_t size = RECORD_SIZES[static_cast<std::size_t>(seq + writer) % (sizeof(RECORD_SIZES) / sizeof(RECORD_SIZES[0]))];
+    std::string text = "w" + std::to_string(writer) + " t" + std::to_string(thread) + " s" + std::to_string(seq) +
+        " n" + std::to_string(size) + " ";
+    for (std::size_t i = 0; i < size; ++i) text.push_back(PayloadChar(writer, thread, seq, i));
+    return text;
+}
+
+static C6Logger::LoggerConfig WriterConfig(const std::string& path) {
+    C6Logger::LoggerConfig config;
+    config.path = path;
+    config.fileMode = C6Logger::FileMode::AtomicAppend;
+    config.console = false;
+    config.maxLines = std::size_t(1) << 30;   // compaction must not trim records away
+    return config;
+}
+
+static void RunWriter(const std::string& path, int writer, int lines) {
+    C6Logger::Logger logger(WriterConfig(path));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS_PER_WRITER; ++t) {
+        threads.emplace_back([&logger, writer, lines, t] {
+            for (int seq = 0; seq < lines; ++seq) {
+                logger.Log(C6Logger::LogLevel::info, MakeRecord(writer, t, seq));
+                // Paced, so the parent's compactions and seals land throughout the run
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+}
+
+struct Checker {
+    std::set<std::tuple<int, int, int>> seen;
+    std::map<std::string, std::map<std::size_t, std::string>> fragments;   // tag -> part -> piece
+    std::map<std::string, std::size_t> fragmentCounts;
+    std::size_t errors = 0;
+    std::size_t fragmented = 0;
+
+    void Fail(const std::string& what, const std::string& line) {
+        if (errors++ < 10) std::fprintf(stderr, "  %s: %.120s\n", what.c_str(), line.c_str());
+    }
+
+    void CheckRecord(const std::string& body) {
+        int writer = -1, thread = -1, seq = -1;
+        std::size_t size = 0;
+        int consumed = 0;
+        if (std::sscanf(body.c_str(), "w%d t%d s%d n%zu %n", &writer, &thread, &seq, &size, &consumed) != 4 || consumed == 0) {
+            Fail("malformed record", body);
+            return;
+        }
+        if (body.size() != static_cast<std::size_t>(consumed) + size) {
+            Fail("record has the wrong length", body);
+            return;
+        }
+        for (std::size_t i = 0; i < size; ++i) {
+            if (body[static_cast<std::size_t>(consumed) + i] != PayloadChar(writer, thread, seq, i)) {
+                Fail("record payload is corrupt", body);
+                return;
+            }
+        }
+        if (!seen.insert(std::make_tuple(writer, thread, seq)).second) Fail("record appears twice", body);
+    }
+
+    void CheckLine(const std::string& line) {
+        static const std::string LEVEL = "] [INFO] ";
+        std::size_t level = line.find(LEVEL);
+        if (line.empty() || line[0] != '[' || level == std::string::npos) {
+            Fail("line without a header", line);
+            return;
+        }
+        std::string body = line.substr(level + LEVEL.size());
+        if (body.compare(0, 6, "[part ") != 0) {
+            CheckRecord(body);
+            return;
+        }
+        std::size_t part = 0, parts = 0;
+        char tag[64] = {};
+        int consumed = 0;
+        if (std::sscanf(body.c_str(), "[part %zu/%zu %63[0-9a-f-]] %n", &part, &parts, tag, &consumed) != 3 || consumed == 0 ||
+            part == 0 || part > parts) {
+            Fail("malformed fragment", line);
+            return;
+        }
+        auto count = fragmentCounts.emplace(tag, parts).first;
+        if (count->second != parts) Fail("fragment part count differs", line);
+        if (!fragments[tag].emplace(part, body.substr(static_cast<std::size_t>(consumed))).second) Fail("fragment appears twice", line);
+    }
+
+    void Finish() {
+        for (const auto& group : fragments) {
+            std::size_t parts = fragmentCounts[group.first];
+            if (group.second.size() != parts) {
+                Fail("fragmented record is missing parts", group.first);
+                continue;
+            }
+            std::string body;
+            for (const auto& piece : group.second) body += piece.second;
+            CheckRecord(body);
+            ++fragmented;
+        }
+    }
+};
+
+static bool RunMode(const std::string& name, C6Logger::Preallocation mode, const std::filesystem::path& dir, int writers, int lines) {
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir, ec);
+    std::string path = (dir / "stress.txt").string();
+
+    C6Logger::PreallocationPolicy policy;
+    policy.mode = mode;
+    policy.extentBytes = 1 << 20;
+    C6Logger::SetPreallocation(policy);
+
+    std::fflush(nullptr);   // children must not write out the inherited stdio buffers
+    std::vector<pid_t> children;
+    for (int w = 0; w < writers; ++w) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            RunWriter(path, w, lines);
+            _exit(0);   // static destructors would join threads that only exist in the parent
+        }
+        if (pid < 0) {
+            std::perror("fork");
+            return false;
+        }
+        children.push_back(pid);
+    }
+    // Compact and seal the log under the writers until they are done
+    C6Logger::Logger churn(WriterConfig(path));
+    bool writersOk = true;
+    std::size_t compactions = 0;
+    std::size_t seals = 0;
+    for (std::size_t running = children.size(); running > 0;) {
+        for (pid_t& pid : children) {
+            int status = 0;
+            if (pid <= 0 || waitpid(pid, &status, WNOHANG) != pid) continue;
+            writersOk = WIFEXITED(status) && WEXITSTATUS(status) == 0 && writersOk;
+            pid = 0;
+            --running;
+        }
+        // Compacting right after a seal keeps the file, and so the compaction, small
+        seals += churn.SealLogSegment().empty() ? 0 : 1;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        compactions += churn.CompactLogFile() ? 1 : 0;
+    }
+    C6Logger::WaitForSegmentCompression();
+
+    Checker checker;
+    if (!writersOk) checker.Fail("a writer process failed", name);
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        std::string file = entry.path().filename().string();
+        if (file.compare(0, 6, "stress") == 0 && (entry.path().extension() == ".txt" || entry.path().extension() == ".c6z")) {
+            files.push_back(entry.path());
+        }
+    }
+    for (const auto& file : files) {
+        std::string text;
+        if (file.extension() == ".c6z") {
+            C6Logger::CompressedLogReader reader(file.string());
+            std::string_view block;
+            while (reader.NextBlock(block)) text.append(block.data(), block.size());
+            if (!reader.IsOpen()) checker.Fail("sealed segment does not decompress", file.string());
+        }
+        else {
+            std::ifstream in(file, std::ios::binary);
+            std::stringstream contents;
+            contents << in.rdbuf();
+            text = contents.str();
+        }
+        // ExplicitSize may leave zero-filled preallocation past the last record
+        while (!text.empty() && text.back() == '\0') text.pop_back();
+        if (!text.empty() && text.back() != '\n') checker.Fail("file does not end with a newline", file.string());
+        std::size_t start = 0;
+        while (start < text.size()) {
+            std::size_t end = text.find('\n', start);
+            if (end == std::string::npos) end = text.size();
+            checker.CheckLine(text.substr(start, end - start));
+            start = end + 1;
+        }
+    }
+    checker.Finish();
+    std::size_t expected = static_cast<std::size_t>(writers) * THREADS_PER_WRITER * static_cast<std::size_t>(lines);
+    if (checker.seen.size() != expected) {
+        checker.Fail("records are missing", std::to_string(checker.seen.size()) + " of " + std::to_string(expected));
+    }
+    std::printf("%-8s %zu records (%zu fragmented) in %zu files after %zu compactions and %zu seals, %zu errors\n", name.c_str(),
+        checker.seen.size(), checker.fragmented, files.size(), compactions, seals, checker.errors);
+    return checker.errors == 0;
+}
+
+int main(int argc, char** argv) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "c6logger_append_stress";
+    int writers = 6;
+    int lines = 200;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) dir = argv[++i];
+        else if (arg == "--writers" && i + 1 < argc) writers = std::atoi(argv[++i]);
+        else if (arg == "--lines" && i + 1 < argc) lines = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [--dir DIR] [--writers N] [--lines L]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool ok = RunMode("none", C6Logger::Preallocation::None, dir, writers, lines);
+#if defined(__linux__)
+    ok = RunMode("keep", C6Logger::Preallocation::KeepSize, dir, writers, lines) && ok;
+    ok = RunMode("explicit", C6Logger::Preallocation::ExplicitSize, dir, writers, lines) && ok;
+#endif
+    std::error_code ec;
+    if (ok) std::filesystem::remove_all(dir, ec);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+// compacting_test: FileMode::Compacting keeps every line and every repeat when
+// several writers share one log file.
+//
+//   compacting_test [--dir DIR] [--lines L]
+//
+// Each case logs unique lines mixed with two lines that keep repeating ("ping" and
+// "pong"), so the in-place repeat, the append-only and the full compaction paths all
+// run, then reads the file back. Every unique line must appear once, and the repeat
+// counts of ping and pong must add up to the number of times each was logged.
+// Cases:
+//   loggers    two Logger instances on the same path, one thread each
+//   compactor  two threads on one Logger while a third calls CompactLogFile() in a loop
+// Exits non-zero if any case fails.
+
+#include "../include/Logger.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Message text of a line written by the default layout: everything after "[INFO] ",
+// without the " (repeated N times)" suffix, whose count goes to 'count'
+static std::string MessageOf(const std::string& line, std::size_t& count) {
+    static const std::string level = "[INFO] ";
+    std::size_t start = line.find(level);
+    std::string message = start == std::string::npos ? line : line.substr(start + level.size());
+    count = 1;
+    std::size_t suffix = message.rfind(" (repeated ");
+    if (suffix != std::string::npos && message.size() > 7 && message.compare(message.size() - 7, 7, " times)") == 0) {
+        count = std::strtoull(message.c_str() + suffix + 11, nullptr, 10);
+        message.resize(suffix);
+    }
+    return message;
+}
+
+struct Expected {
+    std::map<std::string, std::size_t> counts;   // message -> times logged
+
+    void Add(const std::string& message) { ++counts[message]; }
+};
+
+static bool Check(const char* name, const std::filesystem::path& path, const Expected& expected) {
+    std::map<std::string, std::size_t> found;
+    std::ifstream in(path);
+    std::string line;
+    std::size_t lines = 0;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        ++lines;
+        std::size_t count = 0;
+        std::string message = MessageOf(line, count);
+        found[message] += count;
+    }
+    std::size_t missing = 0, wrong = 0;
+    for (const auto& kv : expected.counts) {
+        auto it = found.find(kv.first);
+        if (it == found.end()) {
+            if (missing++ < 5) std::fprintf(stderr, "%s: missing '%s'\n", name, kv.first.c_str());
+        }
+        else if (it->second != kv.second) {
+            if (wrong++ < 5) std::fprintf(stderr, "%s: '%s' counted %zu times, logged %zu\n", name, kv.first.c_str(), it->second, kv.second);
+        }
+    }
+    std::size_t unexpected = 0;
+    for (const auto& kv : found) {
+        if (!expected.counts.count(kv.first) && unexpected++ < 5) std::fprintf(stderr, "%s: unexpected '%s'\n", name, kv.first.c_str());
+    }
+    bool ok = missing == 0 && wrong == 0 && unexpected == 0;
+    std::printf("%s: %zu lines, %zu messages expected, %zu missing, %zu miscounted: %s\n", name, lines, expected.counts.size(),
+        missing, wrong, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static C6Logger::LoggerConfig Config(const std::filesystem::path& path, std::size_t maxLines) {
+    C6Logger::LoggerConfig config;
+    config.path = path.string();
+    config.maxLines = maxLines;
+    config.console = false;
+    return config;
+}
+
+// Writer 'tag' logs 'lines' unique lines, each followed by its repeating line
+static void Write(C6Logger::Logger& logger, const std::string& tag, const std::string& repeat, int lines) {
+    for (int i = 0; i < lines; ++i) {
+        logger.Log(C6Logger::LogLevel::info, tag + " line " + std::to_string(i));
+        logger.Log(C6Logger::LogLevel::info, repeat);
+    }
+}
+
+static void Expect(Expected& expected, const std::string& tag, const std::string& repeat, int lines) {
+    for (int i = 0; i < lines; ++i) {
+        expected.Add(tag + " line " + std::to_string(i));
+        expected.Add(repeat);
+    }
+}
+
+static bool RunLoggers(const std::filesystem::path& dir, int lines) {
+    std::filesystem::path path = dir / "loggers.txt";
+    std::size_t maxLines = static_cast<std::size_t>(lines) * 2 + 10;
+    C6Logger::Logger first(Config(path, maxLines));
+    C6Logger::Logger second(Config(path, maxLines));
+    std::thread a([&] { Write(first, "a", "ping", lines); });
+    std::thread b([&] { Write(second, "b", "pong", lines); });
+    a.join();
+    b.join();
+
+    Expected expected;
+    Expect(expected, "a", "ping", lines);
+    Expect(expected, "b", "pong", lines);
+    return Check("loggers", path, expected);
+}
+
+static bool RunCompactor(const std::filesystem::path& dir, int lines) {
+    std::filesystem::path path = dir / "compactor.txt";
+    C6Logger::Logger logger(Config(path, static_cast<std::size_t>(lines) * 2 + 10));
+    std::atomic<bool> writing{ true };
+    std::size_t compactions = 0;
+    std::thread compactor([&] {
+        while (writing.load()) {
+            if (logger.CompactLogFile()) ++compactions;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    });
+    std::thread a([&] { Write(logger, "c", "ping", lines); });
+    std::thread b([&] { Write(logger, "d", "pong", lines); });
+    a.join();
+    b.join();
+    writing.store(false);
+    compactor.join();
+    std::printf("compactor: %zu compactions ran\n", compactions);
+
+    Expected expected;
+    Expect(expected, "c", "ping", lines);
+    Expect(expected, "d", "pong", lines);
+    return Check("compactor", path, expected);
+}
+
+int main(int argc, char** argv) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "c6logger_compacting";
+    int lines = 300;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) dir = argv[++i];
+        else if (arg == "--lines" && i + 1 < argc) lines = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [--dir DIR] [--lines L]\n", argv[0]);
+            return 2;
+        }
+    }
+    std::error_code ec;
+    dir = std::filesystem::absolute(dir, ec);   // a relative LoggerConfig::path means the default log's directory
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        std::fprintf(stderr, "cannot create %s\n", dir.string().c_str());
+        return 2;
+    }
+
+    bool ok = RunLoggers(dir, lines);
+    ok = RunCompactor(dir, lines) && ok;
+    if (ok) std::filesystem::remove_all(dir, ec);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,334 @@
+// network_sink_test: NetworkSink delivers every record in order over TCP across
+// collector outages, through its spool.
+//
+//   network_sink_test [--dir DIR] [--records N]
+//
+// A collector on 127.0.0.1 reads length-prefixed frames; each record carries its
+// index and a payload derived from it, so a record that arrives cut or shifted is
+// caught. Cases:
+//   replay      the port is bound but not listening while N records are written,
+//               so they go to the spool; once the collector listens, those and N
+//               more arrive in order on one connection, nothing dropped
+//   disconnect  the collector reads a few records and half of the next, then
+//               resets the connection while the sender is blocked mid-batch. The
+//               second connection must start with a whole record at or after the
+//               one that was cut, and carry every record after it in order
+//   torn        a spool left by a sink that could not connect gets a torn record
+//               appended, as by a crash mid-append. A new sink on that spool cuts
+//               the torn tail on open and replays the whole records, then new ones
+// Exits non-zero if any case fails.
+
+#include "../include/LogNetworkSink.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Record 'index': "record <index> " followed by letters that depend on the index
+static std::string RecordText(std::size_t index, std::size_t size) {
+    std::string text = "record " + std::to_string(index) + " ";
+    for (std::size_t i = text.size(); i < size; ++i) text += static_cast<char>('a' + (index + i) % 26);
+    return text;
+}
+
+// Index of a record written by RecordText(), or -1 if it is not one, or is damaged
+static long long RecordIndex(const std::string& text) {
+    if (text.compare(0, 7, "record ") != 0) return -1;
+    char* end = nullptr;
+    unsigned long long index = std::strtoull(text.c_str() + 7, &end, 10);
+    if (end == text.c_str() + 7 || *end != ' ') return -1;
+    return RecordText(index, text.size()) == text ? static_cast<long long>(index) : -1;
+}
+
+// TCP listener on an ephemeral loopback port. Until Listen() the port is bound
+// but refuses connections, which is how the tests take the collector down.
+class Collector {
+public:
+    explicit Collector(int receiveBuffer = 0) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return;
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        // Inherited by accepted connections, so a collector that stops reading stalls the sender soon
+        if (receiveBuffer > 0) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            close(fd);
+            fd = -1;
+            return;
+        }
+        port = ntohs(address.sin_port);
+    }
+    ~Collector() {
+        if (fd >= 0) close(fd);
+    }
+
+    bool IsOpen() const { return fd >= 0; }
+    std::uint16_t Port() const { return port; }
+    bool Listen() { return listen(fd, 4) == 0; }
+
+    // The next connection, or -1 after timeoutMs
+    int Accept(int timeoutMs) {
+        pollfd waiting = { fd, POLLIN, 0 };
+        if (poll(&waiting, 1, timeoutMs) != 1) return -1;
+        return accept(fd, nullptr, nullptr);
+    }
+
+private:
+    int fd = -1;
+    std::uint16_t port = 0;
+};
+
+// Length-prefixed frames read from one accepted connection
+struct Connection {
+    int fd = -1;
+    std::string buffer;
+    std::vector<std::string> records;
+
+    explicit Connection(int socketFd) : fd(socketFd) {}
+    ~Connection() {
+        if (fd >= 0) close(fd);
+    }
+
+    // Reads until 'done' holds, the peer closes, or nothing arrives for timeoutMs.
+    // A partial frame left at the end stays in 'buffer'.
+    template <typename Done>
+    bool ReadUntil(Done done, int timeoutMs) {
+        char chunk[64 << 10];
+        while (!done()) {
+            pollfd waiting = { fd, POLLIN, 0 };
+            if (poll(&waiting, 1, timeoutMs) != 1) return false;
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) return false;
+            buffer.append(chunk, static_cast<std::size_t>(n));
+            std::size_t pos = 0;
+            while (buffer.size() - pos >= 4) {
+                std::size_t length = std::size_t(static_cast<unsigned char>(buffer[pos])) << 24 |
+                    std::size_t(static_cast<unsigned char>(buffer[pos + 1])) << 16 |
+                    std::size_t(static_cast<unsigned char>(buffer[pos + 2])) << 8 | static_cast<unsigned char>(buffer[pos + 3]);
+                if (buffer.size() - pos - 4 < length) break;
+                records.push_back(buffer.substr(pos + 4, length));
+                pos += 4 + length;
+            }
+            buffer.erase(0, pos);
+        }
+        return true;
+    }
+
+    // Reads exactly 'bytes' bytes without framing them
+    bool ReadBytes(std::size_t bytes) {
+        std::string data(bytes, '\0');
+        std::size_t got = 0;
+        while (got < bytes) {
+            ssize_t n = recv(fd, &data[got], bytes - got, 0);
+            if (n <= 0) return false;
+            got += static_cast<std::size_t>(n);
+        }
+        buffer += data;
+        return true;
+    }
+
+    // Closes with a reset instead of a FIN, discarding what was not read
+    void Reset() {
+        linger hard = { 1, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_LINGER, &hard, sizeof(hard));
+        close(fd);
+        fd = -1;
+    }
+};
+
+static bool Expect(const char* name, bool condition, const std::string& what) {
+    if (!condition) std::fprintf(stderr, "%s: %s\n", name, what.c_str());
+    return condition;
+}
+
+// True if 'records' are exactly records first, first + 1, ..., end - 1
+static bool CheckSequence(const char* name, const std::vector<std::string>& records, std::size_t first, std::size_t end) {
+    if (!Expect(name, records.size() == end - first, "received " + std::to_string(records.size()) + " records, expected " +
+        std::to_string(end - first))) {
+        return false;
+    }
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        long long index = RecordIndex(records[i]);
+        if (index != static_cast<long long>(first + i)) {
+            return Expect(name, false, "record " + std::to_string(i) + " received is " +
+                (index < 0 ? "damaged" : "record " + std::to_string(index)) + ", expected record " + std::to_string(first + i));
+        }
+    }
+    return true;
+}
+
+static C6Logger::NetworkSinkConfig Config(std::uint16_t port, const std::filesystem::path& spoolPath) {
+    C6Logger::NetworkSinkConfig config;
+    config.port = port;
+    config.spoolPath = spoolPath.string();
+    config.flushIntervalMs = 5;
+    config.reconnectMinMs = 10;
+    config.reconnectMaxMs = 50;
+    return config;
+}
+
+static void WriteRecords(C6Logger::NetworkSink& sink, std::size_t first, std::size_t end, std::size_t size) {
+    for (std::size_t i = first; i < end; ++i) {
+        std::string text = RecordText(i, size);
+        sink.Write(C6Logger::LogLevel::info, text, 0);
+    }
+}
+
+static bool RunReplay(const std::filesystem::path& dir, std::size_t records) {
+    const char* name = "replay";
+    Collector collector;
+    if (!Expect(name, collector.IsOpen(), "cannot bind a loopback port")) return false;
+    C6Logger::NetworkSink sink(Config(collector.Port(), dir / "replay.spool"));
+
+    bool ok = true;
+    WriteRecords(sink, 0, records, 100);
+    sink.Flush();
+    C6Logger::NetworkSinkStats stats = sink.Stats();
+    ok = Expect(name, stats.spooled == records && stats.sentRecords == 0 && stats.connectFailures > 0,
+        "while down: " + std::to_string(stats.spooled) + " spooled, " + std::to_string(stats.sentRecords) + " sent") && ok;
+
+    if (!Expect(name, collector.Listen(), "cannot listen")) return false;
+    WriteRecords(sink, records, records * 2, 100);
+    sink.Flush();
+    int accepted = collector.Accept(5000);
+    if (!Expect(name, accepted >= 0, "the sink did not reconnect")) return false;
+    Connection connection(accepted);
+    connection.ReadUntil([&] { return connection.records.size() >= records * 2; }, 5000);
+    ok = CheckSequence(name, connection.records, 0, records * 2) && ok;
+
+    sink.Flush();   // the sender counts a replayed batch after sending it
+    stats = sink.Stats();
+    ok = Expect(name, stats.replayed >= records && stats.dropped == 0 && stats.connects == 1,
+        std::to_string(stats.replayed) + " replayed, " + std::to_string(stats.dropped) + " dropped, " +
+        std::to_string(stats.connects) + " connects") && ok;
+    std::printf("%s: %zu records, %llu spooled, %llu replayed, %llu connect failures: %s\n", name, records * 2,
+        static_cast<unsigned long long>(stats.spooled), static_cast<unsigned long long>(stats.replayed),
+        static_cast<unsigned long long>(stats.connectFailures), ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static bool RunDisconnect(const std::filesystem::path& dir) {
+    const char* name = "disconnect";
+    const std::size_t records = 64;
+    const std::size_t size = 100003;     // odd, so a cut is unlikely to fall between records
+    const std::size_t readFirst = 3;     // whole records read from the first connection
+    Collector collector(16 << 10);
+    if (!Expect(name, collector.IsOpen() && collector.Listen(), "cannot listen on a loopback port")) return false;
+    C6Logger::NetworkSink sink(Config(collector.Port(), dir / "disconnect.spool"));
+
+    WriteRecords(sink, 0, records, size);
+    int accepted = collector.Accept(5000);
+    if (!Expect(name, accepted >= 0, "the sink did not connect")) return false;
+    bool ok = true;
+    {
+        Connection first(accepted);
+        ok = Expect(name, first.ReadUntil([&] { return first.records.size() >= readFirst; }, 5000),
+            "first connection closed early") && ok;
+        // Half of the record after those, then a reset while the sender waits for the window
+        std::size_t partial = (4 + size) / 2 - first.buffer.size();
+        ok = Expect(name, first.records.size() == readFirst && first.ReadBytes(partial), "first connection ran short") && ok;
+        ok = CheckSequence(name, first.records, 0, readFirst) && ok;
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        first.Reset();
+    }
+
+    accepted = collector.Accept(5000);
+    if (!Expect(name, accepted >= 0, "the sink did not reconnect")) return false;
+    Connection second(accepted);
+    second.ReadUntil([&] { return !second.records.empty() && RecordIndex(second.records.back()) + 1 >= static_cast<long long>(records); }, 5000);
+    sink.Flush();
+    long long resumed = second.records.empty() ? -1 : RecordIndex(second.records.front());
+    ok = Expect(name, resumed >= static_cast<long long>(readFirst), "second connection starts with " +
+        (resumed < 0 ? std::string("a damaged or no record") : "record " + std::to_string(resumed))) && ok;
+    if (resumed >= 0) ok = CheckSequence(name, second.records, static_cast<std::size_t>(resumed), records) && ok;
+
+    C6Logger::NetworkSinkStats stats = sink.Stats();
+    ok = Expect(name, stats.connects == 2 && stats.spooled > 0 && stats.dropped == 0, std::to_string(stats.connects) +
+        " connects, " + std::to_string(stats.spooled) + " spooled, " + std::to_string(stats.dropped) + " dropped") && ok;
+    std::printf("%s: reset inside record %zu, resumed at record %lld, %llu spooled: %s\n", name, readFirst, resumed,
+        static_cast<unsigned long long>(stats.spooled), ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static bool RunTorn(const std::filesystem::path& dir, std::size_t records) {
+    const char* name = "torn";
+    std::filesystem::path spoolPath = dir / "torn.spool";
+    Collector collector;
+    if (!Expect(name, collector.IsOpen(), "cannot bind a loopback port")) return false;
+    {
+        C6Logger::NetworkSink sink(Config(collector.Port(), spoolPath));
+        WriteRecords(sink, 0, records, 100);
+        sink.Flush();
+    }
+    std::error_code ec;
+    std::uintmax_t whole = std::filesystem::file_size(spoolPath, ec);
+    {
+        // A spool record is a 4-byte little-endian length and the framed bytes; this one claims 200 and has 50
+        std::ofstream out(spoolPath, std::ios::binary | std::ios::app);
+        const char length[4] = { static_cast<char>(200), 0, 0, 0 };
+        out.write(length, 4);
+        out << std::string(50, 'T');
+    }
+
+    bool ok = true;
+    C6Logger::NetworkSink sink(Config(collector.Port(), spoolPath));
+    std::uintmax_t reopened = std::filesystem::file_size(spoolPath, ec);
+    ok = Expect(name, reopened == whole, "spool is " + std::to_string(reopened) + " bytes after reopening, expected " +
+        std::to_string(whole)) && ok;
+
+    if (!Expect(name, collector.Listen(), "cannot listen")) return false;
+    WriteRecords(sink, records, records * 2, 100);
+    sink.Flush();
+    int accepted = collector.Accept(5000);
+    if (!Expect(name, accepted >= 0, "the sink did not reconnect")) return false;
+    Connection connection(accepted);
+    connection.ReadUntil([&] { return connection.records.size() >= records * 2; }, 5000);
+    ok = CheckSequence(name, connection.records, 0, records * 2) && ok;
+    std::printf("%s: spool cut back to %ju bytes, %zu records replayed in order: %s\n", name, reopened,
+        connection.records.size(), ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "c6logger_network_sink";
+    std::size_t records = 1000;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) dir = argv[++i];
+        else if (arg == "--records" && i + 1 < argc) records = std::strtoull(argv[++i], nullptr, 10);
+        else {
+            std::fprintf(stderr, "usage: %s [--dir DIR] [--records N]\n", argv[0]);
+            return 2;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        std::fprintf(stderr, "cannot create %s\n", dir.string().c_str());
+        return 2;
+    }
+
+    bool ok = RunReplay(dir, records);
+    ok = RunDisconnect(dir) && ok;
+    ok = RunTorn(dir, records) && ok;
+    if (ok) std::filesystem::remove_all(dir, ec);
+    return ok ? 0 : 1;
+}
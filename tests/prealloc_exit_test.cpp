@@ -0,0 +1,120 @@
+// prealloc_exit_test: a process that returns from main trims the space it
+// preallocated, so the log ends at its last line.
+//
+//   prealloc_exit_test [--dir DIR]
+//
+// For each preallocation mode the test runs itself as a child that logs enough lines
+// in FileMode::AtomicAppend to reserve a 256 KiB extent, then returns from main
+// without closing anything. Once the child is gone the log must hold exactly those
+// lines: no zero bytes after them (ExplicitSize), and no extent reserved past the
+// end (KeepSize). A mode the filesystem cannot preallocate for is skipped.
+// Exits non-zero if any mode fails.
+
+#include "../include/Logger.h"
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+static const int LINES = 200;   // about 200 KB, past the half extent where KeepSize reserves
+static const std::size_t EXTENT = std::size_t(256) << 10;
+static const int CHILD_NO_PREALLOCATION = 3;
+
+// Child: logs LINES lines into 'path' and returns, leaving the trim to the exit hook
+static int RunChild(const std::string& mode, const std::string& path) {
+    C6Logger::PreallocationPolicy policy;
+    policy.mode = mode == "explicit" ? C6Logger::Preallocation::ExplicitSize : C6Logger::Preallocation::KeepSize;
+    policy.extentBytes = EXTENT;
+    C6Logger::SetPreallocation(policy);
+    C6Logger::LoggerConfig config;
+    config.path = path;
+    config.fileMode = C6Logger::FileMode::AtomicAppend;
+    config.console = false;
+    C6Logger::Logger logger(config);
+    for (int i = 0; i < LINES; ++i) logger.Log(C6Logger::LogLevel::info, "line " + std::to_string(i) + " " + std::string(1000, 'x'));
+    return logger.GetStats().preallocations == 0 ? CHILD_NO_PREALLOCATION : 0;
+}
+
+static bool RunMode(const char* self, const std::string& mode, const std::filesystem::path& dir) {
+    std::string path = (dir / (mode + ".txt")).string();
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl(self, self, "--child", mode.c_str(), path.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) {
+        std::printf("%s: child did not exit normally: FAILED\n", mode.c_str());
+        return false;
+    }
+    if (WEXITSTATUS(status) == CHILD_NO_PREALLOCATION) {
+        std::printf("%s: the filesystem does not preallocate, skipped\n", mode.c_str());
+        return true;
+    }
+    if (WEXITSTATUS(status) != 0) {
+        std::printf("%s: child exited with %d: FAILED\n", mode.c_str(), WEXITSTATUS(status));
+        return false;
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    std::string text = contents.str();
+    int lines = 0;
+    for (char c : text) lines += c == '\n';
+    bool ok = true;
+    if (text.find('\0') != std::string::npos) {
+        std::fprintf(stderr, "%s: the log holds zero bytes\n", mode.c_str());
+        ok = false;
+    }
+    if (text.empty() || text.back() != '\n') {
+        std::fprintf(stderr, "%s: the log does not end with a whole line\n", mode.c_str());
+        ok = false;
+    }
+    if (lines != LINES) {
+        std::fprintf(stderr, "%s: expected %d lines, found %d\n", mode.c_str(), LINES, lines);
+        ok = false;
+    }
+    struct stat st;
+    std::uint64_t allocated = stat(path.c_str(), &st) == 0 ? static_cast<std::uint64_t>(st.st_blocks) * 512 : 0;
+    if (allocated >= text.size() + EXTENT / 2) {
+        std::fprintf(stderr, "%s: %llu bytes still allocated\n", mode.c_str(), static_cast<unsigned long long>(allocated));
+        ok = false;
+    }
+    std::printf("%s: %zu bytes, %llu allocated, %d lines: %s\n", mode.c_str(), text.size(),
+        static_cast<unsigned long long>(allocated), lines, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 4 && std::string(argv[1]) == "--child") return RunChild(argv[2], argv[3]);
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "c6logger_prealloc_exit";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) dir = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: %s [--dir DIR]\n", argv[0]);
+            return 2;
+        }
+    }
+    std::error_code ec;
+    dir = std::filesystem::absolute(dir, ec);   // a relative LoggerConfig::path means the default log's directory
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        std::fprintf(stderr, "cannot create %s\n", dir.string().c_str());
+        return 2;
+    }
+
+    bool ok = RunMode(argv[0], "explicit", dir);
+    ok = RunMode(argv[0], "keep", dir) && ok;
+    if (ok) std::filesystem::remove_all(dir, ec);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,336 @@
+// system_sink_test: SystemLogSink speaks the journald native protocol and RFC 5424
+// to a local datagram socket, and SinkOverflow::Drop never waits for the daemon.
+//
+//   system_sink_test [--dir DIR] [--records N]
+//
+// Each case binds an AF_UNIX datagram socket in DIR that stands in for the daemon and
+// points a sink at it. Cases:
+//   journald  fields of one datagram per record: PRIORITY, SYSLOG_FACILITY, the
+//             messenger as SYSLOG_IDENTIFIER (or the identifier plus C6_MESSENGER),
+//             and a multi-line MESSAGE in the binary "KEY\n" + 64-bit length form
+//   syslog    "<PRI>1 ..." with PRI = facility * 8 + severity, APP-NAME and MSGID from
+//             the messenger and identifier, header tokens without spaces
+//   drop      the receiver never reads and its buffer is tiny: writing N records and
+//             flushing must return promptly, with the refused datagrams counted as
+//             dropped and every record either sent or dropped
+// Exits non-zero if any case fails.
+
+#include "../include/LogSystemSink.h"
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+// Datagram socket bound to 'path', standing in for journald or syslogd
+class Receiver {
+public:
+    explicit Receiver(const std::string& path, int receiveBuffer = 0) {
+        unlink(path.c_str());
+        fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+        if (fd < 0) return;
+        if (receiveBuffer > 0) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            close(fd);
+            fd = -1;
+            return;
+        }
+        timeval timeout = { 2, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+    ~Receiver() {
+        if (fd >= 0) close(fd);
+    }
+
+    bool IsOpen() const { return fd >= 0; }
+
+    // Next datagram; false after two seconds without one
+    bool Receive(std::string& datagram) {
+        datagram.resize(64 << 10);
+        ssize_t n = recv(fd, &datagram[0], datagram.size(), 0);
+        if (n < 0) return false;
+        datagram.resize(static_cast<std::size_t>(n));
+        return true;
+    }
+
+private:
+    int fd = -1;
+};
+
+static C6Logger::LogRecordView Record(C6Logger::LogLevel level, const char* messenger, const char* message) {
+    C6Logger::LogRecordView record;
+    record.level = level;
+    record.messenger = messenger;
+    record.message = message;
+    record.line = message;
+    return record;
+}
+
+// Parses a journald native datagram into its fields. Returns false if it is malformed.
+static bool ParseJournal(const std::string& datagram, std::map<std::string, std::string>& fields, std::vector<std::string>& binary) {
+    fields.clear();
+    binary.clear();
+    std::size_t pos = 0;
+    while (pos < datagram.size()) {
+        std::size_t end = datagram.find('\n', pos);
+        if (end == std::string::npos) return false;
+        std::size_t equals = datagram.find('=', pos);
+        if (equals != std::string::npos && equals < end) {
+            fields[datagram.substr(pos, equals - pos)] = datagram.substr(equals + 1, end - equals - 1);
+            pos = end + 1;
+            continue;
+        }
+        std::string key = datagram.substr(pos, end - pos);
+        pos = end + 1;
+        if (datagram.size() - pos < 8) return false;
+        std::uint64_t length = 0;
+        for (int i = 0; i < 8; ++i) length |= static_cast<std::uint64_t>(static_cast<unsigned char>(datagram[pos + i])) << (8 * i);
+        pos += 8;
+        if (datagram.size() - pos < length + 1 || datagram[pos + length] != '\n') return false;
+        fields[key] = datagram.substr(pos, length);
+        binary.push_back(key);
+        pos += length + 1;
+    }
+    return true;
+}
+
+static bool Expect(const char* name, bool condition, const std::string& what) {
+    if (!condition) std::fprintf(stderr, "%s: %s\n", name, what.c_str());
+    return condition;
+}
+
+static bool Field(const char* name, const std::map<std::string, std::string>& fields, const std::string& key, const std::string& value) {
+    auto it = fields.find(key);
+    if (it == fields.end()) return Expect(name, false, "no " + key + " field");
+    return Expect(name, it->second == value, key + " is '" + it->second + "', expected '" + value + "'");
+}
+
+static bool RunJournald(const std::filesystem::path& dir) {
+    const char* name = "journald";
+    std::string socketPath = (dir / "journal.sock").string();
+    Receiver receiver(socketPath);
+    if (!Expect(name, receiver.IsOpen(), "cannot bind " + socketPath)) return false;
+
+    C6Logger::SystemSinkConfig config;
+    config.socketPath = socketPath;
+    config.identifier = "sinktest";
+    C6Logger::SystemLogSink sink(config);
+    C6Logger::SystemSinkConfig separate = config;
+    separate.messengerAsIdentifier = false;
+    separate.facility = 3;
+    C6Logger::SystemLogSink separateSink(separate);
+    if (!Expect(name, sink.IsOpen() && separateSink.IsOpen(), "sink did not open")) return false;
+
+    bool ok = true;
+    std::string datagram;
+    std::map<std::string, std::string> fields;
+    std::vector<std::string> binary;
+
+    sink.WriteRecord(Record(C6Logger::LogLevel::warning, "Renderer", "frame took 40 ms"));
+    sink.Flush();
+    ok = Expect(name, receiver.Receive(datagram), "no datagram for a one-line record") && ok;
+    ok = Expect(name, ParseJournal(datagram, fields, binary), "malformed datagram") && ok;
+    ok = Field(name, fields, "PRIORITY", "4") && ok;
+    ok = Field(name, fields, "SYSLOG_FACILITY", "1") && ok;
+    ok = Field(name, fields, "SYSLOG_IDENTIFIER", "Renderer") && ok;
+    ok = Field(name, fields, "MESSAGE", "frame took 40 ms") && ok;
+    ok = Expect(name, binary.empty(), "a one-line record used the binary form") && ok;
+    ok = Expect(name, !fields.count("C6_MESSENGER"), "C6_MESSENGER set with messengerAsIdentifier") && ok;
+
+    // No messenger: the configured identifier
+    sink.WriteRecord(Record(C6Logger::LogLevel::critical, "", "out of memory"));
+    sink.Flush();
+    ok = Expect(name, receiver.Receive(datagram) && ParseJournal(datagram, fields, binary), "no datagram without a messenger") && ok;
+    ok = Field(name, fields, "PRIORITY", "2") && ok;
+    ok = Field(name, fields, "SYSLOG_IDENTIFIER", "sinktest") && ok;
+
+    // A newline in MESSAGE switches to "MESSAGE\n" + little-endian length + value
+    const char* multiLine = "first line\nsecond line\n\nfourth=line";
+    sink.WriteRecord(Record(C6Logger::LogLevel::error, "Net", multiLine));
+    sink.Flush();
+    ok = Expect(name, receiver.Receive(datagram) && ParseJournal(datagram, fields, binary), "no datagram for a multi-line record") && ok;
+    ok = Expect(name, binary.size() == 1 && binary[0] == "MESSAGE", "MESSAGE did not use the binary form") && ok;
+    ok = Field(name, fields, "MESSAGE", multiLine) && ok;
+    ok = Field(name, fields, "PRIORITY", "3") && ok;
+    std::string lengthForm = std::string("MESSAGE\n") + static_cast<char>(std::strlen(multiLine)) + std::string(7, '\0') + multiLine + "\n";
+    ok = Expect(name, datagram.find(lengthForm) != std::string::npos, "MESSAGE length is not 64-bit little-endian") && ok;
+
+    // messengerAsIdentifier == false: the identifier for every line, the messenger in C6_MESSENGER
+    separateSink.WriteRecord(Record(C6Logger::LogLevel::info, "Audio", "device opened"));
+    separateSink.Flush();
+    ok = Expect(name, receiver.Receive(datagram) && ParseJournal(datagram, fields, binary), "no datagram from the second sink") && ok;
+    ok = Field(name, fields, "PRIORITY", "6") && ok;
+    ok = Field(name, fields, "SYSLOG_FACILITY", "3") && ok;
+    ok = Field(name, fields, "SYSLOG_IDENTIFIER", "sinktest") && ok;
+    ok = Field(name, fields, "C6_MESSENGER", "Audio") && ok;
+    ok = Field(name, fields, "MESSAGE", "device opened") && ok;
+
+    // Write() takes the messenger from a default-layout header
+    const std::string line = "[2026-01-01 00:00:00] [Physics] [DEBUG] step";
+    sink.Write(C6Logger::LogLevel::debug, line, line.find("step"));
+    sink.Flush();
+    ok = Expect(name, receiver.Receive(datagram) && ParseJournal(datagram, fields, binary), "no datagram for Write()") && ok;
+    ok = Field(name, fields, "PRIORITY", "7") && ok;
+    ok = Field(name, fields, "SYSLOG_IDENTIFIER", "Physics") && ok;
+    ok = Field(name, fields, "MESSAGE", "step") && ok;
+
+    C6Logger::SystemSinkStats stats = sink.Stats();
+    ok = Expect(name, stats.sent == 4 && stats.dropped == 0, "stats: " + std::to_string(stats.sent) + " sent, " +
+        std::to_string(stats.dropped) + " dropped") && ok;
+    std::printf("%s: %s\n", name, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// Splits "<PRI>1 TIMESTAMP HOSTNAME APP-NAME PROCID MSGID - MSG" into its header
+// fields and MSG. Returns false if there are too few fields.
+static bool ParseSyslog(const std::string& datagram, std::vector<std::string>& header, std::string& message) {
+    header.clear();
+    std::size_t pos = 0;
+    while (header.size() < 7) {
+        std::size_t space = datagram.find(' ', pos);
+        if (space == std::string::npos) return false;
+        header.push_back(datagram.substr(pos, space - pos));
+        pos = space + 1;
+    }
+    message = datagram.substr(pos);
+    return true;
+}
+
+static bool RunSyslog(const std::filesystem::path& dir) {
+    const char* name = "syslog";
+    std::string socketPath = (dir / "log.sock").string();
+    Receiver receiver(socketPath);
+    if (!Expect(name, receiver.IsOpen(), "cannot bind " + socketPath)) return false;
+
+    C6Logger::SystemSinkConfig config;
+    config.format = C6Logger::SystemLogFormat::Syslog;
+    config.socketPath = socketPath;
+    config.identifier = "sink test";
+    C6Logger::SystemLogSink sink(config);
+    C6Logger::SystemSinkConfig separate = config;
+    separate.messengerAsIdentifier = false;
+    separate.facility = 16;   // LOG_LOCAL0
+    C6Logger::SystemLogSink separateSink(separate);
+    if (!Expect(name, sink.IsOpen() && separateSink.IsOpen(), "sink did not open")) return false;
+
+    bool ok = true;
+    std::string datagram, message;
+    std::vector<std::string> header;
+    const std::string pid = std::to_string(static_cast<long long>(getpid()));
+
+    // PRI = 1 * 8 + 4, APP-NAME from the messenger, no MSGID
+    sink.WriteRecord(Record(C6Logger::LogLevel::warning, "Renderer", "frame took 40 ms"));
+    sink.Flush();
+    ok = Expect(name, receiver.Receive(datagram) && ParseSyslog(datagram, header, message), "no datagram for a record") && ok;
+    if (header.size() == 7) {
+        ok = Expect(name, header[0] == "<12>1", "PRI/VERSION is '" + header[0] + "', expected '<12>1'") && ok;
+        ok = Expect(name, header[1].size() >= 20 && header[1][4] == '-' && header[1][10] == 'T', "TIMESTAMP is '" + header[1] + "'") && ok;
+        ok = Expect(name, header[3] == "Renderer", "APP-NAME is '" + header[3] + "', expected 'Renderer'") && ok;
+        ok = Expect(name, header[4] == pid, "PROCID is '" + header[4] + "', expected " + pid) && ok;
+        ok = Expect(name, header[5] == "-", "MSGID is '" + header[5] + "', expected '-'") && ok;
+        ok = Expect(name, header[6] == "-", "STRUCTURED-DATA is '" + header[6] + "', expected '-'") && ok;
+        ok = Expect(name, message == "frame took 40 ms", "MSG is '" + message + "'") && ok;
+    }
+
+    // No messenger: the identifier, with the space replaced so the header stays parseable
+    sink.WriteRecord(Record(C6Logger::LogLevel::trace, "", "tick"));
+    sink.Flush();
+    ok = Expect(name, receiver.Receive(datagram) && ParseSyslog(datagram, header, message), "no datagram without a messenger") && ok;
+    if (header.size() == 7) {
+        ok = Expect(name, header[0] == "<15>1", "PRI/VERSION is '" + header[0] + "', expected '<15>1'") && ok;
+        ok = Expect(name, header[3] == "sink_test", "APP-NAME is '" + header[3] + "', expected 'sink_test'") && ok;
+        ok = Expect(name, message == "tick", "MSG is '" + message + "'") && ok;
+    }
+
+    // messengerAsIdentifier == false: PRI = 16 * 8 + 3, the identifier as APP-NAME, the messenger as MSGID
+    separateSink.WriteRecord(Record(C6Logger::LogLevel::error, "Net", "connection reset"));
+    separateSink.Flush();
+    ok = Expect(name, receiver.Receive(datagram) && ParseSyslog(datagram, header, message), "no datagram from the second sink") && ok;
+    if (header.size() == 7) {
+        ok = Expect(name, header[0] == "<131>1", "PRI/VERSION is '" + header[0] + "', expected '<131>1'") && ok;
+        ok = Expect(name, header[3] == "sink_test", "APP-NAME is '" + header[3] + "', expected 'sink_test'") && ok;
+        ok = Expect(name, header[5] == "Net", "MSGID is '" + header[5] + "', expected 'Net'") && ok;
+        ok = Expect(name, message == "connection reset", "MSG is '" + message + "'") && ok;
+    }
+    std::printf("%s: %s\n", name, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static bool RunDrop(const std::filesystem::path& dir, int records) {
+    const char* name = "drop";
+    std::string socketPath = (dir / "full.sock").string();
+    Receiver receiver(socketPath, 1);   // the kernel rounds this up to its minimum
+    if (!Expect(name, receiver.IsOpen(), "cannot bind " + socketPath)) return false;
+
+    C6Logger::SystemSinkConfig config;
+    config.socketPath = socketPath;
+    config.identifier = "sinktest";
+    config.overflow = C6Logger::SinkOverflow::Drop;
+    config.maxPendingBytes = 64 << 10;
+    C6Logger::SystemLogSink sink(config);
+    if (!Expect(name, sink.IsOpen(), "sink did not open")) return false;
+
+    const std::string message(200, 'x');
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < records; ++i) {
+        sink.WriteRecord(Record(C6Logger::LogLevel::info, "Flood", message.c_str()));
+    }
+    sink.Flush();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    C6Logger::SystemSinkStats stats = sink.Stats();
+    bool ok = true;
+    ok = Expect(name, seconds < 5.0, "writing and flushing took " + std::to_string(seconds) + " s") && ok;
+    ok = Expect(name, stats.dropped > 0, "nothing was dropped") && ok;
+    ok = Expect(name, stats.sent + stats.dropped == static_cast<std::uint64_t>(records),
+        std::to_string(stats.sent) + " sent + " + std::to_string(stats.dropped) + " dropped != " + std::to_string(records)) && ok;
+    std::printf("%s: %d records in %.3f s, %llu sent, %llu dropped, %llu send calls: %s\n", name, records, seconds,
+        static_cast<unsigned long long>(stats.sent), static_cast<unsigned long long>(stats.dropped),
+        static_cast<unsigned long long>(stats.sendCalls), ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "c6logger_system_sink";
+    int records = 20000;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) dir = argv[++i];
+        else if (arg == "--records" && i + 1 < argc) records = std::atoi(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: %s [--dir DIR] [--records N]\n", argv[0]);
+            return 2;
+        }
+    }
+    std::error_code ec;
+    dir = std::filesystem::absolute(dir, ec);
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        std::fprintf(stderr, "cannot create %s\n", dir.string().c_str());
+        return 2;
+    }
+    if (dir.string().size() + 16 >= sizeof(sockaddr_un::sun_path)) {
+        std::fprintf(stderr, "%s is too long for a socket path\n", dir.string().c_str());
+        return 2;
+    }
+
+    bool ok = RunJournald(dir);
+    ok = RunSyslog(dir) && ok;
+    ok = RunDrop(dir, records) && ok;
+    if (ok) std::filesystem::remove_all(dir, ec);
+    return ok ? 0 : 1;
+}
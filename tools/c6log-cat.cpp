@@ -0,0 +1,150 @@
+// c6log-cat: prints plain, block-compressed (.c6z) or binary (.c6b) logs to stdout.
+//
+//   c6log-cat [--stats] [--offset N] FILE...
+//
+// --offset starts output at uncompressed byte N, using the block index to skip
+// straight to the containing block. For binary logs it is a file offset, and
+// output starts at the first sync marker after it. Binary records are printed
+// in the text log's format.
+
+#include "../include/LogBinary.h"
+#include "../include/LogCompress.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static bool CatPlain(const std::string& path, std::uint64_t offset, std::uint64_t& rawBytes) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    if (offset && std::fseek(f, static_cast<long>(offset), SEEK_SET) != 0) {
+        std::fclose(f);
+        return false;
+    }
+    std::vector<char> chunk(64 * 1024);
+    std::size_t n;
+    while ((n = std::fread(chunk.data(), 1, chunk.size(), f)) > 0) {
+        std::fwrite(chunk.data(), 1, n, stdout);
+        rawBytes += n;
+    }
+    std::fclose(f);
+    return true;
+}
+
+static bool CatCompressed(const std::string& path, std::uint64_t offset, std::uint64_t& rawBytes) {
+    C6Logger::CompressedLogReader reader(path);
+    if (!reader.IsOpen()) return false;
+    std::size_t skip = 0;
+    if (offset) {
+        if (reader.HasIndex()) {
+            if (!reader.SeekToRawOffset(offset, skip)) return true; // past the end
+        }
+        else {
+            skip = static_cast<std::size_t>(offset); // unfinished segment: stream and discard
+        }
+    }
+    std::string_view block;
+    while (reader.NextBlock(block)) {
+        if (skip >= block.size()) {
+            skip -= block.size();
+            continue;
+        }
+        block.remove_prefix(skip);
+        skip = 0;
+        std::fwrite(block.data(), 1, block.size(), stdout);
+        rawBytes += block.size();
+    }
+    return true;
+}
+
+static bool CatBinary(const std::string& path, std::uint64_t offset, std::uint64_t& rawBytes) {
+    static const char* const LEVEL_NAMES[] = { "TRACE", "DEBUG", "INFO", "WARNING", "ERROR", "CRITICAL" };
+    C6Logger::BinaryLogReader reader(path);
+    if (!reader.IsOpen()) return false;
+    if (offset && !reader.Seek(offset)) return true; // no sync marker after it
+    C6Logger::BinaryRecord record;
+    std::string line;
+    while (reader.Next(record)) {
+        std::int64_t seconds = record.wallNs / 1000000000;
+        std::int64_t fraction = record.wallNs % 1000000000;
+        if (fraction < 0) {
+            fraction += 1000000000;
+            --seconds;
+        }
+        std::time_t t = static_cast<std::time_t>(seconds);
+        std::tm buf{};
+#if defined(_MSC_VER)
+        localtime_s(&buf, &t);
+#else
+        localtime_r(&t, &buf);
+#endif
+        char stamp[48];
+        std::size_t n = std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &buf);
+        std::snprintf(stamp + n, sizeof(stamp) - n, ".%09lld", static_cast<long long>(fraction));
+        line.assign("[").append(stamp).append("] [");
+        if (!record.messenger.empty()) line.append(record.messenger).append("] [");
+        line.append(LEVEL_NAMES[static_cast<int>(record.level)]).append("] ");
+        line.append(record.message).append("\n");
+        std::fwrite(line.data(), 1, line.size(), stdout);
+        rawBytes += line.size();
+    }
+    if (reader.CorruptRecords() || reader.TornTail()) {
+        std::fprintf(stderr, "%s: skipped %llu corrupt record(s)%s\n", path.c_str(),
+            static_cast<unsigned long long>(reader.CorruptRecords()), reader.TornTail() ? ", torn tail" : "");
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool stats = false;
+    std::uint64_t offset = 0;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--stats") == 0) {
+            stats = true;
+        }
+        else if (std::strcmp(argv[i], "--offset") == 0 && i + 1 < argc) {
+            offset = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "-h") == 0 || std::strcmp(argv[i], "--help") == 0) {
+            std::cout << "usage: c6log-cat [--stats] [--offset N] FILE..." << std::endl;
+            return 0;
+        }
+        else {
+            files.emplace_back(argv[i]);
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "usage: c6log-cat [--stats] [--offset N] FILE..." << std::endl;
+        return 2;
+    }
+
+    int status = 0;
+    for (const auto& file : files) {
+        std::uint64_t rawBytes = 0;
+        bool ok;
+        if (C6Logger::IsCompressedLog(file)) ok = CatCompressed(file, offset, rawBytes);
+        else if (C6Logger::IsBinaryLog(file)) ok = CatBinary(file, offset, rawBytes);
+        else ok = CatPlain(file, offset, rawBytes);
+        if (!ok) {
+            std::cerr << "c6log-cat: cannot read '" << file << "'" << std::endl;
+            status = 1;
+            continue;
+        }
+        if (stats) {
+            std::FILE* f = std::fopen(file.c_str(), "rb");
+            long stored = 0;
+            if (f && std::fseek(f, 0, SEEK_END) == 0) stored = std::ftell(f);
+            if (f) std::fclose(f);
+            std::fprintf(stderr, "%s: %llu bytes -> %ld stored (%.2fx)\n", file.c_str(),
+                static_cast<unsigned long long>(rawBytes), stored,
+                stored > 0 ? static_cast<double>(rawBytes) / static_cast<double>(stored) : 0.0);
+        }
+    }
+    std::fflush(stdout);
+    return status;
+}
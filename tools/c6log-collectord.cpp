@@ -0,0 +1,54 @@
+// c6log-collectord: drains a shared-memory log ring into the log file.
+//
+//   c6log-collectord [--ring NAME] [--stall-timeout-ms N]
+//
+// Producer processes call C6Logger::EnableSharedRingProducer(NAME); this daemon
+// is then the only process that writes and compacts the log file. Stops on
+// SIGINT/SIGTERM after a final drain.
+
+#include "../include/Logger.h"
+#include "../include/LogSharedRing.h"
+
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+static std::atomic<bool> stopRequested{ false };
+
+static void OnSignal(int) {
+    stopRequested.store(true);
+}
+
+int main(int argc, char** argv) {
+    std::string ringName = "c6logger";
+    int stallTimeoutMs = 1000;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--ring") == 0 && i + 1 < argc) {
+            ringName = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--stall-timeout-ms") == 0 && i + 1 < argc) {
+            stallTimeoutMs = std::atoi(argv[++i]);
+        }
+        else {
+            std::cerr << "usage: c6log-collectord [--ring NAME] [--stall-timeout-ms N]" << std::endl;
+            return 2;
+        }
+    }
+
+    C6Logger::SharedRingCollector collector(ringName);
+    if (!collector.IsOpen()) return 1;
+    collector.SetStallTimeoutMs(stallTimeoutMs);
+
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+    std::cout << "c6log-collectord: draining ring '" << ringName << "' into " << C6Logger::GetLogPath() << std::endl;
+    collector.Run(stopRequested);
+
+    C6Logger::SharedRingStats stats = collector.Stats();
+    std::cout << "c6log-collectord: collected " << stats.collected << ", dropped " << stats.dropped
+        << ", reclaimed " << stats.reclaimed << ", corrupt " << stats.corrupt << std::endl;
+    return 0;
+}
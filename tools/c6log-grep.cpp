@@ -0,0 +1,366 @@
+// c6log-grep: searches C6Logger text logs (plain or .c6z) for a message substring.
+//
+//   c6log-grep [-l LEVEL] [-m MESSENGER] [--since TIME] [--until TIME]
+//              [-c] [-H|--no-filename] [-j N] (-e PATTERN | PATTERN) FILE...
+//
+// The pattern is a fixed string matched against the message only, never the
+// header. -l keeps lines at LEVEL or above, -m lines from exactly MESSENGER.
+// --since/--until take a timestamp prefix in the log's own format
+// ("2024-05-01 13:00") and are inclusive: the header's timestamp is compared
+// as text, it is never converted. Lines without a header (the continuation of a
+// multi-line message) only match when no level, messenger or time filter is given.
+//
+// Plain files are memory-mapped and split into line-aligned chunks that worker
+// threads search in parallel; output keeps file and line order. Candidate
+// positions come from an SSE2 scan comparing the pattern's first and last bytes
+// sixteen positions at a time, so only those are compared in full.
+
+#include "../include/LogCompress.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+static constexpr std::size_t CHUNK_SIZE = 4 << 20;
+
+static const char* const LEVEL_NAMES[] = { "TRACE", "DEBUG", "INFO", "WARNING", "ERROR", "CRITICAL" };
+
+struct Options {
+    std::string pattern;
+    int minLevel = 0;
+    bool hasMessenger = false;
+    std::string messenger;
+    std::string since;
+    std::string until;
+    bool countOnly = false;
+    int showFilename = -1; // -1: only with several files
+    unsigned threads = 0;
+
+    bool HeaderFilters() const { return minLevel > 0 || hasMessenger || !since.empty() || !until.empty(); }
+};
+
+struct Source {
+    std::string path;
+    const char* data = nullptr;
+    std::size_t size = 0;
+    void* map = nullptr;
+    std::string owned; // decompressed .c6z contents
+};
+
+struct Job {
+    std::size_t source = 0;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    std::string out;
+    std::uint64_t count = 0;
+    bool done = false;
+};
+
+// Finds 'needle' in [s, s + n). Compares whole needles only where both its first
+// and its last byte line up.
+static const char* FindSubstring(const char* s, std::size_t n, std::string_view needle) {
+    std::size_t k = needle.size();
+    if (k == 0) return s;
+    if (k > n) return nullptr;
+    if (k == 1) return static_cast<const char*>(std::memchr(s, needle[0], n));
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[k - 1]);
+    for (; i + k - 1 + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + k - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+        while (mask) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (std::memcmp(s + i + bit + 1, needle.data() + 1, k - 2) == 0) return s + i + bit;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i + k <= n; ++i) {
+        if (s[i] == needle[0] && s[i + k - 1] == needle[k - 1] && std::memcmp(s + i + 1, needle.data() + 1, k - 2) == 0) return s + i;
+    }
+    return nullptr;
+}
+
+static int LevelFromName(std::string_view name) {
+    for (int i = 0; i < 6; ++i) {
+        if (name == LEVEL_NAMES[i]) return i;
+    }
+    return -1;
+}
+
+struct Header {
+    std::string_view timestamp;
+    std::string_view messenger;
+    int level = -1;
+    std::size_t messageStart = 0;
+};
+
+// "[timestamp] [messenger] [LEVEL] " or "[timestamp] [LEVEL] ". Only bracket
+// positions are located; the fields themselves are not parsed.
+static bool ParseHeader(std::string_view line, Header& h) {
+    if (line.size() < 4 || line[0] != '[') return false;
+    std::size_t close = line.find("] [", 1);
+    if (close == std::string_view::npos) return false;
+    h.timestamp = line.substr(1, close - 1);
+    std::size_t start = close + 3;
+    std::size_t end = line.find(']', start);
+    if (end == std::string_view::npos) return false;
+    std::string_view first = line.substr(start, end - start);
+    if (line.compare(end, 3, "] [") == 0) {
+        std::size_t levelStart = end + 3;
+        std::size_t levelEnd = line.find(']', levelStart);
+        if (levelEnd != std::string_view::npos) {
+            int level = LevelFromName(line.substr(levelStart, levelEnd - levelStart));
+            if (level >= 0) {
+                h.messenger = first;
+                h.level = level;
+                h.messageStart = std::min(line.size(), levelEnd + 2);
+                return true;
+            }
+        }
+    }
+    h.level = LevelFromName(first);
+    if (h.level < 0) return false;
+    h.messenger = std::string_view();
+    h.messageStart = std::min(line.size(), end + 2);
+    return true;
+}
+
+static bool Accept(const Options& options, std::string_view line, std::size_t hitOffset) {
+    Header h;
+    std::string_view message = line;
+    if (ParseHeader(line, h)) {
+        if (h.level < options.minLevel) return false;
+        if (options.hasMessenger && h.messenger != options.messenger) return false;
+        if (!options.since.empty() && h.timestamp.substr(0, options.since.size()) < options.since) return false;
+        if (!options.until.empty() && h.timestamp.substr(0, options.until.size()) > options.until) return false;
+        message = line.substr(h.messageStart);
+        if (hitOffset < h.messageStart && !FindSubstring(message.data(), message.size(), options.pattern)) return false;
+    }
+    else if (options.HeaderFilters()) {
+        return false;
+    }
+    return true;
+}
+
+// Start of the first line beginning at or after 'offset'
+static std::size_t AlignToLine(const Source& source, std::size_t offset) {
+    if (offset == 0 || offset >= source.size) return std::min(offset, source.size);
+    const char* nl = static_cast<const char*>(std::memchr(source.data + offset - 1, '\n', source.size - offset + 1));
+    return nl ? static_cast<std::size_t>(nl - source.data) + 1 : source.size;
+}
+
+static void Emit(Job& job, const Options& options, const Source& source, std::string_view line) {
+    ++job.count;
+    if (options.countOnly) return;
+    if (options.showFilename) job.out.append(source.path).append(":");
+    job.out.append(line).append("\n");
+}
+
+static void RunJob(Job& job, const Options& options, const Source& source) {
+    const char* data = source.data;
+    std::size_t pos = AlignToLine(source, job.begin);
+    std::size_t end = AlignToLine(source, job.end);
+    while (pos < end) {
+        std::size_t lineStart = pos;
+        std::size_t hitOffset = 0;
+        if (!options.pattern.empty()) {
+            const char* hit = FindSubstring(data + pos, end - pos, options.pattern);
+            if (!hit) break;
+            std::size_t at = static_cast<std::size_t>(hit - data);
+            lineStart = at;
+            while (lineStart > pos && data[lineStart - 1] != '\n') --lineStart;
+            hitOffset = at - lineStart;
+        }
+        const char* nl = static_cast<const char*>(std::memchr(data + lineStart + hitOffset, '\n', end - lineStart - hitOffset));
+        std::size_t lineEnd = nl ? static_cast<std::size_t>(nl - data) : end;
+        std::string_view line(data + lineStart, lineEnd - lineStart);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (Accept(options, line, hitOffset)) Emit(job, options, source, line);
+        pos = lineEnd + 1;
+    }
+}
+
+static bool OpenSource(Source& source) {
+    if (C6Logger::IsCompressedLog(source.path)) {
+        C6Logger::CompressedLogReader reader(source.path);
+        if (!reader.IsOpen()) return false;
+        std::string_view block;
+        while (reader.NextBlock(block)) source.owned.append(block.data(), block.size());
+        source.data = source.owned.data();
+        source.size = source.owned.size();
+        return true;
+    }
+    int fd = open(source.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    source.size = static_cast<std::size_t>(st.st_size);
+    if (source.size > 0) {
+        void* map = mmap(nullptr, source.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        madvise(map, source.size, MADV_SEQUENTIAL);
+        source.map = map;
+        source.data = static_cast<const char*>(map);
+    }
+    close(fd);
+    return true;
+}
+
+static void Usage(std::ostream& out) {
+    out << "usage: c6log-grep [-l LEVEL] [-m MESSENGER] [--since TIME] [--until TIME]\n"
+           "                  [-c] [-H|--no-filename] [-j N] (-e PATTERN | PATTERN) FILE..." << std::endl;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    bool havePattern = false;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-e" && hasValue) {
+            options.pattern = argv[++i];
+            havePattern = true;
+        }
+        else if (arg == "-l" && hasValue) {
+            std::string name = argv[++i];
+            std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+            options.minLevel = LevelFromName(name);
+            if (options.minLevel < 0) {
+                std::cerr << "c6log-grep: unknown level '" << argv[i] << "'" << std::endl;
+                return 2;
+            }
+        }
+        else if (arg == "-m" && hasValue) {
+            options.messenger = argv[++i];
+            options.hasMessenger = true;
+        }
+        else if (arg == "--since" && hasValue) {
+            options.since = argv[++i];
+        }
+        else if (arg == "--until" && hasValue) {
+            options.until = argv[++i];
+        }
+        else if (arg == "-c") {
+            options.countOnly = true;
+        }
+        else if (arg == "-H") {
+            options.showFilename = 1;
+        }
+        else if (arg == "--no-filename") {
+            options.showFilename = 0;
+        }
+        else if (arg == "-j" && hasValue) {
+            options.threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "-h" || arg == "--help") {
+            Usage(std::cout);
+            return 0;
+        }
+        else {
+            positional.emplace_back(arg);
+        }
+    }
+    if (!havePattern && !positional.empty()) {
+        options.pattern = positional.front();
+        positional.erase(positional.begin());
+        havePattern = true;
+    }
+    if (!havePattern || positional.empty()) {
+        Usage(std::cerr);
+        return 2;
+    }
+    if (options.showFilename < 0) options.showFilename = positional.size() > 1;
+
+    int status = 0;
+    std::vector<Source> sources(positional.size());
+    std::vector<Job> jobs;
+    for (std::size_t s = 0; s < sources.size(); ++s) {
+        sources[s].path = positional[s];
+        if (!OpenSource(sources[s])) {
+            std::cerr << "c6log-grep: cannot read '" << sources[s].path << "'" << std::endl;
+            status = 2;
+            continue;
+        }
+        for (std::size_t begin = 0; begin < sources[s].size; begin += CHUNK_SIZE) {
+            Job job;
+            job.source = s;
+            job.begin = begin;
+            job.end = std::min(sources[s].size, begin + CHUNK_SIZE);
+            jobs.push_back(std::move(job));
+        }
+    }
+
+    // Workers take chunks in order; the main thread prints them in the same order
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::atomic<std::size_t> nextJob{ 0 };
+    unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, std::max<std::size_t>(jobs.size(), 1)));
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&] {
+            for (std::size_t j; (j = nextJob.fetch_add(1)) < jobs.size();) {
+                RunJob(jobs[j], options, sources[jobs[j].source]);
+                std::lock_guard<std::mutex> lock(mutex);
+                jobs[j].done = true;
+                finished.notify_all();
+            }
+        });
+    }
+
+    std::uint64_t total = 0;
+    std::vector<std::uint64_t> counts(sources.size(), 0);
+    for (std::size_t j = 0; j < jobs.size(); ++j) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [&] { return jobs[j].done; });
+        }
+        std::fwrite(jobs[j].out.data(), 1, jobs[j].out.size(), stdout);
+        std::string().swap(jobs[j].out);
+        counts[jobs[j].source] += jobs[j].count;
+        total += jobs[j].count;
+    }
+    for (auto& worker : workers) worker.join();
+
+    if (options.countOnly) {
+        for (std::size_t s = 0; s < sources.size(); ++s) {
+            if (options.showFilename) std::printf("%s:", sources[s].path.c_str());
+            std::printf("%llu\n", static_cast<unsigned long long>(counts[s]));
+        }
+    }
+    for (auto& source : sources) {
+        if (source.map) munmap(source.map, source.size);
+    }
+    std::fflush(stdout);
+    if (status) return status;
+    return total ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+// c6log-live: prints the most recent lines of a running process's live view.
+//
+//   c6log-live [--name NAME] [-n N] [-f] [--interval-ms MS]
+//
+// The process publishes them with a C6Logger::LiveViewSink. -n prints the last N
+// lines (default 20); -f keeps polling and prints new lines as they arrive. Lines
+// the writer overwrote before they could be read are reported on stderr.
+
+#include "../include/LogLiveView.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static void Print(const C6Logger::LiveRecord& record) {
+    std::cout << record.line;
+    if (record.truncated) std::cout << " [...]";
+    std::cout << '\n';
+}
+
+int main(int argc, char** argv) {
+    std::string name = "c6logger";
+    std::size_t count = 20;
+    bool follow = false;
+    int intervalMs = 100;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--name") == 0 && i + 1 < argc) {
+            name = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            count = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "-f") == 0) {
+            follow = true;
+        }
+        else if (std::strcmp(argv[i], "--interval-ms") == 0 && i + 1 < argc) {
+            intervalMs = std::max(1, std::atoi(argv[++i]));
+        }
+        else {
+            std::cerr << "usage: c6log-live [--name NAME] [-n N] [-f] [--interval-ms MS]" << std::endl;
+            return 2;
+        }
+    }
+
+    C6Logger::LiveViewReader reader(name);
+    if (!reader.IsOpen()) {
+        std::cerr << "c6log-live: no live view named '" << name << "'" << std::endl;
+        return 1;
+    }
+    std::vector<C6Logger::LiveRecord> records = reader.Snapshot(count);
+    for (const auto& record : records) Print(record);
+    std::cout.flush();
+    if (!follow) return 0;
+
+    std::uint64_t cursor = records.empty() ? reader.Head() : records.back().sequence + 1;
+    for (;;) {
+        records.clear();
+        std::uint64_t missed = 0;
+        reader.ReadSince(cursor, records, &missed);
+        if (missed) std::cerr << "c6log-live: " << missed << " lines overwritten before they could be read" << std::endl;
+        for (const auto& record : records) Print(record);
+        std::cout.flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+    }
+}